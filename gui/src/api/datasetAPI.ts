@@ -1,6 +1,7 @@
 // src/api/datasetAPI.ts
 import axios from 'axios';
-import type {PaginatedData} from '../types';
+import type {LoadJob, LoadMode} from '../types';
+import {decodePageFrame, pageFrameMediaType} from './pageFrame';
 
 const api = axios.create({
     baseURL: '/api/v1',
@@ -8,11 +9,27 @@ const api = axios.create({
 
 export const getAvailableDatasets = () => api.get<string[]>('/datasets/available');
 export const getLoadedDatasets = () => api.get<{ id: string; name: string }[]>('/datasets/loaded');
-export const loadDataset = (filePath: string) => api.post<{ datasetId: string }>('/datasets/load', { filePath });
+export const loadDataset = (filePath: string, mode: LoadMode = 'memory') =>
+    api.post<{ jobId: string }>('/datasets/load', { filePath, mode });
+export const getLoadJob = (jobId: string) => api.get<LoadJob>(`/jobs/${jobId}`);
 export const unloadDataset = (id: string) => api.delete(`/datasets/${id}`);
-export const getDatasetPage = (id: string, page: number, pageSize: number) =>
-    api.get<PaginatedData>(`/datasets/${id}`, { params: { page, pageSize } });
+// страница приходит бинарным колоночным кадром; ошибки сервер по-прежнему отдаёт в JSON
+export const getDatasetPage = async (id: string, page: number, pageSize: number) => {
+    try {
+        const res = await api.get<ArrayBuffer>(`/datasets/${id}`, {
+            params: { page, pageSize },
+            headers: { Accept: pageFrameMediaType },
+            responseType: 'arraybuffer',
+        });
+        return { ...res, data: decodePageFrame(res.data) };
+    } catch (e: any) {
+        if (e.response?.data instanceof ArrayBuffer) {
+            e.response.data = JSON.parse(new TextDecoder().decode(e.response.data));
+        }
+        throw e;
+    }
+};
 export const removeColumn = (datasetId: string, columnName: string) =>
     api.post<{ newDatasetId: string, newDatasetName: string }>(`/datasets/${datasetId}/transform/remove-column`, { columnName });
-export const saveDatasetAs = (datasetId: string, newName: string) =>
-    api.post<{ newDatasetId: string, newDatasetName: string }>(`/datasets/${datasetId}/save-as`, { newName });
\ No newline at end of file
+export const saveDatasetAs = (datasetId: string, newName: string, format: 'csv' | 'snapshot' = 'csv') =>
+    api.post<{ newDatasetId: string, newDatasetName: string }>(`/datasets/${datasetId}/save-as`, { newName, format });
\ No newline at end of file
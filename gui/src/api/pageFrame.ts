@@ -0,0 +1,98 @@
+// src/api/pageFrame.ts
+// Разбор бинарного колоночного кадра страницы (application/vnd.neuro.page-frame).
+// Формат описан в src/service/PageFrame.hpp на сервере.
+import type {PaginatedData} from '../types';
+
+export const pageFrameMediaType = 'application/vnd.neuro.page-frame';
+
+const COLUMN_I64 = 0;
+const COLUMN_F32 = 1;
+const COLUMN_F64 = 2;
+const COLUMN_STRING = 3;
+
+const HEADER_SIZE = 40;
+
+const align8 = (offset: number) => (offset + 7) & ~7;
+
+// кратчайшая запись float32, которая читается обратно в то же число - как std::to_chars на сервере
+const formatFloat32 = (value: number) => {
+    for (let precision = 1; precision < 9; ++precision) {
+        const text = value.toPrecision(precision);
+        if (Math.fround(Number(text)) === value) {
+            return String(Number(text));
+        }
+    }
+    return String(Number(value.toPrecision(9)));
+};
+
+export const decodePageFrame = (buffer: ArrayBuffer): PaginatedData => {
+    const view = new DataView(buffer);
+    const bytes = new Uint8Array(buffer);
+    const utf8 = new TextDecoder();
+
+    const magic = utf8.decode(bytes.subarray(0, 4));
+    const version = view.getUint32(4, true);
+    if (magic !== 'NDPF' || version !== 1) {
+        throw new Error(`Unsupported page frame ${magic} v${version}`);
+    }
+
+    const columnCount = view.getUint32(8, true);
+    const rowCount = view.getUint32(12, true);
+    const totalRows = Number(view.getBigUint64(16, true));
+    const page = view.getUint32(24, true);
+    const pageSize = view.getUint32(28, true);
+    const totalPages = view.getUint32(32, true);
+
+    let offset = HEADER_SIZE;
+    const readText = () => {
+        const length = view.getUint32(offset, true);
+        const text = utf8.decode(bytes.subarray(offset + 4, offset + 4 + length));
+        offset += 4 + length;
+        return text;
+    };
+
+    const id = readText();
+    const name = readText();
+
+    const types: number[] = [];
+    const headers: string[] = [];
+    for (let c = 0; c < columnCount; ++c) {
+        types.push(view.getUint8(offset));
+        offset += 4;
+        headers.push(readText());
+    }
+
+    const data: string[][] = Array.from({length: rowCount}, () => new Array<string>(columnCount));
+    for (let c = 0; c < columnCount; ++c) {
+        offset = align8(offset);
+        const validity = bytes.subarray(offset, offset + Math.ceil(rowCount / 8));
+        const isValid = (row: number) => ((validity[row >> 3] >> (row & 7)) & 1) === 1;
+        offset = align8(offset + validity.length);
+
+        // буферы выровнены сервером, типизированные массивы накладываются без копирования
+        if (types[c] === COLUMN_STRING) {
+            const bounds = new Uint32Array(buffer, offset, rowCount + 1);
+            const start = offset + bounds.byteLength;
+            for (let row = 0; row < rowCount; ++row) {
+                data[row][c] = isValid(row) ? utf8.decode(bytes.subarray(start + bounds[row], start + bounds[row + 1])) : '';
+            }
+            offset = start + bounds[rowCount];
+        } else if (types[c] === COLUMN_I64) {
+            const values = new BigInt64Array(buffer, offset, rowCount);
+            values.forEach((value, row) => data[row][c] = isValid(row) ? value.toString() : '');
+            offset += values.byteLength;
+        } else if (types[c] === COLUMN_F32) {
+            const values = new Float32Array(buffer, offset, rowCount);
+            values.forEach((value, row) => data[row][c] = isValid(row) ? formatFloat32(value) : '');
+            offset += values.byteLength;
+        } else if (types[c] === COLUMN_F64) {
+            const values = new Float64Array(buffer, offset, rowCount);
+            values.forEach((value, row) => data[row][c] = isValid(row) ? String(value) : '');
+            offset += values.byteLength;
+        } else {
+            throw new Error(`Unknown column type ${types[c]} in page frame`);
+        }
+    }
+
+    return {id, name, page, pageSize, totalPages, totalRows, headers, data};
+};
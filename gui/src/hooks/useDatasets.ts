@@ -1,7 +1,17 @@
 // src/hooks/useDatasets.ts
 import { useState, useEffect, useCallback } from 'react';
 import * as api from '../api/datasetAPI';
-import type {LoadedDataset, PaginatedData} from '../types';
+import type {LoadedDataset, LoadJob, PaginatedData} from '../types';
+
+// Загрузка идёт на сервере в фоне, опрашиваем задачу, пока она не завершится
+const waitForLoadJob = async (jobId: string, pollIntervalMs = 500): Promise<LoadJob> => {
+    for (;;) {
+        const {data: job} = await api.getLoadJob(jobId);
+        if (job.state === 'completed') return job;
+        if (job.state === 'failed') throw new Error(job.error ?? 'Load failed');
+        await new Promise(resolve => setTimeout(resolve, pollIntervalMs));
+    }
+};
 
 export const useDatasets = () => {
     const [available, setAvailable] = useState<string[]>([]);
@@ -34,7 +44,8 @@ export const useDatasets = () => {
         setIsLoading(true);
         setError(null);
         try {
-            await api.loadDataset(filePath);
+            const res = await api.loadDataset(filePath);
+            await waitForLoadJob(res.data.jobId);
             await fetchAll(); // Обновляем списки
         } catch (e: any) {
             setError(`Failed to load ${filePath}. ${e.response?.data?.error || e.message}`);
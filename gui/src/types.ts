@@ -14,4 +14,18 @@ export interface PaginatedData {
     totalRows: number;
     headers: string[];
     data: string[][];
-}
\ No newline at end of file
+}
+
+export type LoadMode = 'memory' | 'lazy';
+
+export interface LoadJob {
+    jobId: string;
+    filePath: string;
+    mode: LoadMode;
+    state: 'queued' | 'running' | 'completed' | 'failed';
+    totalBytes: number;
+    bytesProcessed: number;
+    rowsProcessed: number;
+    datasetId?: string;
+    error?: string;
+}
@@ -28,6 +28,8 @@ void irisExample() {
             .train(1500, 0.1f, 10)
             .evaluate();
 
+        // записи лога пишет фоновый поток: выводим их до прямой печати
+        Log::flush();
         std::println(std::cout, "--- Prediction Example ---");
 
         Eigen::VectorXf sample = (Eigen::VectorXf(4) << 5.1, 3.5, 1.4, 0.2).finished();
@@ -40,6 +42,7 @@ void irisExample() {
         std::println(std::cout, " (Expected: [1.00, 0.00, 0.00])");
 
     } catch (const std::exception& e) {
+        Log::flush();
         std::println(std::cout, "An error occurred: {}", e.what());
     }
 }
@@ -57,11 +60,13 @@ void bjuExample() {
             .evaluate();
 
         Eigen::VectorXf newProduct = (Eigen::VectorXf(3) << 150, 80, 120).finished();
+        Log::flush();
         std::print(std::cout, "Predicting for B/J/U: ");
         printVector(newProduct);
         std::println(std::cout, " -> Predicted kcal: {:.1f}", regressor.predict(newProduct)(0));
 
     } catch (const std::exception& e) {
+        Log::flush();
         std::println(std::cout, "An error occurred: {}", e.what());
     }
 }
@@ -0,0 +1,317 @@
+#include "ColumnStatsService.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "../util/hash/HyperLogLog.hpp"
+#include "../util/logging.hpp"
+
+namespace {
+    // кусок строк - единица параллельной работы; кратен 64, чтобы начинаться с целого слова маски
+    constexpr size_t chunkRows = size_t{1} << 18;
+    // блок значений, который целиком помещается в L1 и проходится плотными циклами
+    constexpr size_t blockRows = 1024;
+
+    /**
+     * @brief Моменты части колонки. Части сливаются формулой Чана в любом порядке.
+     */
+    struct Moments {
+        u64 count = 0;
+        f64 mean = 0;
+        f64 m2 = 0; // сумма квадратов отклонений от mean
+        f64 min = std::numeric_limits<f64>::infinity();
+        f64 max = -std::numeric_limits<f64>::infinity();
+
+        void merge(const Moments& other) {
+            if (other.count == 0) {
+                return;
+            }
+            if (count == 0) {
+                *this = other;
+                return;
+            }
+            const f64 total = static_cast<f64>(count + other.count);
+            const f64 delta = other.mean - mean;
+            mean += delta * static_cast<f64>(other.count) / total;
+            m2 += other.m2 + delta * delta * static_cast<f64>(count) * static_cast<f64>(other.count) / total;
+            count += other.count;
+            min = std::min(min, other.min);
+            max = std::max(max, other.max);
+        }
+    };
+
+    // моменты плотного блока: сначала среднее, потом отклонения от него - два цикла без ветвлений
+    Moments blockMoments(const f64* values, size_t count) {
+        Moments block;
+        if (count == 0) {
+            return block;
+        }
+        f64 sum = 0;
+        f64 min = values[0];
+        f64 max = values[0];
+        for (size_t i = 0; i < count; ++i) {
+            sum += values[i];
+            min = values[i] < min ? values[i] : min;
+            max = values[i] > max ? values[i] : max;
+        }
+        const f64 mean = sum / static_cast<f64>(count);
+        f64 m2 = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const f64 d = values[i] - mean;
+            m2 += d * d;
+        }
+        block.count = count;
+        block.mean = mean;
+        block.m2 = m2;
+        block.min = min;
+        block.max = max;
+        return block;
+    }
+
+    /**
+     * @brief Копирует валидные конечные значения строк [first, first + count) в out как f64.
+     * first кратен 64. Слово маски без пропусков копируется сплошным циклом.
+     * @return Сколько значений записано; nonFinite увеличивается на число NaN и бесконечностей.
+     */
+    template<typename T>
+    size_t gatherValid(const Column& column, size_t first, size_t count, f64* out, u64& nonFinite) {
+        const T* values = column.values<T>().data() + first;
+        const u64* validity = column.validity().data() + first / 64;
+        size_t written = 0;
+        for (size_t offset = 0; offset < count; offset += 64) {
+            const size_t n = std::min<size_t>(64, count - offset);
+            u64 bits = validity[offset / 64];
+            if (n < 64) {
+                bits &= (u64{1} << n) - 1;
+            }
+            if (bits == (n < 64 ? (u64{1} << n) - 1 : ~u64{0})) {
+                for (size_t i = 0; i < n; ++i) {
+                    out[written + i] = static_cast<f64>(values[offset + i]);
+                }
+                written += n;
+            } else {
+                for (; bits != 0; bits &= bits - 1) {
+                    out[written++] = static_cast<f64>(values[offset + std::countr_zero(bits)]);
+                }
+            }
+        }
+        if constexpr (std::is_floating_point_v<T>) {
+            // выкидываем NaN и бесконечности без ветвления: запись на место, сдвиг только для конечных
+            size_t finite = 0;
+            for (size_t i = 0; i < written; ++i) {
+                out[finite] = out[i];
+                finite += std::isfinite(out[i]);
+            }
+            nonFinite += written - finite;
+            written = finite;
+        }
+        return written;
+    }
+
+    size_t gatherValid(const Column& column, size_t first, size_t count, f64* out, u64& nonFinite) {
+        switch (column.type()) {
+            case ColumnType::I64: return gatherValid<i64>(column, first, count, out, nonFinite);
+            case ColumnType::F32: return gatherValid<f32>(column, first, count, out, nonFinite);
+            case ColumnType::F64: return gatherValid<f64>(column, first, count, out, nonFinite);
+            case ColumnType::STRING: break;
+        }
+        return 0;
+    }
+
+    // словарь может быть общим с колонкой, из которой строки выбраны фильтром, - считаем встреченные коды
+    u64 distinctCodes(const Column& column) {
+        const auto& data = column.strings();
+        std::vector<u64> seen((data.dictionarySize() + 63) / 64, 0);
+        for (size_t row = 0; row < column.size(); ++row) {
+            const u32 code = data.codes[row];
+            seen[code >> 6] |= u64{column.isValid(row)} << (code & 63);
+        }
+        u64 distinct = 0;
+        for (const u64 word : seen) {
+            distinct += std::popcount(word);
+        }
+        return distinct;
+    }
+
+    // равные значения дают равный хэш; -0.0 и 0.0 - одно значение
+    u64 valueHash(f64 value) {
+        return mixHash64(std::bit_cast<u64>(value + 0.0));
+    }
+
+    struct ChunkStats {
+        Moments moments;
+        u64 nonFinite = 0;
+        HyperLogLog distinct;
+    };
+
+    struct Task {
+        size_t column; // номер среди числовых колонок
+        size_t firstRow;
+        size_t rowCount;
+    };
+}
+
+ColumnStatsService::ColumnStatsService(u32 threads) : _threads(std::max<u32>(threads, 1)) {
+}
+
+std::shared_ptr<const DatasetStatistics> ColumnStatsService::statistics(const std::shared_ptr<const Dataset>& dataset, u32 bins) {
+    const std::string key = dataset->id + "|" + std::to_string(bins);
+    if (auto cached = _cache.get(key)) {
+        return std::move(*cached);
+    }
+
+    // первый запрос считает, остальные ждут его результат
+    std::promise<Result> promise;
+    std::shared_future<Result> pending;
+    {
+        std::lock_guard lock(_inFlightMutex);
+        if (const auto it = _inFlight.find(key); it != _inFlight.end()) {
+            pending = it->second;
+        } else {
+            _inFlight.emplace(key, promise.get_future().share());
+        }
+    }
+    if (pending.valid()) {
+        return pending.get();
+    }
+
+    try {
+        auto result = std::make_shared<const DatasetStatistics>(compute(dataset, bins, _threads));
+        size_t bytes = sizeof(DatasetStatistics);
+        for (const auto& column : result->columns) {
+            bytes += sizeof(ColumnStatistics) + column.name.size() + (column.histogram ? column.histogram->counts.size() * sizeof(u64) : 0);
+        }
+        _cache.put(key, result, bytes);
+        promise.set_value(result);
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+    }
+
+    std::lock_guard lock(_inFlightMutex);
+    auto future = std::move(_inFlight.at(key));
+    _inFlight.erase(key);
+    return future.get();
+}
+
+void ColumnStatsService::invalidate(const std::string& datasetId) {
+    _cache.erasePrefix(datasetId + "|");
+}
+
+DatasetStatistics ColumnStatsService::compute(const std::shared_ptr<const Dataset>& dataset, u32 bins, u32 threads) {
+    const auto startedAt = std::chrono::steady_clock::now();
+
+    // результат трансформаций читает колонки источника без копирования
+    const auto plan = TransformPlan::of(dataset);
+    const auto columns = plan->materializeColumns();
+    const auto headers = plan->headers();
+
+    DatasetStatistics result;
+    result.datasetId = dataset->id;
+    result.rows = dataset->rowCount;
+    result.bins = bins;
+    result.columns.resize(columns.size());
+
+    std::vector<size_t> numeric;
+    for (size_t c = 0; c < columns.size(); ++c) {
+        const Column& column = columns[c];
+        ColumnStatistics& stats = result.columns[c];
+        stats.name = headers[c];
+        stats.type = column.type();
+        stats.nulls = column.nullCount();
+        stats.count = column.size() - column.nullCount();
+        if (column.type() == ColumnType::STRING) {
+            // каждое значение словаря встречается в нём один раз - число различных известно точно
+            stats.distinct = distinctCodes(column);
+            stats.distinctExact = true;
+        } else {
+            numeric.push_back(c);
+        }
+    }
+
+    std::vector<Task> tasks;
+    for (size_t n = 0; n < numeric.size(); ++n) {
+        for (size_t first = 0; first < dataset->rowCount; first += chunkRows) {
+            tasks.push_back({n, first, std::min(chunkRows, dataset->rowCount - first)});
+        }
+    }
+
+    // первый проход: моменты и различные значения каждого куска
+    std::vector<ChunkStats> chunks(tasks.size());
+    Concurrency::parallelFor(tasks.size(), threads, [&](size_t t) {
+        const Task& task = tasks[t];
+        const Column& column = columns[numeric[task.column]];
+        ChunkStats& chunk = chunks[t];
+        std::vector<f64> block(blockRows);
+        for (size_t offset = 0; offset < task.rowCount; offset += blockRows) {
+            const size_t count = std::min(blockRows, task.rowCount - offset);
+            const size_t valid = gatherValid(column, task.firstRow + offset, count, block.data(), chunk.nonFinite);
+            chunk.moments.merge(blockMoments(block.data(), valid));
+            for (size_t i = 0; i < valid; ++i) {
+                chunk.distinct.add(valueHash(block[i]));
+            }
+        }
+    });
+
+    // куски сливаются по порядку, так что результат не зависит от распределения по потокам
+    std::vector<Moments> moments(numeric.size());
+    std::vector<HyperLogLog> distinct(numeric.size());
+    for (size_t t = 0; t < tasks.size(); ++t) {
+        const size_t n = tasks[t].column;
+        moments[n].merge(chunks[t].moments);
+        distinct[n].merge(chunks[t].distinct);
+        result.columns[numeric[n]].nonFinite += chunks[t].nonFinite;
+    }
+    chunks.clear();
+
+    for (size_t n = 0; n < numeric.size(); ++n) {
+        ColumnStatistics& stats = result.columns[numeric[n]];
+        stats.distinct = distinct[n].estimate();
+        if (moments[n].count > 0) {
+            const Moments& m = moments[n];
+            stats.summary = NumericSummary{m.min, m.max, m.mean, m.count > 1 ? m.m2 / static_cast<f64>(m.count - 1) : 0};
+            stats.histogram = Histogram{m.min, m.max, std::vector<u64>(bins, 0)};
+        }
+    }
+
+    // второй проход: гистограмма по уже известному диапазону, у каждого куска свои счётчики
+    std::vector<std::vector<u64>> binCounts(tasks.size());
+    Concurrency::parallelFor(tasks.size(), threads, [&](size_t t) {
+        const Task& task = tasks[t];
+        const Moments& range = moments[task.column];
+        if (range.count == 0 || bins == 0) {
+            return;
+        }
+        const Column& column = columns[numeric[task.column]];
+        auto& counts = binCounts[t];
+        counts.assign(bins, 0);
+        const f64 width = range.max - range.min;
+        const f64 scale = width > 0 ? static_cast<f64>(bins) / width : 0;
+        const size_t lastBin = bins - 1;
+
+        std::vector<f64> block(blockRows);
+        u64 ignored = 0;
+        for (size_t offset = 0; offset < task.rowCount; offset += blockRows) {
+            const size_t count = std::min(blockRows, task.rowCount - offset);
+            const size_t valid = gatherValid(column, task.firstRow + offset, count, block.data(), ignored);
+            for (size_t i = 0; i < valid; ++i) {
+                const auto bin = static_cast<size_t>((block[i] - range.min) * scale);
+                ++counts[std::min(bin, lastBin)];
+            }
+        }
+    });
+    for (size_t t = 0; t < tasks.size(); ++t) {
+        auto& histogram = result.columns[numeric[tasks[t].column]].histogram;
+        for (size_t b = 0; b < binCounts[t].size(); ++b) {
+            histogram->counts[b] += binCounts[t][b];
+        }
+    }
+
+    result.computeMs = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - startedAt).count();
+    Log::Logger().info("Statistics for dataset '{}': {} rows x {} columns, {} chunks, {:.1f} ms",
+                       dataset->name, dataset->rowCount, columns.size(), tasks.size(), result.computeMs);
+    return result;
+}
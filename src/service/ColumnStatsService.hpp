@@ -0,0 +1,102 @@
+#ifndef COLUMNSTATSSERVICE_HPP
+#define COLUMNSTATSSERVICE_HPP
+
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "DatasetService.hpp"
+#include "../util/cache/ShardedLruCache.hpp"
+
+/**
+ * @brief Моменты числовой колонки по конечным значениям.
+ */
+struct NumericSummary {
+    f64 min;
+    f64 max;
+    f64 mean;
+    f64 variance; // выборочная, с делителем n - 1; для одного значения 0
+};
+
+/**
+ * @brief Гистограмма с равными интервалами на [lower, upper]; верхняя граница входит в последний интервал.
+ */
+struct Histogram {
+    f64 lower;
+    f64 upper;
+    std::vector<u64> counts;
+};
+
+struct ColumnStatistics {
+    std::string name;
+    ColumnType type;
+    u64 count = 0;     // непустые ячейки
+    u64 nulls = 0;
+    u64 nonFinite = 0; // NaN и бесконечности дробных колонок: в count входят, в моменты и гистограмму нет
+    u64 distinct = 0;
+    bool distinctExact = false; // у строковых колонок - точно по кодам словаря, у числовых - оценка HyperLogLog
+    std::optional<NumericSummary> summary;  // числовая колонка хотя бы с одним конечным значением
+    std::optional<Histogram> histogram;
+};
+
+struct DatasetStatistics {
+    std::string datasetId;
+    u64 rows = 0;
+    u32 bins = 0;
+    std::vector<ColumnStatistics> columns;
+    f64 computeMs = 0;
+};
+
+/**
+ * @brief Сводная статистика по колонкам загруженных датасетов.
+ *
+ * Числовая колонка режется на куски строк, куски всех колонок обрабатываются параллельно.
+ * Внутри куска значения идут блоками: валидные копируются в плотный буфер, по которому
+ * min/max/сумма и отклонения от среднего блока считаются простыми циклами без ветвлений,
+ * а блоки и куски сливаются формулой Чана (параллельный вариант Уэлфорда) - сумма квадратов
+ * не теряет точность на больших значениях. Гистограмме нужен диапазон, поэтому она строится
+ * вторым проходом, когда min/max всех кусков уже известны.
+ *
+ * Датасет после регистрации не меняется, а id не переиспользуются, поэтому результат кэшируется
+ * по id; одновременные запросы одной статистики ждут одно вычисление.
+ */
+class ColumnStatsService {
+public:
+    /**
+     * @param threads Сколько потоков использовать для одного вычисления.
+     */
+    explicit ColumnStatsService(u32 threads = Concurrency::defaultThreadCount());
+
+    /**
+     * @brief Статистика датасета из кэша или вычисленная сейчас.
+     * @throws std::runtime_error если колонок датасета нет в памяти (ленивый датасет).
+     */
+    std::shared_ptr<const DatasetStatistics> statistics(const std::shared_ptr<const Dataset>& dataset, u32 bins);
+
+    /**
+     * @brief Забывает статистику выгруженного датасета.
+     */
+    void invalidate(const std::string& datasetId);
+
+    [[nodiscard]] Cache::CacheStats cacheStats() { return _cache.stats(); }
+
+    /**
+     * @brief Считает статистику без кэша.
+     * @throws std::runtime_error если колонок датасета нет в памяти (ленивый датасет).
+     */
+    static DatasetStatistics compute(const std::shared_ptr<const Dataset>& dataset, u32 bins, u32 threads);
+
+private:
+    using Result = std::shared_ptr<const DatasetStatistics>;
+
+    u32 _threads;
+    Cache::ShardedLruCache<Result> _cache{FRAMEWORK_CONSTANTS::statsCacheBytes};
+    std::mutex _inFlightMutex;
+    std::unordered_map<std::string, std::shared_future<Result>> _inFlight;
+};
+
+#endif
@@ -9,9 +9,14 @@
 #include <memory>
 #include <stdexcept>
 #include <algorithm>
+#include <charconv>
 #include <cmath>
 #include <filesystem>
+#include <unordered_set>
 #include "../util/constants.hpp"
+#include "../util/csv/CsvChunks.hpp"
+#include "../util/csv/CsvReader.hpp"
+#include "../util/io/MappedFile.hpp"
 
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_generators.hpp>
@@ -21,6 +26,53 @@
 namespace fs = std::filesystem;
 
 
+namespace {
+    // новый объект датасета с теми же метаданными, но без данных
+    std::shared_ptr<Dataset> cloneMetadata(const Dataset& source) {
+        auto dataset = std::make_shared<Dataset>();
+        dataset->id = source.id;
+        dataset->name = source.name;
+        dataset->headers = source.headers;
+        dataset->rowCount = source.rowCount;
+        dataset->columnCount = source.columnCount;
+        dataset->createdAt = source.createdAt;
+        dataset->lastAccess = source.lastAccess.load();
+        return dataset;
+    }
+
+    // колонка ищется по имени, а если такого заголовка нет - по номеру
+    std::vector<u32> resolveColumns(const std::vector<std::string>& headers, const std::vector<std::string>& names) {
+        std::vector<u32> columns;
+        columns.reserve(names.size());
+        for (const auto& name : names) {
+            const auto it = std::ranges::find(headers, name);
+            if (it != headers.end()) {
+                columns.push_back(static_cast<u32>(it - headers.begin()));
+                continue;
+            }
+            u32 index = 0;
+            const auto [end, ec] = std::from_chars(name.data(), name.data() + name.size(), index);
+            if (ec != std::errc() || end != name.data() + name.size() || index >= headers.size()) {
+                throw std::runtime_error("Unknown column '" + name + "'.");
+            }
+            columns.push_back(index);
+        }
+        return columns;
+    }
+}
+
+DatasetService::DatasetService(u32 loadThreads)
+    : _loadThreads(std::max<u32>(loadThreads, 1)),
+      _memoryBudget(FRAMEWORK_CONSTANTS::datasetMemoryBudgetBytes) {
+    // файлы вытеснения от прошлого запуска никому не принадлежат
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(FRAMEWORK_CONSTANTS::spillDirectory, ec)) {
+        if (entry.path().extension() == datasetSnapshotExtension) {
+            fs::remove(entry.path(), ec);
+        }
+    }
+}
+
 std::vector<std::string> DatasetService::listAvailableDatasets(const std::string& directoryPath) const {
     std::vector<std::string> fileList;
     if (!fs::exists(directoryPath) || !fs::is_directory(directoryPath)) {
@@ -31,7 +83,8 @@ std::vector<std::string> DatasetService::listAvailableDatasets(const std::string
     fs::recursive_directory_iterator endit;
 
     while (it != endit) {
-        if (fs::is_regular_file(*it) && it->path().extension() == ".csv") {
+        const auto extension = it->path().extension();
+        if (fs::is_regular_file(*it) && (extension == ".csv" || extension == datasetSnapshotExtension)) {
             fileList.push_back(it->path().string());
         }
         ++it;
@@ -39,31 +92,180 @@ std::vector<std::string> DatasetService::listAvailableDatasets(const std::string
     return fileList;
 }
 
-std::string DatasetService::loadDataset(const std::string& filePath) {
-    // лочим мьютекс на время всей операции
-    std::lock_guard lock(_mutex);
-
-    // парсим CSV
-    auto [headers, rawData] = parseCsv(filePath);
+std::string DatasetService::loadDataset(const std::string& filePath, DatasetLoadMode mode) {
+    return loadDatasetWithProgress(filePath, mode, nullptr);
+}
 
-    // генерируем уникальный ID
-    const boost::uuids::uuid uuid = boost::uuids::random_generator()();
-    std::string id = to_string(uuid);
+std::shared_ptr<Dataset> DatasetService::parseDataset(const std::string& filePath, u32 threads, LoadProgress* progress) {
+    auto [headers, columns, rowCount] = parseCsv(filePath, threads, progress);
 
     // cоздаем и заполняем Dataset
     auto dataset = std::make_shared<Dataset>();
-    dataset->id = id;
-    dataset->name = fs::path(filePath).filename().string();
     dataset->headers = std::move(headers);
-    dataset->rawData = std::move(rawData);
-    dataset->rowCount = dataset->rawData.size();
+    dataset->columns = std::move(columns);
+    dataset->rowCount = rowCount;
     dataset->columnCount = dataset->headers.size();
-    dataset->createdAt = std::chrono::system_clock::now();
+    return dataset;
+}
 
-    // сейвим в мапу
-    _datasets[id] = dataset;
+std::shared_ptr<Dataset> DatasetService::openLazyDataset(const std::string& filePath, LoadProgress* progress) {
+    LazyCsvTable::ProgressCallback onProgress;
+    if (progress) {
+        onProgress = [progress](u64 bytes, u64 rows) {
+            progress->bytesProcessed += bytes;
+            progress->rowsProcessed += rows;
+            progress->advanced();
+        };
+    }
+    auto table = std::make_shared<const LazyCsvTable>(filePath, onProgress);
 
-    return id;
+    auto dataset = std::make_shared<Dataset>();
+    dataset->headers = table->headers();
+    dataset->rowCount = table->rowCount();
+    dataset->columnCount = dataset->headers.size();
+    dataset->lazyTable = std::move(table);
+    return dataset;
+}
+
+std::shared_ptr<Dataset> DatasetService::openSnapshotDataset(const std::string& filePath, LoadProgress* progress) {
+    auto [headers, columns, rowCount] = readDatasetSnapshot(filePath);
+
+    auto dataset = std::make_shared<Dataset>();
+    dataset->headers = std::move(headers);
+    dataset->columns = std::move(columns);
+    dataset->rowCount = rowCount;
+    dataset->columnCount = dataset->headers.size();
+
+    if (progress) {
+        progress->bytesProcessed = fs::file_size(filePath);
+        progress->rowsProcessed = rowCount;
+    }
+    return dataset;
+}
+
+std::string DatasetService::loadDatasetWithProgress(const std::string& filePath, DatasetLoadMode mode, LoadProgress* progress) {
+    const auto startedAt = std::chrono::steady_clock::now();
+
+    // парсим CSV; реестр на это время не блокируется, чтобы не мешать чтению других датасетов
+    std::shared_ptr<Dataset> dataset;
+    if (fs::path(filePath).extension() == datasetSnapshotExtension) {
+        dataset = openSnapshotDataset(filePath, progress);
+    } else if (mode == DatasetLoadMode::LAZY) {
+        dataset = openLazyDataset(filePath, progress);
+    } else {
+        dataset = parseDataset(filePath, _loadThreads, progress);
+    }
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startedAt);
+    Log::Logger().info("Dataset '{}' {}: {} rows x {} columns, {} bytes on heap, {} ms",
+                       fs::path(filePath).filename().string(), dataset->isLazy() ? "indexed" : "loaded",
+                       dataset->rowCount, dataset->columnCount, dataset->memoryBytes(), elapsed.count());
+
+    // публикуем полностью готовый датасет
+    return registerTransformedDataset(std::move(dataset), fs::path(filePath).filename().string());
+}
+
+std::string DatasetService::startLoadJob(const std::string& filePath, DatasetLoadMode mode) {
+    if (!fs::is_regular_file(filePath)) {
+        throw std::runtime_error("Could not open file: " + filePath);
+    }
+
+    auto job = std::make_shared<LoadJob>();
+    job->id = to_string(boost::uuids::random_generator()());
+    job->filePath = filePath;
+    job->mode = mode;
+    job->totalBytes = fs::file_size(filePath);
+
+    {
+        std::lock_guard lock(_jobsMutex);
+        pruneFinishedJobs_locked();
+        _jobs[job->id] = job;
+    }
+    publishLoadProgress(*job, ProgressState::QUEUED);
+
+    _loadPool.submit([this, job] { runLoadJob(job); });
+    return job->id;
+}
+
+void DatasetService::runLoadJob(const std::shared_ptr<LoadJob>& job) {
+    job->startedAt = std::chrono::steady_clock::now();
+    job->state = LoadJobState::RUNNING;
+    if (_progressHub) {
+        job->progress.onAdvance = [this, &job = *job] { publishLoadProgress(job, ProgressState::RUNNING); };
+    }
+    publishLoadProgress(*job, ProgressState::RUNNING);
+
+    try {
+        const std::string datasetId = loadDatasetWithProgress(job->filePath, job->mode, &job->progress);
+        {
+            std::lock_guard lock(_jobsMutex);
+            job->datasetId = datasetId;
+            job->finishedAt = std::chrono::steady_clock::now();
+            job->state = LoadJobState::COMPLETED;
+        }
+        // после смены состояния: подписчик, получивший событие, увидит то же и в GET задачи
+        publishLoadProgress(*job, ProgressState::COMPLETED, datasetId);
+    } catch (const std::exception& e) {
+        Log::Logger().error("Failed to load dataset '{}': {}", job->filePath, e.what());
+        {
+            std::lock_guard lock(_jobsMutex);
+            job->error = e.what();
+            job->finishedAt = std::chrono::steady_clock::now();
+            job->state = LoadJobState::FAILED;
+        }
+        publishLoadProgress(*job, ProgressState::FAILED, {}, e.what());
+    }
+}
+
+void DatasetService::publishLoadProgress(const LoadJob& job, ProgressState state, const std::string& datasetId, const std::string& error) const {
+    if (!_progressHub) {
+        return;
+    }
+    ProgressEvent event;
+    event.topic = job.id;
+    event.kind = ProgressKind::LOAD;
+    event.state = state;
+    event.rows = job.progress.rowsProcessed.load(std::memory_order_relaxed);
+    event.bytes = job.progress.bytesProcessed.load(std::memory_order_relaxed);
+    event.totalBytes = job.totalBytes;
+    if (state != ProgressState::QUEUED) {
+        const std::chrono::duration<f64> elapsed = std::chrono::steady_clock::now() - job.startedAt;
+        event.throughput = elapsed.count() > 0 ? static_cast<f64>(event.rows) / elapsed.count() : 0;
+    }
+    event.datasetId = datasetId;
+    event.error = error;
+    _progressHub->publish(std::move(event));
+}
+
+std::optional<LoadJobStatus> DatasetService::getLoadJob(const std::string& jobId) const {
+    std::lock_guard lock(_jobsMutex);
+    auto it = _jobs.find(jobId);
+    if (it == _jobs.end()) {
+        return std::nullopt;
+    }
+    const auto& job = *it->second;
+    return LoadJobStatus{
+        job.id,
+        job.filePath,
+        job.mode,
+        job.state.load(),
+        job.totalBytes,
+        job.progress.bytesProcessed.load(),
+        job.progress.rowsProcessed.load(),
+        job.datasetId,
+        job.error
+    };
+}
+
+void DatasetService::pruneFinishedJobs_locked() {
+    // завершённые задачи держим какое-то время, чтобы клиент успел забрать результат
+    constexpr auto retention = std::chrono::minutes(10);
+    const auto now = std::chrono::steady_clock::now();
+    std::erase_if(_jobs, [&](const auto& entry) {
+        const auto state = entry.second->state.load();
+        return (state == LoadJobState::COMPLETED || state == LoadJobState::FAILED)
+               && now - entry.second->finishedAt > retention;
+    });
 }
 
 std::vector<std::pair<std::string, std::string>> DatasetService::loadedDatasetsList() const {
@@ -78,8 +280,13 @@ std::vector<std::pair<std::string, std::string>> DatasetService::loadedDatasetsL
 
 std::vector<std::pair<std::string, std::string>> DatasetService::unloadDataset(const std::string& id) {
      std::lock_guard lock(_mutex);
-     if(_datasets.contains(id)){
-         _datasets.erase(id);
+     if(auto it = _datasets.find(id); it != _datasets.end()){
+         if (it->second->isSpilled()) {
+             // отображение у уже выданных колонок остаётся рабочим и после удаления файла
+             std::error_code ec;
+             fs::remove(it->second->spillPath, ec);
+         }
+         _datasets.erase(it);
      }
 
     std::vector<std::pair<std::string, std::string>> list;
@@ -91,146 +298,171 @@ std::vector<std::pair<std::string, std::string>> DatasetService::unloadDataset(c
 }
 
 
-std::optional<PaginatedData> DatasetService::getDatasetPage(const std::string& datasetId, u32 page, u32 pageSize) const {
-    std::shared_lock lock(_mutex);
-
-    auto it = _datasets.find(datasetId);
-    if (it == _datasets.end()) {
+std::optional<PaginatedData> DatasetService::getDatasetPage(const std::string& datasetId, const DatasetPageRequest& request) const {
+    const auto view = openDatasetPage(datasetId, request);
+    if (!view) {
         return std::nullopt;
     }
 
-    auto dataset = it->second;
+    auto paginated = PaginatedData{};
+    paginated.id = view->dataset->id;
+    paginated.name = view->dataset->name;
+    paginated.page = view->page;
+    paginated.pageSize = view->pageSize;
+    paginated.totalPages = view->totalPages;
+    paginated.totalRows = view->dataset->rowCount;
+    paginated.headers = view->plan->headers();
+
+    // вычисляем только строки и колонки этой страницы: из колонок, из файла ленивого датасета
+    // или через план трансформаций - он за один проход отдаёт уже преобразованные строки
+    paginated.data.reserve(view->rowCount);
+    view->plan->readRows(view->firstRow, view->rowCount, [&](std::span<const std::string_view> cells) {
+        paginated.data.emplace_back(cells.begin(), cells.end());
+    });
 
-    if (page < 1 || pageSize < 1) {
-        // невалидные параметры пагинации
+    return paginated;
+}
+
+std::optional<DatasetPageView> DatasetService::openDatasetPage(const std::string& datasetId, const DatasetPageRequest& request) const {
+    // реестр блокируем только на время поиска: ленивый датасет читает страницу с диска
+    auto dataset = getDatasetById(datasetId);
+    if (!dataset) {
         return std::nullopt;
     }
 
-    auto paginated = PaginatedData{};
-    paginated.id = dataset->id;
-    paginated.name = dataset->name;
-    paginated.page = page;
-    paginated.pageSize = pageSize;
-    paginated.totalRows = dataset->rowCount;
-    paginated.headers = dataset->headers;
-    paginated.totalPages = static_cast<u32>(std::ceil(static_cast<double>(dataset->rowCount) / pageSize));
-
-    if (paginated.totalPages == 0) paginated.totalPages = 1;
+    const u32 pageSize = request.pageSize;
+    if (pageSize < 1 || (!request.firstRow && request.page < 1)) {
+        // невалидные параметры пагинации
+        return std::nullopt;
+    }
+    if (pageSize > FRAMEWORK_CONSTANTS::maxPageSize) {
+        throw std::runtime_error("Page size must not exceed " + std::to_string(FRAMEWORK_CONSTANTS::maxPageSize) + " rows.");
+    }
 
+    u32 totalPages = static_cast<u32>(std::ceil(static_cast<double>(dataset->rowCount) / pageSize));
+    if (totalPages == 0) totalPages = 1;
 
-    // считаем диапазон строк для текущей страницы
-    size_t startIndex = (page - 1) * pageSize;
-    if (startIndex >= dataset->rowCount) {
-        // страница находится за пределами данных, возвращаем пустые данные
-        return paginated;
-    }
-    size_t endIndex = std::min(startIndex + pageSize, dataset->rowCount);
+    // курсор задаёт первую строку прямо: датасет неизменяем, поэтому номер строки - надёжный ключ
+    // и глубокая страница не требует пересчёта смещения; номер страницы тогда только для справки
+    const size_t startIndex = request.firstRow ? *request.firstRow : static_cast<size_t>(request.page - 1) * pageSize;
+    const u32 page = request.firstRow ? static_cast<u32>(startIndex / pageSize + 1) : request.page;
+    // страница за пределами данных остаётся пустой
+    const size_t rowCount = startIndex < dataset->rowCount ? std::min<size_t>(pageSize, dataset->rowCount - startIndex) : 0;
 
-    // копируем нужный срез данных
-    paginated.data.reserve(endIndex - startIndex);
-    for(size_t i = startIndex; i < endIndex; ++i) {
-        paginated.data.push_back(dataset->rawData[i]);
+    auto plan = TransformPlan::of(dataset);
+    if (!request.columns.empty()) {
+        plan = plan->projected(resolveColumns(dataset->headers, request.columns));
     }
-
-    return paginated;
+    return DatasetPageView{std::move(dataset), std::move(plan), page, pageSize, totalPages, startIndex, rowCount};
 }
 
 // парсер
-std::pair<std::vector<std::string>, std::vector<std::vector<std::string>>>
-DatasetService::parseCsv(const std::string& filePath) {
-    std::ifstream file(filePath);
-    if (!file.is_open()) {
-        throw std::runtime_error("Could not open file: " + filePath);
-    }
-
-    std::vector<std::string> headers;
-    std::vector<std::vector<std::string>> data;
-    std::string line;
-
-    auto parseLine = [](const std::string& lineStr) {
-        std::vector<std::string> row;
-        std::string cell;
-        bool inQuotes = false;
+DatasetService::ParsedCsv DatasetService::parseCsv(const std::string& filePath, u32 threads, LoadProgress* progress) {
+    // файл отображается в память целиком, ячейки читаются прямо из страничного кэша
+    const MappedFile file(filePath, MappedFile::AccessPattern::SEQUENTIAL);
+    const std::string_view data = file.view();
 
-        for (size_t i = 0; i < lineStr.length(); ++i) {
-            char c = lineStr[i];
-
-            if (inQuotes) {
-                if (c == '"') {
-                    // проверяем, это экранированная кавычка или конец поля
-                    if (i + 1 < lineStr.length() && lineStr[i+1] == '"') {
-                        cell += '"'; // если это экранированная кавычка, добавляем одну в ячейку
-                        i++; // пропускаем следующую кавычку
-                    } else {
-                        inQuotes = false; // иначе выходим из кавычек
-                    }
-                } else {
-                    cell += c; // если это обычный символ внутри кавычек
-                }
-            } else { // не в кавычках
-                if (c == '"') {
-                    inQuotes = true;
-                } else if (c == ',') {
-                    row.push_back(cell);
-                    cell.clear();
-                } else {
-                    cell += c;
-                }
-            }
-        }
-        row.push_back(cell); // добавляем последнюю ячейку
-        return row;
-    };
+    std::vector<std::string_view> cells;
 
     // чтение заголовков
-    if (std::getline(file, line)) {
-        // убираем возможный символ возврата каретки
-        if (!line.empty() && line.back() == '\r') {
-            line.pop_back();
-        }
-        headers = parseLine(line);
-    } else {
+    CsvReader headerReader(data);
+    if (!headerReader.next(cells)) {
         throw std::runtime_error("CSV file is empty or header is missing.");
     }
+    std::vector<std::string> headers(cells.begin(), cells.end());
+    const size_t dataBegin = headerReader.position();
+    if (progress) {
+        progress->bytesProcessed += dataBegin;
+    }
 
-    // чтение данных
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
-        if (!line.empty() && line.back() == '\r') {
-            line.pop_back();
-        }
-
-        std::vector<std::string> row = parseLine(line);
-
-        // проверка на случай, если в данных больше колонок, чем в заголовке
-        if (row.size() > headers.size()) {
+    // данные режем на куски по границам записей и разбираем параллельно,
+    // каждый поток строит свои колонки, затем они склеиваются по порядку
+    const auto chunks = splitCsvIntoChunks(data, dataBegin, csvChunkCount(data.size() - dataBegin, threads), ',', threads);
+    std::vector<std::vector<Column>> chunkColumns(chunks.size());
+    std::vector<size_t> chunkRows(chunks.size(), 0);
+
+    Concurrency::parallelFor(chunks.size(), threads, [&](size_t chunkIndex) {
+        const auto& chunk = chunks[chunkIndex];
+        CsvReader reader(data.substr(chunk.begin, chunk.end - chunk.begin));
+        std::vector<ColumnBuilder> builders(headers.size());
+        std::vector<std::string_view> row;
+
+        // прогресс публикуем пачками, чтобы не дёргать общие атомики на каждой строке
+        constexpr size_t progressStep = 4096;
+        size_t reportedBytes = 0;
+        size_t pendingRows = 0;
+        auto reportProgress = [&] {
+            if (progress) {
+                progress->bytesProcessed += reader.position() - reportedBytes;
+                progress->rowsProcessed += pendingRows;
+                progress->advanced();
+            }
+            reportedBytes = reader.position();
+            pendingRows = 0;
+        };
+
+        while (reader.next(row)) {
+            // проверка на случай, если в данных больше колонок, чем в заголовке
+            if (row.size() > headers.size()) {
+                Log::Logger().warning("Data have more column than header!");
+            }
 
-            Log::Logger().warning("Data have more column than header!");
+            // недостающие в конце строки ячейки считаем пустыми
+            for (size_t i = 0; i < builders.size(); ++i) {
+                builders[i].append(i < row.size() ? row[i] : std::string_view());
+            }
+            ++chunkRows[chunkIndex];
+            if (++pendingRows == progressStep) {
+                reportProgress();
+            }
+        }
+        reportProgress();
 
-            row.resize(headers.size());
+        chunkColumns[chunkIndex].reserve(builders.size());
+        for (auto& builder : builders) {
+            chunkColumns[chunkIndex].push_back(builder.finish());
         }
+    });
+
+    // склейка независима по колонкам, её тоже можно распараллелить
+    std::vector<Column> columns(headers.size());
+    Concurrency::parallelFor(headers.size(), threads, [&](size_t columnIndex) {
+        ColumnBuilder builder;
+        for (auto& parts : chunkColumns) {
+            builder.append(std::move(parts[columnIndex]));
+        }
+        columns[columnIndex] = builder.finish();
+    });
 
-        data.push_back(row);
+    size_t rowCount = 0;
+    for (const size_t rows : chunkRows) {
+        rowCount += rows;
     }
 
-    return {headers, data};
+    return {std::move(headers), std::move(columns), rowCount};
 }
 
 std::shared_ptr<const Dataset> DatasetService::getDatasetById(const std::string& id) const {
     std::shared_lock lock(_mutex);
     if (auto it = _datasets.find(id); it != _datasets.end()) {
+        touch(*it->second);
         return it->second;
     }
     return nullptr;
 }
 
 std::string DatasetService::registerTransformedDataset(std::shared_ptr<Dataset> dataset, const std::string& datasetName) {
-    std::lock_guard lock(_mutex);
-    return registerTransformedDataset_locked(std::move(dataset), datasetName);
+    std::string id;
+    {
+        std::lock_guard lock(_mutex);
+        id = registerTransformedDataset_locked(std::move(dataset), datasetName);
+    }
+    enforceMemoryBudget();
+    return id;
 }
 
 std::string DatasetService::copyAndRegisterDataset(const std::string& sourceId, const std::string& newName) {
-    std::lock_guard lock(_mutex);
+    std::unique_lock lock(_mutex);
 
     auto it = _datasets.find(sourceId);
     if (it == _datasets.end()) {
@@ -239,15 +471,21 @@ std::string DatasetService::copyAndRegisterDataset(const std::string& sourceId,
 
     auto sourceDataset = it->second;
 
-    // Создаем глубокую копию датасета
+    // Копия разделяет неизменяемые буферы колонок с исходным датасетом, данные не копируются
     auto newDataset = std::make_shared<Dataset>();
     newDataset->headers = sourceDataset->headers;
-    newDataset->rawData = sourceDataset->rawData;
+    newDataset->columns = sourceDataset->columns;
+    newDataset->lazyTable = sourceDataset->lazyTable; // таблица неизменяема, её можно разделять
+    newDataset->plan = sourceDataset->plan;
     newDataset->rowCount = sourceDataset->rowCount;
     newDataset->columnCount = sourceDataset->columnCount;
 
     // Регистрируем новую копию с новым именем
-    return registerTransformedDataset_locked(newDataset, newName);
+    std::string id = registerTransformedDataset_locked(newDataset, newName);
+    lock.unlock();
+
+    enforceMemoryBudget();
+    return id;
 }
 
 std::string DatasetService::registerTransformedDataset_locked(std::shared_ptr<Dataset> dataset, const std::string& datasetName) {
@@ -258,30 +496,174 @@ std::string DatasetService::registerTransformedDataset_locked(std::shared_ptr<Da
     dataset->id = id;
     dataset->name = datasetName;
     dataset->createdAt = std::chrono::system_clock::now();
+    touch(*dataset);
 
     _datasets[id] = std::move(dataset);
 
     return id;
 }
 
+void DatasetService::setMemoryBudget(size_t bytes) {
+    _memoryBudget = bytes;
+    enforceMemoryBudget();
+}
+
+MemoryUsage DatasetService::memoryUsage() const {
+    std::shared_lock lock(_mutex);
+    MemoryUsage usage{_memoryBudget, residentBytes_locked(), {}};
+    usage.datasets.reserve(_datasets.size());
+    for (const auto& [id, dataset] : _datasets) {
+        usage.datasets.push_back({id, dataset->name, dataset->memoryBytes(), dataset->isSpilled()});
+    }
+    return usage;
+}
+
+DatasetRegistryStats DatasetService::registryStats() const {
+    DatasetRegistryStats stats;
+    {
+        std::shared_lock lock(_mutex);
+        stats.datasets = _datasets.size();
+        stats.residentBytes = residentBytes_locked();
+        stats.budgetBytes = _memoryBudget;
+        for (const auto& [id, dataset] : _datasets) {
+            stats.rows += dataset->rowCount;
+            stats.lazyDatasets += dataset->isLazy();
+            stats.plannedDatasets += dataset->isPlanned();
+            stats.spilledDatasets += dataset->isSpilled();
+        }
+    }
+
+    std::lock_guard lock(_jobsMutex);
+    for (const auto& [id, job] : _jobs) {
+        const auto state = job->state.load();
+        stats.activeLoadJobs += state == LoadJobState::QUEUED || state == LoadJobState::RUNNING;
+    }
+    return stats;
+}
+
+size_t DatasetService::residentBytes_locked() const {
+    // копии и производные датасеты разделяют буферы, каждый буфер считаем один раз
+    std::unordered_set<const void*> seen;
+    size_t bytes = 0;
+    for (const auto& [id, dataset] : _datasets) {
+        for (const auto& column : dataset->columns) {
+            column.forEachHeapBuffer([&](const void* buffer, size_t size) {
+                if (seen.insert(buffer).second) {
+                    bytes += size;
+                }
+            });
+        }
+        if (dataset->lazyTable && seen.insert(dataset->lazyTable.get()).second) {
+            bytes += dataset->lazyTable->memoryBytes();
+        }
+        if (dataset->plan && seen.insert(dataset->plan.get()).second) {
+            bytes += dataset->plan->memoryBytes();
+        }
+    }
+    return bytes;
+}
+
+std::shared_ptr<Dataset> DatasetService::pickSpillCandidate_locked() const {
+    // вытесняем только датасеты со своими колонками в куче: ленивые и так живут в файле,
+    // а производные освобождаются вместе с источником
+    std::shared_ptr<Dataset> candidate;
+    for (const auto& [id, dataset] : _datasets) {
+        if (dataset->isLazy() || dataset->isPlanned() || dataset->isSpilled() || dataset->memoryBytes() == 0) {
+            continue;
+        }
+        if (!candidate || dataset->lastAccess < candidate->lastAccess) {
+            candidate = dataset;
+        }
+    }
+    return candidate;
+}
+
+void DatasetService::enforceMemoryBudget() {
+    std::lock_guard spillLock(_spillMutex);
+    for (;;) {
+        std::shared_ptr<Dataset> victim;
+        {
+            std::shared_lock lock(_mutex);
+            if (residentBytes_locked() <= _memoryBudget) {
+                return;
+            }
+            victim = pickSpillCandidate_locked();
+        }
+        if (!victim) {
+            Log::Logger().warning("Datasets exceed the memory budget of {} bytes, but nothing can be spilled", _memoryBudget.load());
+            return;
+        }
+
+        try {
+            spillDataset(victim);
+        } catch (const std::exception& e) {
+            Log::Logger().error("Failed to spill dataset '{}': {}", victim->name, e.what());
+            return;
+        }
+    }
+}
+
+bool DatasetService::spillDataset(const std::shared_ptr<Dataset>& dataset) {
+    const auto startedAt = std::chrono::steady_clock::now();
+
+    // снапшот пишем без блокировки реестра: датасет неизменяем, читатели не ждут диск
+    fs::create_directories(FRAMEWORK_CONSTANTS::spillDirectory);
+    const fs::path spillPath = fs::path(FRAMEWORK_CONSTANTS::spillDirectory) / (dataset->id + std::string(datasetSnapshotExtension));
+    writeDatasetSnapshot(spillPath.string(), dataset->headers, dataset->columns, dataset->rowCount);
+
+    // файл только что записан этим же процессом, контрольные суммы можно не пересчитывать;
+    // дальше страницы подтягиваются из файла при обращении, и вытесненный датасет остаётся доступным
+    auto snapshot = readDatasetSnapshot(spillPath.string(), false);
+    auto spilled = cloneMetadata(*dataset);
+    spilled->columns = std::move(snapshot.columns);
+    spilled->spillPath = spillPath.string();
+
+    {
+        std::lock_guard lock(_mutex);
+        auto it = _datasets.find(dataset->id);
+        if (it == _datasets.end() || it->second != dataset) {
+            // датасет выгрузили, пока писали снапшот
+            std::error_code ec;
+            fs::remove(spillPath, ec);
+            return false;
+        }
+        it->second = spilled;
+
+        // производные датасеты держат источник через план - переключаем их на вытесненную копию,
+        // иначе они удержат старые колонки в памяти
+        for (auto& [id, derived] : _datasets) {
+            if (derived->isPlanned() && &derived->plan->source() == dataset.get()) {
+                auto rebased = cloneMetadata(*derived);
+                rebased->plan = derived->plan->rebased(spilled);
+                derived = std::move(rebased);
+            }
+        }
+    }
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startedAt);
+    Log::Logger().info("Dataset '{}' spilled to '{}': {} bytes released, {} ms",
+                       dataset->name, spillPath.string(), dataset->memoryBytes(), elapsed.count());
+    return true;
+}
+
 namespace {
-    // Вспомогательная функция для экранирования ячейки CSV
-    std::string escapeCsvCell(const std::string& cell) {
-        // Если в ячейке нет запятых, кавычек или символов новой строки, возвращаем как есть
-        if (cell.find_first_of(",\"\n") == std::string::npos) {
-            return cell;
+    // Вспомогательная функция для экранирования ячейки CSV, дописывает результат в out
+    void appendEscapedCsvCell(std::string& out, std::string_view cell) {
+        // Если в ячейке нет запятых, кавычек или символов новой строки, пишем как есть
+        if (cell.find_first_of(",\"\n") == std::string_view::npos) {
+            out.append(cell);
+            return;
         }
 
-        std::string escaped = "\"";
+        out += '"';
         for (char c : cell) {
             if (c == '"') {
-                escaped += "\"\""; // Экранируем кавычку, удваивая ее
+                out += "\"\""; // Экранируем кавычку, удваивая ее
             } else {
-                escaped += c;
+                out += c;
             }
         }
-        escaped += "\"";
-        return escaped;
+        out += '"';
     }
 }
 
@@ -310,25 +692,78 @@ std::string DatasetService::saveDatasetToFile(const std::string& datasetId, cons
         throw std::runtime_error("Could not open file for writing: " + filePath.string());
     }
 
+    // Строки собираем в буфер и сбрасываем в файл пачками
+    std::string buffer;
+    constexpr size_t flushThreshold = 1 << 20;
+
     // Записываем заголовки
     for (size_t i = 0; i < dataset->headers.size(); ++i) {
-        outFile << escapeCsvCell(dataset->headers[i]);
+        appendEscapedCsvCell(buffer, dataset->headers[i]);
         if (i < dataset->headers.size() - 1) {
-            outFile << ",";
+            buffer += ',';
         }
     }
-    outFile << "\n";
+    buffer += '\n';
+
+    auto flushIfFull = [&] {
+        if (buffer.size() >= flushThreshold) {
+            outFile.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    };
 
     // Записываем данные
-    for (const auto& row : dataset->rawData) {
-        for (size_t i = 0; i < row.size(); ++i) {
-            outFile << escapeCsvCell(row[i]);
-            if (i < row.size() - 1) {
-                outFile << ",";
+    if (dataset->isLazy() || dataset->isPlanned()) {
+        // ленивый датасет и результат трансформаций вычисляем и пишем потоком, строка за строкой
+        TransformPlan::of(dataset)->readRows(0, dataset->rowCount, [&](std::span<const std::string_view> cells) {
+            for (size_t i = 0; i < cells.size(); ++i) {
+                appendEscapedCsvCell(buffer, cells[i]);
+                if (i < cells.size() - 1) {
+                    buffer += ',';
+                }
+            }
+            buffer += '\n';
+            flushIfFull();
+        });
+    } else {
+        for (size_t row = 0; row < dataset->rowCount; ++row) {
+            for (size_t i = 0; i < dataset->columns.size(); ++i) {
+                const auto& column = dataset->columns[i];
+                if (column.type() == ColumnType::STRING) {
+                    // экранировать нужно только строки, числа пишем напрямую
+                    appendEscapedCsvCell(buffer, column.stringAt(row));
+                } else {
+                    column.appendText(buffer, row);
+                }
+                if (i < dataset->columns.size() - 1) {
+                    buffer += ',';
+                }
             }
+            buffer += '\n';
+            flushIfFull();
         }
-        outFile << "\n";
+    }
+    outFile.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+
+    if (!outFile) {
+        throw std::runtime_error("Failed to write file: " + filePath.string());
     }
 
     return filePath.string();
-}
\ No newline at end of file
+}
+
+std::string DatasetService::saveDatasetSnapshot(const std::string& datasetId, const std::string& newName) {
+    auto dataset = getDatasetById(datasetId);
+    if (!dataset) {
+        throw std::runtime_error("Dataset with ID " + datasetId + " not found.");
+    }
+    // для результата трансформаций колонки собираются из буферов источника без копирования;
+    // у ленивого датасета колонок в памяти нет, а строить их ради снапшота - значит читать файл целиком
+    const auto columns = TransformPlan::of(dataset)->materializeColumns();
+
+    fs::path filePath = fs::path(FRAMEWORK_CONSTANTS::datasetsDirectory) / (fs::path(newName).stem().string() + std::string(datasetSnapshotExtension));
+    fs::create_directories(filePath.parent_path());
+
+    writeDatasetSnapshot(filePath.string(), dataset->headers, columns, dataset->rowCount);
+    return filePath.string();
+}
@@ -4,21 +4,60 @@
 
 #ifndef DATASETSERVICE_H
 #define DATASETSERVICE_H
+#include <atomic>
 #include <chrono>
 #include <shared_mutex>
 #include <string>
 #include <vector>
 #include "../util/types/eigen_types.hpp"
+#include "storage/Column.hpp"
+#include "storage/DatasetSnapshot.hpp"
+#include "storage/LazyCsvTable.hpp"
+#include "plan/TransformPlan.hpp"
+#include "ProgressHub.hpp"
+#include "../util/constants.hpp"
+#include "../util/concurrency/Parallel.hpp"
+#include "../util/concurrency/ThreadPool.hpp"
 
 
 struct Dataset {
     std::string id;
     std::string name; //имя файла
     std::vector<std::string> headers;
-    std::vector<std::vector<std::string>> rawData;
+    // данные хранятся по колонкам, columns[i] соответствует headers[i]
+    std::vector<Column> columns;
+    // для датасетов в ленивом режиме данные остаются в файле, а columns пуст
+    std::shared_ptr<const LazyCsvTable> lazyTable;
+    // для результата трансформаций - план поверх исходного датасета, columns пуст
+    std::shared_ptr<const TransformPlan> plan;
+    // не пусто, если колонки вытеснены на диск и читаются из отображённого снапшота
+    std::string spillPath;
+    // логическое время последнего обращения, по нему выбираются датасеты для вытеснения
+    mutable std::atomic<u64> lastAccess{0};
     size_t rowCount = 0;
     size_t columnCount = 0;
     std::chrono::system_clock::time_point createdAt;
+
+    /**
+     * @brief Суммарный объём памяти, занимаемый колонками датасета (или номерами строк его плана), в байтах.
+     */
+    [[nodiscard]] size_t memoryBytes() const {
+        size_t bytes = 0;
+        for (const auto& column : columns) {
+            bytes += column.memoryBytes();
+        }
+        if (lazyTable) {
+            bytes += lazyTable->memoryBytes();
+        }
+        if (plan) {
+            bytes += plan->memoryBytes();
+        }
+        return bytes;
+    }
+
+    [[nodiscard]] bool isLazy() const { return lazyTable != nullptr; }
+    [[nodiscard]] bool isPlanned() const { return plan != nullptr; }
+    [[nodiscard]] bool isSpilled() const { return !spillPath.empty(); }
 };
 
 struct PaginatedData {
@@ -32,25 +71,193 @@ struct PaginatedData {
     std::vector<std::vector<std::string>> data;
 };
 
+/**
+ * @brief Какую часть датасета отдать: диапазон строк и колонки.
+ */
+struct DatasetPageRequest {
+    u32 page = 1;       // номер страницы с 1, если не задан firstRow
+    u32 pageSize = 50;
+    std::optional<size_t> firstRow; // позиция курсора: страница начинается с этой строки
+    std::vector<std::string> columns; // имена или номера колонок в нужном порядке; пусто - все
+};
+
+/**
+ * @brief Страница датасета без скопированных строк: границы страницы и план,
+ * по которому строки вычисляются порциями прямо при отправке.
+ */
+struct DatasetPageView {
+    std::shared_ptr<const Dataset> dataset; // держит данные, пока страница не отправлена целиком
+    std::shared_ptr<const TransformPlan> plan; // уже с проекцией: выдаёт только запрошенные колонки
+    u32 page;
+    u32 pageSize;
+    u32 totalPages;
+    size_t firstRow;
+    size_t rowCount; // 0, если страница за пределами данных
+};
+
+/**
+ * @brief Учёт памяти одного датасета.
+ */
+struct DatasetMemoryInfo {
+    std::string id;
+    std::string name;
+    size_t memoryBytes; // куча, занятая колонками датасета (разделяемые буферы учитываются у каждого)
+    bool spilled;       // колонки вытеснены на диск и читаются из отображённого файла
+};
+
+/**
+ * @brief Состояние бюджета памяти реестра датасетов.
+ */
+struct MemoryUsage {
+    size_t budgetBytes;
+    size_t residentBytes; // куча, занятая всеми датасетами, разделяемые буферы учтены один раз
+    std::vector<DatasetMemoryInfo> datasets;
+};
+
+/**
+ * @brief Сводка по реестру датасетов для мониторинга.
+ */
+struct DatasetRegistryStats {
+    size_t datasets = 0;
+    size_t lazyDatasets = 0;
+    size_t plannedDatasets = 0; // результаты трансформаций поверх исходного датасета
+    size_t spilledDatasets = 0;
+    u64 rows = 0;
+    size_t residentBytes = 0;
+    size_t budgetBytes = 0;
+    size_t activeLoadJobs = 0;  // в очереди или выполняются
+};
+
+/**
+ * @brief Как загружать датасет.
+ */
+enum class DatasetLoadMode {
+    IN_MEMORY, // файл разбирается целиком в типизированные колонки
+    LAZY       // в памяти только индекс строк, страницы читаются из файла по запросу
+};
+
+enum class LoadJobState {
+    QUEUED,
+    RUNNING,
+    COMPLETED,
+    FAILED
+};
+
+/**
+ * @brief Снимок состояния фоновой загрузки датасета.
+ */
+struct LoadJobStatus {
+    std::string id;
+    std::string filePath;
+    DatasetLoadMode mode;
+    LoadJobState state;
+    u64 totalBytes;
+    u64 bytesProcessed;
+    u64 rowsProcessed;
+    std::string datasetId; // заполнен, когда state == COMPLETED
+    std::string error;     // заполнен, когда state == FAILED
+};
+
+/**
+ * @brief Счётчики прогресса разбора, обновляются потоками разбора по мере продвижения.
+ */
+struct LoadProgress {
+    std::atomic<u64> bytesProcessed{0};
+    std::atomic<u64> rowsProcessed{0};
+    // зовётся из потока разбора, продвинувшего счётчики, не чаще progressPublishInterval
+    std::function<void()> onAdvance;
+    std::atomic<i64> lastAdvanceNs{0};
+
+    /**
+     * @brief Вызывается после обновления счётчиков; из потоков, продвинувшихся одновременно, onAdvance получит один.
+     */
+    void advanced() {
+        if (!onAdvance) {
+            return;
+        }
+        const i64 now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        i64 last = lastAdvanceNs.load(std::memory_order_relaxed);
+        if (now - last < std::chrono::duration_cast<std::chrono::nanoseconds>(FRAMEWORK_CONSTANTS::progressPublishInterval).count()
+            || !lastAdvanceNs.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+            return;
+        }
+        onAdvance();
+    }
+};
+
 
 class DatasetService {
 public:
-    DatasetService() = default;
+    /**
+     * @param loadThreads Сколько потоков использовать для разбора одного CSV-файла.
+     */
+    explicit DatasetService(u32 loadThreads = Concurrency::defaultThreadCount());
+
+    /**
+     * @brief Меняет количество потоков для разбора CSV. Действует на последующие загрузки.
+     */
+    void setLoadThreads(u32 threads) { _loadThreads = std::max<u32>(threads, 1); }
+
+    /**
+     * @brief Куда публиковать прогресс фоновых загрузок (topic - ID задачи). Задаётся при запуске, до первой загрузки.
+     */
+    void setProgressHub(std::shared_ptr<ProgressHub> hub) { _progressHub = std::move(hub); }
+
+    /**
+     * @brief Меняет бюджет памяти для колонок загруженных датасетов и сразу применяет его.
+     *
+     * Когда колонки занимают больше бюджета, давно не использованные датасеты вытесняются
+     * в бинарный снапшот в FRAMEWORK_CONSTANTS::spillDirectory и дальше читаются из
+     * отображённого файла - для клиентов они остаются загруженными.
+     */
+    void setMemoryBudget(size_t bytes);
+
+    /**
+     * @brief Текущий бюджет памяти, занятая память и учёт по каждому датасету.
+     */
+    MemoryUsage memoryUsage() const;
+
+    /**
+     * @brief Число датасетов, строк и занятая память - для /metrics.
+     */
+    DatasetRegistryStats registryStats() const;
 
     /**
-     * @brief Сканирует директорию и возвращает список имен .csv файлов.
+     * @brief Сканирует директорию и возвращает список имен .csv файлов и бинарных снапшотов (.nds).
      * @param directoryPath Путь к директории для сканирования, относительно исполняемого файла.
      * @return Вектор с именами файлов, включающими в себя полный путь. Например, сканируя папку csv/datasets мы нашли файл iris.csv, тогда среди имён будет csv/datasets/iris.csv
      */
     std::vector<std::string> listAvailableDatasets(const std::string& directoryPath) const;
 
     /**
-     * @brief Загружает CSV-файл в память, присваивает ему уникальный ID.
-     * @param filePath - полный путь к CSV-файлу, относительно исполняемого файла
+     * @brief Загружает CSV-файл или снапшот в память, присваивает ему уникальный ID.
+     *
+     * Снапшот (.nds) не разбирается, а отображается в память; mode для него не важен.
+     * @param filePath - полный путь к файлу, относительно исполняемого файла
+     * @param mode - IN_MEMORY разбирает CSV целиком, LAZY строит только индекс строк
      * @return Уникальный ID загруженного датасета.
      * @throws std::runtime_error если файл не найден или не удалось прочитать.
      */
-    std::string loadDataset(const std::string& filePath);
+    std::string loadDataset(const std::string& filePath, DatasetLoadMode mode = DatasetLoadMode::IN_MEMORY);
+
+    /**
+     * @brief Ставит загрузку CSV-файла в фоновую очередь и сразу возвращает ID задачи.
+     *
+     * Разбор идёт без блокировки реестра датасетов; датасет появляется в списке
+     * загруженных только после того, как разобран целиком.
+     * @param filePath - полный путь к CSV-файлу, относительно исполняемого файла
+     * @param mode - режим загрузки, см. loadDataset
+     * @return ID задачи загрузки, по которому можно узнать прогресс через getLoadJob.
+     * @throws std::runtime_error если файл не найден.
+     */
+    std::string startLoadJob(const std::string& filePath, DatasetLoadMode mode = DatasetLoadMode::IN_MEMORY);
+
+    /**
+     * @brief Возвращает состояние задачи загрузки.
+     * @param jobId ID задачи из startLoadJob.
+     * @return Снимок состояния или std::nullopt, если задача не найдена.
+     */
+    std::optional<LoadJobStatus> getLoadJob(const std::string& jobId) const;
 
     /**
      * @brief Отдаёт список пар id-имя для всех загруженных датасетов
@@ -68,11 +275,21 @@ public:
     /**
      * @brief Возвращает страницу данных из ранее загруженного датасета.
      * @param datasetId Уникальный ID датасета.
-     * @param page Номер страницы (начиная с 1).
-     * @param pageSize Количество записей на странице.
+     * @param request Диапазон строк и колонки страницы.
      * @return Структура PaginatedData или std::nullopt, если датасет не найден.
+     * @throws std::runtime_error если запрошена несуществующая колонка или pageSize больше maxPageSize.
+     */
+    std::optional<PaginatedData> getDatasetPage(const std::string& datasetId, const DatasetPageRequest& request) const;
+
+    /**
+     * @brief Находит страницу, но не вычисляет её строки: их читают через plan->readRows порциями.
+     * План страницы содержит только запрошенные колонки, так что остальные не читаются вовсе.
+     * @param datasetId Уникальный ID датасета.
+     * @param request Диапазон строк и колонки страницы.
+     * @return Описание страницы или std::nullopt, если датасет не найден или параметры невалидны.
+     * @throws std::runtime_error если запрошена несуществующая колонка или pageSize больше maxPageSize.
      */
-    std::optional<PaginatedData> getDatasetPage(const std::string& datasetId, u32 page, u32 pageSize) const;
+    std::optional<DatasetPageView> openDatasetPage(const std::string& datasetId, const DatasetPageRequest& request) const;
 
     /**
      * @brief Возвращает указатель на объект датасета по его ID.
@@ -107,16 +324,78 @@ public:
      */
     std::string saveDatasetToFile(const std::string& datasetId, const std::string& newName);
 
+    /**
+     * @brief Сохраняет датасет в бинарный колоночный снапшот (.nds), который потом открывается без разбора.
+     * @param datasetId ID датасета, который нужно сохранить.
+     * @param newName Имя для нового файла (без расширения).
+     * @return Полный путь к созданному файлу.
+     * @throws std::runtime_error если датасет не найден, ленивый или не удалось записать файл.
+     */
+    std::string saveDatasetSnapshot(const std::string& datasetId, const std::string& newName);
+
 private:
-    static std::pair<std::vector<std::string>, std::vector<std::vector<std::string>>> parseCsv(const std::string& filePath);
+    struct ParsedCsv {
+        std::vector<std::string> headers;
+        std::vector<Column> columns;
+        size_t rowCount = 0;
+    };
+
+    struct LoadJob {
+        std::string id;
+        std::string filePath;
+        DatasetLoadMode mode = DatasetLoadMode::IN_MEMORY;
+        u64 totalBytes = 0;
+        LoadProgress progress;
+        std::atomic<LoadJobState> state{LoadJobState::QUEUED};
+        std::chrono::steady_clock::time_point startedAt;
+        // поля ниже защищены _jobsMutex
+        std::string datasetId;
+        std::string error;
+        std::chrono::steady_clock::time_point finishedAt;
+    };
+
+    static ParsedCsv parseCsv(const std::string& filePath, u32 threads, LoadProgress* progress);
+
+    static std::shared_ptr<Dataset> parseDataset(const std::string& filePath, u32 threads, LoadProgress* progress);
+    static std::shared_ptr<Dataset> openLazyDataset(const std::string& filePath, LoadProgress* progress);
+    static std::shared_ptr<Dataset> openSnapshotDataset(const std::string& filePath, LoadProgress* progress);
+
+    std::string loadDatasetWithProgress(const std::string& filePath, DatasetLoadMode mode, LoadProgress* progress);
+    void runLoadJob(const std::shared_ptr<LoadJob>& job);
+    void publishLoadProgress(const LoadJob& job, ProgressState state, const std::string& datasetId = {}, const std::string& error = {}) const;
+    void pruneFinishedJobs_locked();
 
     std::string registerTransformedDataset_locked(std::shared_ptr<Dataset> dataset, const std::string& datasetName);
 
+    // отмечает обращение к датасету для LRU
+    void touch(const Dataset& dataset) const { dataset.lastAccess = ++_accessClock; }
+
+    size_t residentBytes_locked() const;
+    std::shared_ptr<Dataset> pickSpillCandidate_locked() const;
+    // вытесняет давно не использованные датасеты, пока память не уложится в бюджет
+    void enforceMemoryBudget();
+    bool spillDataset(const std::shared_ptr<Dataset>& dataset);
+
     std::unordered_map<std::string, std::shared_ptr<Dataset>> _datasets{};
 
+    std::atomic<u32> _loadThreads;
+    std::atomic<size_t> _memoryBudget;
+    mutable std::atomic<u64> _accessClock{0};
+    // вытеснением занимается один поток за раз, снапшот пишется без блокировки реестра
+    std::mutex _spillMutex;
+
+    std::shared_ptr<ProgressHub> _progressHub;
+
+    // задачи загрузки живут отдельно от реестра, чтобы опрос прогресса не ждал _mutex
+    std::unordered_map<std::string, std::shared_ptr<LoadJob>> _jobs{};
+    mutable std::mutex _jobsMutex;
+
     // мьютекс для потокобезопасного доступа к _datasets
     // mutable позволяет использовать мьютекс в const-методах для безопасного чтения
     mutable std::shared_mutex _mutex;
+
+    // объявлен последним: при разрушении сервиса сначала дожидаемся фоновых загрузок
+    Concurrency::ThreadPool _loadPool{2};
 };
 
 
@@ -0,0 +1,177 @@
+#include "PageFrame.hpp"
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+    static_assert(std::endian::native == std::endian::little, "Page frames are sent in little-endian order");
+
+    constexpr std::array<char, 4> frameMagic{'N', 'D', 'P', 'F'};
+    constexpr u32 frameVersion = 1;
+    constexpr size_t bufferAlignment = 8;
+
+    struct FrameHeader {
+        std::array<char, 4> magic;
+        u32 version;
+        u32 columnCount;
+        u32 rowCount;
+        u64 totalRows;
+        u32 page;
+        u32 pageSize;
+        u32 totalPages;
+        u32 reserved;
+    };
+    static_assert(sizeof(FrameHeader) == 40, "Page frame header layout must not change");
+
+    template<typename T>
+    void appendPod(std::string& out, const T& value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void align(std::string& out) {
+        out.append((bufferAlignment - out.size() % bufferAlignment) % bufferAlignment, '\0');
+    }
+
+    u32 checkedOffset(size_t offset) {
+        if (offset > std::numeric_limits<u32>::max()) {
+            throw std::runtime_error("Page is too large for a binary frame; request a smaller pageSize.");
+        }
+        return static_cast<u32>(offset);
+    }
+
+    // биты [first, first + count) маски колонки, сдвинутые к началу; хвост последнего байта обнулён
+    void appendValidity(std::string& out, const ColumnBuffer<u64>& words, size_t first, size_t count) {
+        align(out);
+        const size_t bytes = (count + 7) / 8;
+        const size_t shift = first & 63;
+        for (size_t written = 0; written < bytes; written += sizeof(u64)) {
+            const size_t word = (first >> 6) + written / sizeof(u64);
+            u64 bits = words[word] >> shift;
+            if (shift != 0 && word + 1 < words.size()) {
+                bits |= words[word + 1] << (64 - shift);
+            }
+            out.append(reinterpret_cast<const char*>(&bits), std::min(sizeof(u64), bytes - written));
+        }
+        if (count % 8 != 0) {
+            out.back() = static_cast<char>(out.back() & ((1u << (count % 8)) - 1));
+        }
+    }
+
+    template<typename T>
+    void appendValues(std::string& out, const ColumnBuffer<T>& values, size_t first, size_t count) {
+        align(out);
+        out.append(reinterpret_cast<const char*>(values.data() + first), count * sizeof(T));
+    }
+
+    // границы пишутся на заранее отведённое место, байты значений - сразу следом
+    template<typename ValueAt>
+    void appendStrings(std::string& out, size_t count, ValueAt&& valueAt) {
+        align(out);
+        const size_t offsetsAt = out.size();
+        out.resize(offsetsAt + (count + 1) * sizeof(u32));
+        const size_t bytesAt = out.size();
+
+        u32 offset = 0;
+        std::memcpy(out.data() + offsetsAt, &offset, sizeof(offset));
+        for (size_t i = 0; i < count; ++i) {
+            out.append(valueAt(i));
+            offset = checkedOffset(out.size() - bytesAt);
+            std::memcpy(out.data() + offsetsAt + (i + 1) * sizeof(u32), &offset, sizeof(offset));
+        }
+    }
+
+    void appendColumn(std::string& out, const Column& column, size_t first, size_t count) {
+        appendValidity(out, column.validity(), first, count);
+        switch (column.type()) {
+            case ColumnType::I64: appendValues(out, column.values<i64>(), first, count); break;
+            case ColumnType::F32: appendValues(out, column.values<f32>(), first, count); break;
+            case ColumnType::F64: appendValues(out, column.values<f64>(), first, count); break;
+            case ColumnType::STRING:
+                appendStrings(out, count, [&](size_t i) { return column.stringAt(first + i); });
+                break;
+        }
+    }
+
+    // ленивый источник: строки страницы разбираются из файла, каждая колонка копится отдельно
+    void appendTextColumns(std::string& out, const DatasetPageView& page) {
+        const size_t columnCount = page.plan->columns().size();
+        std::vector<std::string> bytes(columnCount);
+        std::vector<std::vector<u32>> ends(columnCount);
+        std::vector<std::vector<u64>> validity(columnCount, std::vector<u64>((page.rowCount + 63) / 64, 0));
+
+        size_t row = 0;
+        page.plan->readRows(page.firstRow, page.rowCount, [&](std::span<const std::string_view> cells) {
+            for (size_t c = 0; c < columnCount; ++c) {
+                bytes[c].append(cells[c]);
+                ends[c].push_back(checkedOffset(bytes[c].size()));
+                if (!cells[c].empty()) {
+                    validity[c][row >> 6] |= u64{1} << (row & 63);
+                }
+            }
+            ++row;
+        });
+
+        for (size_t c = 0; c < columnCount; ++c) {
+            appendValidity(out, ColumnBuffer<u64>(std::move(validity[c])), 0, page.rowCount);
+            appendStrings(out, page.rowCount, [&](size_t i) {
+                const u32 begin = i == 0 ? 0 : ends[c][i - 1];
+                return std::string_view(bytes[c]).substr(begin, ends[c][i] - begin);
+            });
+        }
+    }
+}
+
+void appendPageFrame(std::string& out, const DatasetPageView& page) {
+    const Dataset& source = page.plan->source();
+    const auto& projection = page.plan->columns();
+    const auto headers = page.plan->headers();
+
+    const size_t frameStart = out.size();
+    if (frameStart % bufferAlignment != 0) {
+        throw std::logic_error("Page frame must start at an aligned offset.");
+    }
+
+    FrameHeader header{};
+    header.magic = frameMagic;
+    header.version = frameVersion;
+    header.columnCount = static_cast<u32>(projection.size());
+    header.rowCount = checkedOffset(page.rowCount);
+    header.totalRows = page.dataset->rowCount;
+    header.page = page.page;
+    header.pageSize = page.pageSize;
+    header.totalPages = page.totalPages;
+    appendPod(out, header);
+    for (const std::string& text : {std::cref(page.dataset->id), std::cref(page.dataset->name)}) {
+        appendPod(out, static_cast<u32>(text.size()));
+        out.append(text);
+    }
+
+    for (size_t i = 0; i < projection.size(); ++i) {
+        const auto type = source.isLazy() ? ColumnType::STRING : source.columns[projection[i]].type();
+        appendPod(out, static_cast<u8>(type));
+        out.append(3, '\0');
+        appendPod(out, static_cast<u32>(headers[i].size()));
+        out.append(headers[i]);
+    }
+
+    if (source.isLazy()) {
+        appendTextColumns(out, page);
+        return;
+    }
+
+    if (page.plan->selectsRows()) {
+        // строки выбраны фильтром или сортировкой: значения страницы сначала собираются подряд
+        for (const Column& column : page.plan->materializeColumns(page.firstRow, page.rowCount)) {
+            appendColumn(out, column, 0, page.rowCount);
+        }
+        return;
+    }
+
+    for (const u32 column : projection) {
+        appendColumn(out, source.columns[column], page.firstRow, page.rowCount);
+    }
+}
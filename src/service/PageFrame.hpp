@@ -0,0 +1,29 @@
+#ifndef PAGEFRAME_HPP
+#define PAGEFRAME_HPP
+
+#include <string>
+
+#include "DatasetService.hpp"
+
+/**
+ * @brief Дописывает страницу в out бинарным колоночным кадром.
+ *
+ * Формат (little-endian, версия 1), каждый буфер выровнен на 8 байт от начала кадра,
+ * чтобы клиент мог наложить на него типизированный массив без копирования:
+ *  - заголовок 40 байт: магия "NDPF", версия, число колонок, число строк в кадре,
+ *    всего строк в датасете (u64), номер страницы, размер страницы, число страниц, резерв;
+ *  - id и имя датасета: длина (u32) и байты UTF-8 каждого;
+ *  - схема: для каждой колонки тип (u8, значения ColumnType), 3 байта резерва,
+ *    длина имени (u32) и имя в UTF-8;
+ *  - данные по колонкам: маска валидности ((rows + 7) / 8 байт, бит i - строка i, младший бит первый),
+ *    затем значения: i64/f32/f64[rows] для числовых колонок, для строковых - u32 границы[rows + 1]
+ *    и байты значений. Значение пустой ячейки не определено.
+ *
+ * Кадр содержит только колонки плана страницы, то есть уже с проекцией.
+ * Числовые значения копируются в out прямо из буферов колонок одним куском на колонку.
+ * Если источник ленивый и колонок в памяти нет, все колонки отдаются строковыми.
+ * @throws std::runtime_error если строки страницы не помещаются в 32-битные границы.
+ */
+void appendPageFrame(std::string& out, const DatasetPageView& page);
+
+#endif
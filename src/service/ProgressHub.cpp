@@ -0,0 +1,129 @@
+#include "ProgressHub.hpp"
+
+#include <algorithm>
+
+namespace {
+    bool isFinished(ProgressState state) {
+        return state == ProgressState::COMPLETED || state == ProgressState::FAILED;
+    }
+}
+
+std::vector<ProgressEvent> ProgressSubscription::takePending() {
+    std::vector<ProgressEvent> events;
+    {
+        std::lock_guard lock(_mutex);
+        events.swap(_pending);
+    }
+    std::ranges::sort(events, {}, &ProgressEvent::sequence);
+    return events;
+}
+
+bool ProgressSubscription::offer(const ProgressEvent& event) {
+    bool wasEmpty;
+    {
+        std::lock_guard lock(_mutex);
+        if (!_allTopics && !_topics.contains(event.topic)) {
+            return false;
+        }
+        // у задачи уже лежит не забранное событие - заменяем его на месте
+        const auto it = std::ranges::find(_pending, event.topic, &ProgressEvent::topic);
+        if (it != _pending.end()) {
+            *it = event;
+            return true;
+        }
+        wasEmpty = _pending.empty();
+        _pending.push_back(event);
+    }
+    if (wasEmpty) {
+        _notify();
+    }
+    return false;
+}
+
+std::shared_ptr<ProgressSubscription> ProgressHub::subscribe(std::function<void()> notify) {
+    auto subscription = std::make_shared<ProgressSubscription>(std::move(notify));
+    std::lock_guard lock(_mutex);
+    std::erase_if(_subscriptions, [](const auto& weak) { return weak.expired(); });
+    _subscriptions.push_back(subscription);
+    return subscription;
+}
+
+bool ProgressHub::follow(ProgressSubscription& subscription, const std::string& topic) {
+    {
+        std::lock_guard lock(subscription._mutex);
+        if (topic == "*") {
+            subscription._allTopics = true;
+        } else if (subscription._topics.contains(topic) || subscription._topics.size() < maxTopicsPerSubscription) {
+            subscription._topics.insert(topic);
+        } else {
+            return false;
+        }
+    }
+
+    // текущее состояние - сразу; под блокировкой хаба, чтобы не обогнать следующую публикацию
+    std::lock_guard lock(_mutex);
+    if (topic == "*") {
+        for (const auto& [id, event] : _latest) {
+            subscription.offer(event);
+        }
+    } else if (const auto it = _latest.find(topic); it != _latest.end()) {
+        subscription.offer(it->second);
+    }
+    return true;
+}
+
+void ProgressHub::unfollow(ProgressSubscription& subscription, const std::string& topic) {
+    std::lock_guard lock(subscription._mutex);
+    if (topic == "*") {
+        subscription._allTopics = false;
+    } else {
+        subscription._topics.erase(topic);
+    }
+}
+
+void ProgressHub::publish(ProgressEvent event) {
+    // раздача идёт под блокировкой хаба, поэтому события одной задачи приходят подписчикам по порядку;
+    // это дёшево: подписка только кладёт событие к себе, а notify лишь планирует отправку
+    std::lock_guard lock(_mutex);
+    event.sequence = ++_sequence;
+
+    u64 coalesced = 0;
+    std::erase_if(_subscriptions, [&](const auto& weak) {
+        const auto subscription = weak.lock();
+        if (!subscription) {
+            return true;
+        }
+        coalesced += subscription->offer(event);
+        return false;
+    });
+    _published.fetch_add(1, std::memory_order_relaxed);
+    _coalesced.fetch_add(coalesced, std::memory_order_relaxed);
+
+    const bool finished = isFinished(event.state);
+    _latest[event.topic] = std::move(event);
+    if (finished) {
+        pruneLatest_locked();
+    }
+}
+
+size_t ProgressHub::subscriberCount() const {
+    std::lock_guard lock(_mutex);
+    return std::ranges::count_if(_subscriptions, [](const auto& weak) { return !weak.expired(); });
+}
+
+void ProgressHub::pruneLatest_locked() {
+    // незавершённые задачи помним всегда, из завершённых - самые свежие
+    std::vector<std::pair<u64, std::string>> finished;
+    for (const auto& [topic, event] : _latest) {
+        if (isFinished(event.state)) {
+            finished.emplace_back(event.sequence, topic);
+        }
+    }
+    if (finished.size() <= retainedFinishedTopics) {
+        return;
+    }
+    std::ranges::nth_element(finished, finished.end() - retainedFinishedTopics);
+    for (auto it = finished.begin(); it != finished.end() - retainedFinishedTopics; ++it) {
+        _latest.erase(it->second);
+    }
+}
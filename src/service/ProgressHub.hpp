@@ -0,0 +1,118 @@
+#ifndef PROGRESSHUB_HPP
+#define PROGRESSHUB_HPP
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../util/types/types.hpp"
+
+enum class ProgressKind {
+    LOAD // фоновая загрузка датасета
+};
+
+enum class ProgressState {
+    QUEUED,
+    RUNNING,
+    COMPLETED,
+    FAILED
+};
+
+/**
+ * @brief Состояние долгой задачи на момент публикации. Поля, не относящиеся к виду задачи, нулевые.
+ */
+struct ProgressEvent {
+    std::string topic; // ID задачи
+    ProgressKind kind = ProgressKind::LOAD;
+    ProgressState state = ProgressState::RUNNING;
+    u64 rows = 0;
+    u64 bytes = 0;
+    u64 totalBytes = 0;
+    f64 throughput = 0; // строк в секунду
+    std::string datasetId; // заполнен для завершённой загрузки
+    std::string error;     // заполнен, когда state == FAILED
+    u64 sequence = 0;      // порядковый номер в хабе, назначается при публикации
+};
+
+/**
+ * @brief Подписка одного клиента.
+ *
+ * Пока клиент не забрал события, по каждой задаче хранится только последнее: медленный
+ * потребитель получает актуальное состояние, а не очередь устаревших промежуточных.
+ */
+class ProgressSubscription {
+    friend class ProgressHub;
+
+    mutable std::mutex _mutex;
+    std::unordered_set<std::string> _topics;
+    bool _allTopics = false;
+    std::vector<ProgressEvent> _pending; // не больше одного события на задачу
+    std::function<void()> _notify;
+
+public:
+    explicit ProgressSubscription(std::function<void()> notify) : _notify(std::move(notify)) {}
+
+    /**
+     * @brief Забирает накопленные события в порядке публикации.
+     */
+    std::vector<ProgressEvent> takePending();
+
+private:
+    /**
+     * @return true, если событие заменило ещё не забранное событие той же задачи.
+     */
+    bool offer(const ProgressEvent& event);
+};
+
+/**
+ * @brief Раздаёт события прогресса долгих задач подписчикам.
+ *
+ * Публикация не ждёт подписчиков: событие кладётся в их подписки, а подписка будит своего
+ * владельца функцией notify (та должна только запланировать отправку, не отправлять сама).
+ * Последнее событие каждой задачи хранится, чтобы подписавшийся позже сразу увидел состояние.
+ */
+class ProgressHub {
+    mutable std::mutex _mutex;
+    std::vector<std::weak_ptr<ProgressSubscription>> _subscriptions;
+    std::unordered_map<std::string, ProgressEvent> _latest;
+    u64 _sequence = 0;
+    std::atomic<u64> _published{0};
+    std::atomic<u64> _coalesced{0};
+
+    // сколько завершённых задач помнить для новых подписчиков
+    static constexpr size_t retainedFinishedTopics = 256;
+
+public:
+    // на сколько отдельных задач может подписаться один клиент: имена задач присылает он сам
+    static constexpr size_t maxTopicsPerSubscription = 256;
+
+    /**
+     * @brief Новая подписка без задач; notify вызывается из потока публикации, когда
+     * в пустой подписке появляется событие.
+     */
+    std::shared_ptr<ProgressSubscription> subscribe(std::function<void()> notify);
+
+    /**
+     * @brief Подписывает на задачу (topic "*" - на все) и сразу отдаёт её последнее состояние.
+     * @return false, если у подписки уже maxTopicsPerSubscription задач и новая не добавлена.
+     */
+    bool follow(ProgressSubscription& subscription, const std::string& topic);
+    void unfollow(ProgressSubscription& subscription, const std::string& topic);
+
+    void publish(ProgressEvent event);
+
+    [[nodiscard]] size_t subscriberCount() const;
+    [[nodiscard]] u64 publishedCount() const { return _published.load(std::memory_order_relaxed); }
+    // сколько событий было заменено более свежими до того, как подписчик их забрал
+    [[nodiscard]] u64 coalescedCount() const { return _coalesced.load(std::memory_order_relaxed); }
+
+private:
+    void pruneLatest_locked();
+};
+
+#endif //PROGRESSHUB_HPP
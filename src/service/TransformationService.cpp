@@ -13,32 +13,14 @@ std::shared_ptr<Dataset> TransformationService::removeColumn(std::shared_ptr<con
     }
     const size_t columnIndexToRemove = std::distance(source->headers.begin(), it);
 
-    // создаем новый объект датасета
+    // создаем новый объект датасета; данные не трогаем, а дописываем шаг к ленивому плану -
+    // если источник сам результат трансформаций, шаг сливается с его планом
     auto transformedDataset = std::make_shared<Dataset>();
-
-    // копируем заголовки, пропуская удаляемый
-    transformedDataset->headers.reserve(source->headers.size() - 1);
-    for (size_t i = 0; i < source->headers.size(); ++i) {
-        if (i != columnIndexToRemove) {
-            transformedDataset->headers.push_back(source->headers[i]);
-        }
-    }
-
-    // копируем данные, пропуская значения из удаляемой колонки
-    transformedDataset->rawData.reserve(source->rawData.size());
-    for (const auto& sourceRow : source->rawData) {
-        std::vector<std::string> newRow;
-        newRow.reserve(sourceRow.size() - 1);
-        for (size_t i = 0; i < sourceRow.size(); ++i) {
-            if (i != columnIndexToRemove) {
-                newRow.push_back(sourceRow[i]);
-            }
-        }
-        transformedDataset->rawData.push_back(newRow);
-    }
+    transformedDataset->plan = TransformPlan::of(source)->withoutColumn(columnIndexToRemove);
 
     // обновляем метаданные
-    transformedDataset->rowCount = transformedDataset->rawData.size();
+    transformedDataset->headers = transformedDataset->plan->headers();
+    transformedDataset->rowCount = transformedDataset->plan->rowCount();
     transformedDataset->columnCount = transformedDataset->headers.size();
 
     return transformedDataset;
@@ -13,6 +13,8 @@ class TransformationService {
 public:
     /**
        * @brief Создает новый датасет на основе исходного, но без указанной колонки.
+       *
+       * Данные не копируются: результат - ленивый план поверх исходного датасета (см. TransformPlan).
        * @param source Указатель на исходный, неизменяемый датасет.
        * @param columnName Имя колонки для удаления.
        * @return Указатель на новый, измененный датасет.
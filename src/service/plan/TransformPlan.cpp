@@ -0,0 +1,146 @@
+#include "TransformPlan.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#include "../DatasetService.hpp"
+
+TransformPlan::TransformPlan(std::shared_ptr<const Dataset> source, std::vector<u32> columns,
+                             std::shared_ptr<const std::vector<u64>> rows, size_t stepCount)
+    : _source(std::move(source)), _columns(std::move(columns)), _rows(std::move(rows)), _stepCount(stepCount) {
+}
+
+std::shared_ptr<const TransformPlan> TransformPlan::of(const std::shared_ptr<const Dataset>& dataset) {
+    if (dataset->plan) {
+        return dataset->plan;
+    }
+    std::vector<u32> identity(dataset->columnCount);
+    std::iota(identity.begin(), identity.end(), 0);
+    return std::shared_ptr<const TransformPlan>(new TransformPlan(dataset, std::move(identity), nullptr, 0));
+}
+
+std::shared_ptr<const TransformPlan> TransformPlan::withoutColumn(size_t outputColumn) const {
+    // проекция поверх проекции сливается в одну: просто выкидываем индекс из отображения
+    std::vector<u32> columns = _columns;
+    columns.erase(columns.begin() + static_cast<std::ptrdiff_t>(outputColumn));
+    return std::shared_ptr<const TransformPlan>(new TransformPlan(_source, std::move(columns), _rows, _stepCount + 1));
+}
+
+std::shared_ptr<const TransformPlan> TransformPlan::withRows(std::vector<u64> rows) const {
+    if (_rows) {
+        for (u64& row : rows) {
+            row = (*_rows)[row];
+        }
+    }
+    return std::shared_ptr<const TransformPlan>(new TransformPlan(
+        _source, _columns, std::make_shared<const std::vector<u64>>(std::move(rows)), _stepCount + 1));
+}
+
+std::shared_ptr<const TransformPlan> TransformPlan::projected(std::span<const u32> outputColumns) const {
+    std::vector<u32> columns;
+    columns.reserve(outputColumns.size());
+    for (const u32 column : outputColumns) {
+        columns.push_back(_columns.at(column));
+    }
+    return std::shared_ptr<const TransformPlan>(new TransformPlan(_source, std::move(columns), _rows, _stepCount));
+}
+
+std::shared_ptr<const TransformPlan> TransformPlan::rebased(std::shared_ptr<const Dataset> source) const {
+    return std::shared_ptr<const TransformPlan>(new TransformPlan(std::move(source), _columns, _rows, _stepCount));
+}
+
+std::vector<std::string> TransformPlan::headers() const {
+    std::vector<std::string> headers;
+    headers.reserve(_columns.size());
+    for (const u32 column : _columns) {
+        headers.push_back(_source->headers[column]);
+    }
+    return headers;
+}
+
+size_t TransformPlan::rowCount() const {
+    return _rows ? _rows->size() : _source->rowCount;
+}
+
+void TransformPlan::readRows(size_t firstRow, size_t count, const RowCallback& onRow) const {
+    std::vector<std::string_view> row(_columns.size());
+    const size_t endRow = std::min(firstRow + count, rowCount());
+    if (firstRow >= endRow) {
+        return;
+    }
+
+    if (_source->isLazy()) {
+        // файл разбирается один раз, из каждой записи берутся только нужные ячейки
+        auto project = [&](std::span<const std::string_view> cells) {
+            for (size_t i = 0; i < _columns.size(); ++i) {
+                row[i] = cells[_columns[i]];
+            }
+            onRow(row);
+        };
+        if (!_rows) {
+            _source->lazyTable->readRows(firstRow, endRow - firstRow, project);
+            return;
+        }
+        // выбранные строки читаются отрезками подряд идущих номеров
+        for (size_t i = firstRow; i < endRow;) {
+            size_t runEnd = i + 1;
+            while (runEnd < endRow && (*_rows)[runEnd] == (*_rows)[runEnd - 1] + 1) {
+                ++runEnd;
+            }
+            _source->lazyTable->readRows((*_rows)[i], runEnd - i, project);
+            i = runEnd;
+        }
+        return;
+    }
+
+    // текст ячеек строки собираем в один буфер, view создаём после, когда буфер уже не растёт
+    std::string arena;
+    std::vector<size_t> bounds(_columns.size() + 1);
+    for (size_t r = firstRow; r < endRow; ++r) {
+        const size_t sourceRow = _rows ? (*_rows)[r] : r;
+        arena.clear();
+        for (size_t i = 0; i < _columns.size(); ++i) {
+            bounds[i] = arena.size();
+            _source->columns[_columns[i]].appendText(arena, sourceRow);
+        }
+        bounds[_columns.size()] = arena.size();
+        for (size_t i = 0; i < _columns.size(); ++i) {
+            row[i] = std::string_view(arena).substr(bounds[i], bounds[i + 1] - bounds[i]);
+        }
+        onRow(row);
+    }
+}
+
+std::vector<Column> TransformPlan::materializeColumns() const {
+    return materializeColumns(0, rowCount());
+}
+
+std::vector<Column> TransformPlan::materializeColumns(size_t firstRow, size_t count) const {
+    if (_source->isLazy()) {
+        throw std::runtime_error("Dataset is backed by a file and has no columns in memory; load the file in memory mode first.");
+    }
+    const size_t endRow = std::min(firstRow + count, rowCount());
+    firstRow = std::min(firstRow, endRow);
+    std::vector<Column> columns;
+    columns.reserve(_columns.size());
+
+    // все строки по порядку - буферы источника без копирования
+    if (!_rows && firstRow == 0 && endRow == _source->rowCount) {
+        for (const u32 column : _columns) {
+            columns.push_back(_source->columns[column]);
+        }
+        return columns;
+    }
+
+    std::vector<u64> rows(endRow - firstRow);
+    if (_rows) {
+        std::copy(_rows->begin() + static_cast<std::ptrdiff_t>(firstRow), _rows->begin() + static_cast<std::ptrdiff_t>(endRow), rows.begin());
+    } else {
+        std::iota(rows.begin(), rows.end(), u64{firstRow});
+    }
+    for (const u32 column : _columns) {
+        columns.push_back(_source->columns[column].gather(rows));
+    }
+    return columns;
+}
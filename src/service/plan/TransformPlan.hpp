@@ -0,0 +1,119 @@
+#ifndef TRANSFORMPLAN_HPP
+#define TRANSFORMPLAN_HPP
+
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../storage/Column.hpp"
+#include "../../util/types/types.hpp"
+
+struct Dataset;
+
+/**
+ * @brief Ленивый план трансформаций поверх исходного датасета.
+ *
+ * Трансформация не строит промежуточный датасет, а дописывает шаг к плану. Соседние
+ * построчные шаги сливаются сразу при добавлении: цепочка удалений колонок превращается
+ * в одну проекцию исходных колонок, поэтому план всегда ссылается прямо на датасет с данными
+ * и выполняется за один проход. Вычисляются только запрошенные строки - страница, сохранение.
+ *
+ * Фильтр и сортировка тоже не копируют данные: план запоминает номера исходных строк
+ * в нужном порядке, и выходная строка i - это строка rows[i] источника.
+ *
+ * План неизменяем: добавление шага возвращает новый план, старый остаётся у родительского датасета.
+ */
+class TransformPlan {
+public:
+    using RowCallback = std::function<void(std::span<const std::string_view>)>;
+
+    /**
+     * @brief План, продолжающий данный датасет: если датасет сам задан планом, берётся его план,
+     * иначе начинается новый с тождественной проекцией.
+     */
+    static std::shared_ptr<const TransformPlan> of(const std::shared_ptr<const Dataset>& dataset);
+
+    /**
+     * @brief Новый план без выходной колонки outputColumn.
+     */
+    [[nodiscard]] std::shared_ptr<const TransformPlan> withoutColumn(size_t outputColumn) const;
+
+    /**
+     * @brief Новый план, оставляющий выходные строки rows в заданном порядке (номера - строки этого плана).
+     * Выборка поверх выборки сливается в одну: номера сразу переводятся в строки источника.
+     */
+    [[nodiscard]] std::shared_ptr<const TransformPlan> withRows(std::vector<u64> rows) const;
+
+    /**
+     * @brief План, оставляющий только выходные колонки outputColumns в заданном порядке.
+     * Это не трансформация, а выборка для чтения: число шагов не меняется.
+     */
+    [[nodiscard]] std::shared_ptr<const TransformPlan> projected(std::span<const u32> outputColumns) const;
+
+    /**
+     * @brief Тот же план поверх другого датасета с теми же колонками, например после вытеснения источника на диск.
+     */
+    [[nodiscard]] std::shared_ptr<const TransformPlan> rebased(std::shared_ptr<const Dataset> source) const;
+
+    /**
+     * @brief Датасет с данными, над которым выполняется план.
+     */
+    [[nodiscard]] const Dataset& source() const { return *_source; }
+
+    /**
+     * @brief Слитая проекция: выходная колонка i - это колонка columns()[i] исходного датасета.
+     */
+    [[nodiscard]] const std::vector<u32>& columns() const { return _columns; }
+
+    [[nodiscard]] std::vector<std::string> headers() const;
+    [[nodiscard]] size_t rowCount() const;
+
+    /**
+     * @brief true, если план выбирает строки, а не отдаёт все строки источника по порядку.
+     */
+    [[nodiscard]] bool selectsRows() const { return _rows != nullptr; }
+
+    /**
+     * @brief Память кучи, которую держит сам план (номера выбранных строк), в байтах.
+     */
+    [[nodiscard]] size_t memoryBytes() const { return _rows ? _rows->size() * sizeof(u64) : 0; }
+
+    /**
+     * @brief Сколько трансформаций слито в план, для логов.
+     */
+    [[nodiscard]] size_t stepCount() const { return _stepCount; }
+
+    /**
+     * @brief Вычисляет строки [firstRow, firstRow + count) за один проход по источнику.
+     * View ячеек живут только до возврата из onRow.
+     */
+    void readRows(size_t firstRow, size_t count, const RowCallback& onRow) const;
+
+    /**
+     * @brief Колонки результата. Для датасета в памяти они разделяют буферы с источником,
+     * если план не выбирает строки; иначе выбранные строки собираются в новые буферы.
+     * @throws std::runtime_error если источник ленивый и колонок в памяти нет.
+     */
+    [[nodiscard]] std::vector<Column> materializeColumns() const;
+
+    /**
+     * @brief Колонки только строк [firstRow, firstRow + count) результата, например для страницы.
+     * @throws std::runtime_error если источник ленивый и колонок в памяти нет.
+     */
+    [[nodiscard]] std::vector<Column> materializeColumns(size_t firstRow, size_t count) const;
+
+private:
+    TransformPlan(std::shared_ptr<const Dataset> source, std::vector<u32> columns,
+                  std::shared_ptr<const std::vector<u64>> rows, size_t stepCount);
+
+    std::shared_ptr<const Dataset> _source;
+    std::vector<u32> _columns;
+    // номера строк источника; null - все строки по порядку. Разделяется планами-проекциями
+    std::shared_ptr<const std::vector<u64>> _rows;
+    size_t _stepCount;
+};
+
+#endif
@@ -0,0 +1,315 @@
+#include "QueryExpression.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+
+namespace {
+    enum class TokenType {
+        IDENTIFIER,        // имя колонки или ключевое слово
+        QUOTED_IDENTIFIER, // "имя колонки"
+        STRING,
+        NUMBER,
+        OPERATOR,
+        LEFT_PAREN,
+        RIGHT_PAREN,
+        COMMA,
+        END
+    };
+
+    struct Token {
+        TokenType type;
+        std::string text; // для строк и имён в кавычках - уже без кавычек
+        size_t position;
+    };
+
+    bool isIdentifierChar(char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.';
+    }
+
+    bool equalsKeyword(std::string_view text, std::string_view keyword) {
+        return std::ranges::equal(text, keyword, [](char a, char b) {
+            return std::toupper(static_cast<unsigned char>(a)) == b;
+        });
+    }
+
+    class Lexer {
+        std::string_view _text;
+        size_t _position = 0;
+
+    public:
+        explicit Lexer(std::string_view text) : _text(text) {}
+
+        std::vector<Token> tokenize() {
+            std::vector<Token> tokens;
+            for (;;) {
+                while (_position < _text.size() && std::isspace(static_cast<unsigned char>(_text[_position]))) {
+                    ++_position;
+                }
+                if (_position == _text.size()) {
+                    tokens.push_back({TokenType::END, "", _position});
+                    return tokens;
+                }
+                tokens.push_back(next());
+            }
+        }
+
+    private:
+        Token next() {
+            const size_t start = _position;
+            const char c = _text[_position];
+            if (c == '(' || c == ')' || c == ',') {
+                ++_position;
+                return {c == '(' ? TokenType::LEFT_PAREN : c == ')' ? TokenType::RIGHT_PAREN : TokenType::COMMA, std::string(1, c), start};
+            }
+            if (c == '\'' || c == '"') {
+                return {c == '\'' ? TokenType::STRING : TokenType::QUOTED_IDENTIFIER, quoted(c), start};
+            }
+            if (std::isdigit(static_cast<unsigned char>(c))
+                || ((c == '-' || c == '.') && _position + 1 < _text.size() && std::isdigit(static_cast<unsigned char>(_text[_position + 1])))) {
+                ++_position;
+                while (_position < _text.size() && (isIdentifierChar(_text[_position])
+                       || ((_text[_position] == '-' || _text[_position] == '+') && (_text[_position - 1] == 'e' || _text[_position - 1] == 'E')))) {
+                    ++_position;
+                }
+                return {TokenType::NUMBER, std::string(_text.substr(start, _position - start)), start};
+            }
+            if (isIdentifierChar(c)) {
+                while (_position < _text.size() && isIdentifierChar(_text[_position])) {
+                    ++_position;
+                }
+                return {TokenType::IDENTIFIER, std::string(_text.substr(start, _position - start)), start};
+            }
+            for (const std::string_view op : {"==", "!=", "<>", "<=", ">=", "=", "<", ">"}) {
+                if (_text.substr(_position).starts_with(op)) {
+                    _position += op.size();
+                    return {TokenType::OPERATOR, std::string(op), start};
+                }
+            }
+            throw std::runtime_error("Unexpected character '" + std::string(1, c) + "' at position " + std::to_string(start) + ".");
+        }
+
+        // закрывающая кавычка, повторённая дважды, - сама кавычка
+        std::string quoted(char quote) {
+            const size_t start = _position++;
+            std::string value;
+            while (_position < _text.size()) {
+                if (_text[_position] == quote) {
+                    if (_position + 1 < _text.size() && _text[_position + 1] == quote) {
+                        value += quote;
+                        _position += 2;
+                        continue;
+                    }
+                    ++_position;
+                    return value;
+                }
+                value += _text[_position++];
+            }
+            throw std::runtime_error("Unterminated quote at position " + std::to_string(start) + ".");
+        }
+    };
+
+    class Parser {
+        std::vector<Token> _tokens;
+        size_t _index = 0;
+        size_t _depth = 0;
+
+        // разбор, компиляция и вычисление условия рекурсивны по скобкам: глубину ограничивает
+        // парсер, иначе запрос из одних скобок переполнил бы стек потока
+        static constexpr size_t maxNesting = 64;
+
+    public:
+        explicit Parser(std::string_view text) : _tokens(Lexer(text).tokenize()) {}
+
+        QueryExpression parseCondition() {
+            auto expression = parseOr();
+            expectEnd();
+            return expression;
+        }
+
+        std::vector<QuerySortKey> parseOrder() {
+            std::vector<QuerySortKey> keys;
+            do {
+                QuerySortKey key{parseColumn()};
+                if (acceptKeyword("DESC")) {
+                    key.descending = true;
+                } else {
+                    acceptKeyword("ASC");
+                }
+                keys.push_back(std::move(key));
+            } while (accept(TokenType::COMMA));
+            expectEnd();
+            return keys;
+        }
+
+    private:
+        const Token& peek() const { return _tokens[_index]; }
+
+        bool accept(TokenType type) {
+            if (peek().type == type) {
+                ++_index;
+                return true;
+            }
+            return false;
+        }
+
+        bool acceptKeyword(std::string_view keyword) {
+            if (peek().type == TokenType::IDENTIFIER && equalsKeyword(peek().text, keyword)) {
+                ++_index;
+                return true;
+            }
+            return false;
+        }
+
+        [[noreturn]] void fail(std::string_view expected) const {
+            const Token& token = peek();
+            const std::string found = token.type == TokenType::END ? "end of query" : "'" + token.text + "'";
+            throw std::runtime_error("Expected " + std::string(expected) + " at position " + std::to_string(token.position)
+                                     + ", found " + found + ".");
+        }
+
+        void expect(TokenType type, std::string_view expected) {
+            if (!accept(type)) {
+                fail(expected);
+            }
+        }
+
+        void expectKeyword(std::string_view keyword) {
+            if (!acceptKeyword(keyword)) {
+                fail(keyword);
+            }
+        }
+
+        void expectEnd() {
+            if (peek().type != TokenType::END) {
+                fail("AND, OR or end of query");
+            }
+        }
+
+        // цепочка одного оператора сливается в один узел: a AND b AND c - три ребёнка
+        QueryExpression combine(QueryExpression::Kind kind, QueryExpression left, QueryExpression right) {
+            if (left.kind != kind) {
+                QueryExpression node;
+                node.kind = kind;
+                node.children.push_back(std::move(left));
+                left = std::move(node);
+            }
+            left.children.push_back(std::move(right));
+            return left;
+        }
+
+        QueryExpression parseOr() {
+            auto expression = parseAnd();
+            while (acceptKeyword("OR")) {
+                expression = combine(QueryExpression::Kind::OR, std::move(expression), parseAnd());
+            }
+            return expression;
+        }
+
+        QueryExpression parseAnd() {
+            auto expression = parsePrimary();
+            while (acceptKeyword("AND")) {
+                expression = combine(QueryExpression::Kind::AND, std::move(expression), parsePrimary());
+            }
+            return expression;
+        }
+
+        QueryExpression parsePrimary() {
+            if (peek().type == TokenType::LEFT_PAREN) {
+                if (_depth == maxNesting) {
+                    throw std::runtime_error("Expression nested too deeply at position " + std::to_string(peek().position) + ".");
+                }
+                ++_index;
+                ++_depth;
+                auto expression = parseOr();
+                expect(TokenType::RIGHT_PAREN, "')'");
+                --_depth;
+                return expression;
+            }
+            return parsePredicate();
+        }
+
+        std::string parseColumn() {
+            const Token& token = peek();
+            if (token.type != TokenType::IDENTIFIER && token.type != TokenType::QUOTED_IDENTIFIER) {
+                fail("column name");
+            }
+            ++_index;
+            return token.text;
+        }
+
+        QueryExpression parsePredicate() {
+            QueryExpression predicate;
+            predicate.column = parseColumn();
+
+            if (peek().type == TokenType::OPERATOR) {
+                const std::string op = _tokens[_index++].text;
+                predicate.op = op == "=" || op == "==" ? QueryOperator::EQ
+                             : op == "!=" || op == "<>" ? QueryOperator::NE
+                             : op == "<" ? QueryOperator::LT
+                             : op == "<=" ? QueryOperator::LE
+                             : op == ">" ? QueryOperator::GT
+                             : QueryOperator::GE;
+                predicate.values.push_back(parseLiteral());
+            } else if (acceptKeyword("IN")) {
+                predicate.op = QueryOperator::IN;
+                parseList(predicate.values);
+            } else if (acceptKeyword("NOT")) {
+                expectKeyword("IN");
+                predicate.op = QueryOperator::NOT_IN;
+                parseList(predicate.values);
+            } else if (acceptKeyword("STARTS")) {
+                expectKeyword("WITH");
+                predicate.op = QueryOperator::STARTS_WITH;
+                predicate.values.push_back(parseLiteral());
+            } else if (acceptKeyword("IS")) {
+                predicate.op = acceptKeyword("NOT") ? QueryOperator::IS_NOT_NULL : QueryOperator::IS_NULL;
+                expectKeyword("NULL");
+            } else {
+                fail("comparison, IN, STARTS WITH or IS NULL");
+            }
+            return predicate;
+        }
+
+        void parseList(std::vector<QueryLiteral>& values) {
+            expect(TokenType::LEFT_PAREN, "'('");
+            do {
+                values.push_back(parseLiteral());
+            } while (accept(TokenType::COMMA));
+            expect(TokenType::RIGHT_PAREN, "')'");
+        }
+
+        QueryLiteral parseLiteral() {
+            const Token& token = peek();
+            QueryLiteral literal{token.text};
+            if (token.type == TokenType::STRING) {
+                literal.isString = true;
+            } else if (token.type == TokenType::NUMBER) {
+                const char* first = token.text.data();
+                const char* last = first + token.text.size();
+                i64 integer = 0;
+                if (const auto [end, ec] = std::from_chars(first, last, integer); ec == std::errc() && end == last) {
+                    literal.integer = integer;
+                }
+                f64 number = 0;
+                if (const auto [end, ec] = std::from_chars(first, last, number); ec != std::errc() || end != last) {
+                    fail("number");
+                }
+                literal.number = number;
+            } else {
+                fail("number or quoted string");
+            }
+            ++_index;
+            return literal;
+        }
+    };
+}
+
+QueryExpression parseQueryExpression(std::string_view text) {
+    return Parser(text).parseCondition();
+}
+
+std::vector<QuerySortKey> parseQueryOrder(std::string_view text) {
+    return Parser(text).parseOrder();
+}
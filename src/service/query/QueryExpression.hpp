@@ -0,0 +1,78 @@
+#ifndef QUERYEXPRESSION_HPP
+#define QUERYEXPRESSION_HPP
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../../util/types/types.hpp"
+
+enum class QueryOperator {
+    EQ,
+    NE,
+    LT,
+    LE,
+    GT,
+    GE,
+    IN,
+    NOT_IN,
+    STARTS_WITH,
+    IS_NULL,
+    IS_NOT_NULL
+};
+
+/**
+ * @brief Константа из запроса. Число хранит и исходный текст - с ним сравниваются строковые колонки.
+ */
+struct QueryLiteral {
+    std::string text;
+    bool isString = false;
+    std::optional<i64> integer; // число без дробной части и экспоненты, помещающееся в i64
+    std::optional<f64> number;  // любое число
+};
+
+/**
+ * @brief Узел дерева условия: AND / OR над children или сравнение колонки с константами.
+ */
+struct QueryExpression {
+    enum class Kind {
+        AND,
+        OR,
+        PREDICATE
+    };
+
+    Kind kind = Kind::PREDICATE;
+    std::vector<QueryExpression> children;
+
+    std::string column;
+    QueryOperator op = QueryOperator::EQ;
+    std::vector<QueryLiteral> values; // одна константа, список для IN, пусто для IS NULL
+};
+
+struct QuerySortKey {
+    std::string column;
+    bool descending = false;
+};
+
+/**
+ * @brief Разбирает условие фильтра.
+ *
+ * Грамматика (ключевые слова без учёта регистра, AND связывает сильнее OR):
+ *  - условие: сравнение { AND | OR сравнение }, скобки группируют (не глубже 64 уровней);
+ *  - сравнение: колонка =|==|!=|<>|<|<=|>|>= константа, колонка [NOT] IN (константа, ...),
+ *    колонка STARTS WITH 'префикс', колонка IS [NOT] NULL;
+ *  - колонка: имя из букв, цифр, '_' и '.', или любое имя в двойных кавычках;
+ *  - константа: число или строка в одинарных кавычках ('' внутри - кавычка).
+ *
+ * @throws std::runtime_error с позицией ошибки в тексте.
+ */
+QueryExpression parseQueryExpression(std::string_view text);
+
+/**
+ * @brief Разбирает порядок сортировки: колонка [ASC|DESC] {, колонка [ASC|DESC]}.
+ * @throws std::runtime_error с позицией ошибки в тексте.
+ */
+std::vector<QuerySortKey> parseQueryOrder(std::string_view text);
+
+#endif
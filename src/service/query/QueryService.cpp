@@ -0,0 +1,406 @@
+#include "QueryService.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <numeric>
+#include <stdexcept>
+
+#include "../../util/logging.hpp"
+
+namespace {
+    // пакет строк - единица параллельной работы; кратен 64, чтобы маска пакета начиналась с целого слова
+    constexpr size_t batchRows = size_t{1} << 16;
+    constexpr size_t batchWords = batchRows / 64;
+    // меньшие куски сортировать в отдельных потоках дороже, чем сливать
+    constexpr size_t minSortPartRows = size_t{1} << 15;
+
+    /**
+     * @brief Условие, привязанное к колонкам: константы приведены к типу колонки,
+     * для строковой колонки сравнение уже вычислено по каждому коду словаря.
+     */
+    struct CompiledNode {
+        QueryExpression::Kind kind = QueryExpression::Kind::PREDICATE;
+        std::vector<CompiledNode> children;
+
+        const Column* column = nullptr;
+        QueryOperator op = QueryOperator::EQ;
+        std::vector<i64> integers; // колонка I64 и только целые константы
+        std::vector<f32> floats;   // колонка F32: сравнение в f32, как значения и были разобраны
+        std::vector<f64> numbers;  // остальные числовые сравнения
+        std::vector<u8> matches;   // колонка STRING: результат сравнения для каждого кода словаря
+    };
+
+    u64 lowBits(size_t count) {
+        return count >= 64 ? ~u64{0} : (u64{1} << count) - 1;
+    }
+
+    // бит i слова - match(values[i]); пустые ячейки отсекаются маской валидности
+    template<typename T, typename Match>
+    void matchWords(const T* values, const u64* validity, size_t count, u64* out, Match match) {
+        for (size_t w = 0; w * 64 < count; ++w) {
+            const size_t n = std::min<size_t>(64, count - w * 64);
+            const T* block = values + w * 64;
+            u64 bits = 0;
+            for (size_t i = 0; i < n; ++i) {
+                bits |= u64{match(block[i])} << i;
+            }
+            out[w] = bits & validity[w] & lowBits(n);
+        }
+    }
+
+    template<typename T, typename K>
+    void matchNumeric(const T* values, const u64* validity, size_t count, u64* out, QueryOperator op, const std::vector<K>& literals) {
+        const K k = literals.front();
+        auto in = [&literals](T v) {
+            bool any = false;
+            for (const K literal : literals) {
+                any |= static_cast<K>(v) == literal;
+            }
+            return any;
+        };
+        switch (op) {
+            case QueryOperator::EQ: matchWords(values, validity, count, out, [k](T v) { return static_cast<K>(v) == k; }); break;
+            case QueryOperator::NE: matchWords(values, validity, count, out, [k](T v) { return static_cast<K>(v) != k; }); break;
+            case QueryOperator::LT: matchWords(values, validity, count, out, [k](T v) { return static_cast<K>(v) < k; }); break;
+            case QueryOperator::LE: matchWords(values, validity, count, out, [k](T v) { return static_cast<K>(v) <= k; }); break;
+            case QueryOperator::GT: matchWords(values, validity, count, out, [k](T v) { return static_cast<K>(v) > k; }); break;
+            case QueryOperator::GE: matchWords(values, validity, count, out, [k](T v) { return static_cast<K>(v) >= k; }); break;
+            case QueryOperator::IN: matchWords(values, validity, count, out, in); break;
+            case QueryOperator::NOT_IN: matchWords(values, validity, count, out, [&in](T v) { return !in(v); }); break;
+            default: throw std::logic_error("Operator is not numeric.");
+        }
+    }
+
+    bool matchText(std::string_view value, QueryOperator op, const std::vector<std::string_view>& literals) {
+        switch (op) {
+            case QueryOperator::EQ: return value == literals.front();
+            case QueryOperator::NE: return value != literals.front();
+            case QueryOperator::LT: return value < literals.front();
+            case QueryOperator::LE: return value <= literals.front();
+            case QueryOperator::GT: return value > literals.front();
+            case QueryOperator::GE: return value >= literals.front();
+            case QueryOperator::STARTS_WITH: return value.starts_with(literals.front());
+            // список отсортирован в compile
+            case QueryOperator::IN: return std::ranges::binary_search(literals, value);
+            case QueryOperator::NOT_IN: return !std::ranges::binary_search(literals, value);
+            default: throw std::logic_error("Operator is not a comparison.");
+        }
+    }
+
+    f64 numericLiteral(const QueryLiteral& literal, const std::string& column) {
+        if (literal.number) {
+            return *literal.number;
+        }
+        // '42' для числовой колонки - тоже число
+        f64 number = 0;
+        const auto [end, ec] = std::from_chars(literal.text.data(), literal.text.data() + literal.text.size(), number);
+        if (ec != std::errc() || end != literal.text.data() + literal.text.size()) {
+            throw std::runtime_error("Column '" + column + "' is numeric, but '" + literal.text + "' is not a number.");
+        }
+        return number;
+    }
+
+    CompiledNode compile(const QueryExpression& expression, const std::vector<Column>& columns, const std::vector<std::string>& headers) {
+        CompiledNode node;
+        node.kind = expression.kind;
+        if (expression.kind != QueryExpression::Kind::PREDICATE) {
+            for (const auto& child : expression.children) {
+                node.children.push_back(compile(child, columns, headers));
+            }
+            return node;
+        }
+
+        const auto it = std::ranges::find(headers, expression.column);
+        if (it == headers.end()) {
+            throw std::runtime_error("Unknown column '" + expression.column + "'.");
+        }
+        const Column& column = columns[it - headers.begin()];
+        node.column = &column;
+        node.op = expression.op;
+        if (node.op == QueryOperator::IS_NULL || node.op == QueryOperator::IS_NOT_NULL) {
+            return node;
+        }
+
+        if (column.type() == ColumnType::STRING) {
+            // строковая колонка сравнивается с текстом константы, в том числе числовой
+            std::vector<std::string_view> literals;
+            for (const auto& literal : expression.values) {
+                literals.push_back(literal.text);
+            }
+            std::ranges::sort(literals);
+            const auto& data = column.strings();
+            node.matches.resize(data.dictionarySize());
+            for (u32 code = 0; code < node.matches.size(); ++code) {
+                node.matches[code] = matchText(data.dictionaryAt(code), node.op, literals);
+            }
+            return node;
+        }
+
+        if (node.op == QueryOperator::STARTS_WITH) {
+            throw std::runtime_error("STARTS WITH needs a string column, but '" + expression.column + "' is numeric.");
+        }
+        const bool allIntegers = std::ranges::all_of(expression.values, [](const QueryLiteral& l) { return l.integer.has_value(); });
+        for (const auto& literal : expression.values) {
+            if (column.type() == ColumnType::I64 && allIntegers) {
+                node.integers.push_back(*literal.integer);
+            } else if (column.type() == ColumnType::F32) {
+                node.floats.push_back(static_cast<f32>(numericLiteral(literal, expression.column)));
+            } else {
+                node.numbers.push_back(numericLiteral(literal, expression.column));
+            }
+        }
+        return node;
+    }
+
+    // маска строк [first, first + count) в out; first кратен 64
+    void evaluate(const CompiledNode& node, size_t first, size_t count, u64* out) {
+        const size_t words = (count + 63) / 64;
+        if (node.kind != QueryExpression::Kind::PREDICATE) {
+            const bool isAnd = node.kind == QueryExpression::Kind::AND;
+            evaluate(node.children.front(), first, count, out);
+            std::vector<u64> scratch(words);
+            for (size_t c = 1; c < node.children.size(); ++c) {
+                // AND с пустой маской и OR с полной уже ничего не изменят
+                size_t selected = 0;
+                for (size_t w = 0; w < words; ++w) {
+                    selected += std::popcount(out[w]);
+                }
+                if (selected == (isAnd ? 0 : count)) {
+                    break;
+                }
+                evaluate(node.children[c], first, count, scratch.data());
+                for (size_t w = 0; w < words; ++w) {
+                    out[w] = isAnd ? out[w] & scratch[w] : out[w] | scratch[w];
+                }
+            }
+            return;
+        }
+
+        const Column& column = *node.column;
+        const u64* validity = column.validity().data() + first / 64;
+        switch (node.op) {
+            case QueryOperator::IS_NULL:
+                for (size_t w = 0; w < words; ++w) {
+                    out[w] = ~validity[w] & lowBits(count - w * 64);
+                }
+                return;
+            case QueryOperator::IS_NOT_NULL:
+                for (size_t w = 0; w < words; ++w) {
+                    out[w] = validity[w] & lowBits(count - w * 64);
+                }
+                return;
+            default:
+                break;
+        }
+
+        switch (column.type()) {
+            case ColumnType::I64:
+                if (!node.integers.empty()) {
+                    matchNumeric(column.values<i64>().data() + first, validity, count, out, node.op, node.integers);
+                } else {
+                    matchNumeric(column.values<i64>().data() + first, validity, count, out, node.op, node.numbers);
+                }
+                break;
+            case ColumnType::F32:
+                matchNumeric(column.values<f32>().data() + first, validity, count, out, node.op, node.floats);
+                break;
+            case ColumnType::F64:
+                matchNumeric(column.values<f64>().data() + first, validity, count, out, node.op, node.numbers);
+                break;
+            case ColumnType::STRING: {
+                const u8* matches = node.matches.data();
+                matchWords(column.strings().codes.data() + first, validity, count, out, [matches](u32 code) { return matches[code] != 0; });
+                break;
+            }
+        }
+    }
+
+    std::vector<u64> filterRows(const CompiledNode& root, size_t rowCount, u32 threads) {
+        const size_t batches = (rowCount + batchRows - 1) / batchRows;
+        std::vector<u64> mask((rowCount + 63) / 64);
+        std::vector<size_t> matched(batches);
+        Concurrency::parallelFor(batches, threads, [&](size_t b) {
+            const size_t first = b * batchRows;
+            const size_t count = std::min(batchRows, rowCount - first);
+            u64* words = mask.data() + b * batchWords;
+            evaluate(root, first, count, words);
+            for (size_t w = 0; w < (count + 63) / 64; ++w) {
+                matched[b] += std::popcount(words[w]);
+            }
+        });
+
+        // каждый пакет пишет номера своих строк со своего смещения
+        std::vector<size_t> offsets(batches + 1, 0);
+        std::inclusive_scan(matched.begin(), matched.end(), offsets.begin() + 1);
+        std::vector<u64> rows(offsets.back());
+        Concurrency::parallelFor(batches, threads, [&](size_t b) {
+            const size_t first = b * batchRows;
+            const size_t count = std::min(batchRows, rowCount - first);
+            size_t position = offsets[b];
+            for (size_t w = 0; w < (count + 63) / 64; ++w) {
+                for (u64 bits = mask[b * batchWords + w]; bits != 0; bits &= bits - 1) {
+                    rows[position++] = first + w * 64 + std::countr_zero(bits);
+                }
+            }
+        });
+        return rows;
+    }
+
+    /**
+     * @brief Ключ сортировки для выбранных строк: целые, дроби или ранг строки в словаре.
+     */
+    struct SortColumn {
+        std::vector<i64> integers;
+        std::vector<f64> numbers;
+        std::vector<u8> valid;
+        bool descending = false;
+    };
+
+    SortColumn sortColumn(const Column& column, const std::vector<u64>& rows, bool descending) {
+        SortColumn key;
+        key.descending = descending;
+        key.valid.resize(rows.size());
+        for (size_t i = 0; i < rows.size(); ++i) {
+            key.valid[i] = column.isValid(rows[i]);
+        }
+        switch (column.type()) {
+            case ColumnType::I64: {
+                const auto& values = column.values<i64>();
+                key.integers.resize(rows.size());
+                for (size_t i = 0; i < rows.size(); ++i) key.integers[i] = values[rows[i]];
+                break;
+            }
+            case ColumnType::F32: {
+                const auto& values = column.values<f32>();
+                key.numbers.resize(rows.size());
+                for (size_t i = 0; i < rows.size(); ++i) key.numbers[i] = values[rows[i]];
+                break;
+            }
+            case ColumnType::F64: {
+                const auto& values = column.values<f64>();
+                key.numbers.resize(rows.size());
+                for (size_t i = 0; i < rows.size(); ++i) key.numbers[i] = values[rows[i]];
+                break;
+            }
+            case ColumnType::STRING: {
+                // словарь сортируется один раз, дальше строки сравниваются по рангу кода
+                const auto& data = column.strings();
+                std::vector<u32> byValue(data.dictionarySize());
+                std::iota(byValue.begin(), byValue.end(), 0);
+                std::ranges::sort(byValue, {}, [&data](u32 code) { return data.dictionaryAt(code); });
+                std::vector<i64> rank(byValue.size());
+                for (size_t r = 0; r < byValue.size(); ++r) {
+                    rank[byValue[r]] = static_cast<i64>(r);
+                }
+                key.integers.resize(rows.size());
+                for (size_t i = 0; i < rows.size(); ++i) key.integers[i] = rank[data.codes[rows[i]]];
+                break;
+            }
+        }
+        return key;
+    }
+
+    template<typename T>
+    int compareValues(T a, T b) {
+        return a < b ? -1 : b < a ? 1 : 0;
+    }
+
+    // устойчивая сортировка: куски сортируются параллельно, затем сливаются попарно
+    std::vector<u64> sortRows(const std::vector<u64>& rows, const std::vector<SortColumn>& keys, u32 threads) {
+        auto less = [&keys](u64 a, u64 b) {
+            for (const SortColumn& key : keys) {
+                if (key.valid[a] != key.valid[b]) {
+                    return key.valid[a] > key.valid[b]; // пустые ячейки в конце
+                }
+                if (!key.valid[a]) {
+                    continue;
+                }
+                const int order = key.integers.empty() ? compareValues(key.numbers[a], key.numbers[b])
+                                                       : compareValues(key.integers[a], key.integers[b]);
+                if (order != 0) {
+                    return key.descending ? order > 0 : order < 0;
+                }
+            }
+            return false;
+        };
+
+        std::vector<u64> order(rows.size());
+        std::iota(order.begin(), order.end(), 0);
+        const size_t parts = std::clamp<size_t>(rows.size() / minSortPartRows, 1, threads);
+        std::vector<size_t> bounds(parts + 1);
+        for (size_t p = 0; p <= parts; ++p) {
+            bounds[p] = rows.size() * p / parts;
+        }
+        Concurrency::parallelFor(parts, threads, [&](size_t p) {
+            std::stable_sort(order.begin() + bounds[p], order.begin() + bounds[p + 1], less);
+        });
+        for (size_t width = 1; width < parts; width *= 2) {
+            Concurrency::parallelFor((parts + 2 * width - 1) / (2 * width), threads, [&](size_t q) {
+                const auto at = [&](size_t part) { return order.begin() + bounds[std::min(part, parts)]; };
+                std::inplace_merge(at(2 * q * width), at(2 * q * width + width), at(2 * q * width + 2 * width), less);
+            });
+        }
+
+        std::vector<u64> sorted(rows.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            sorted[i] = rows[order[i]];
+        }
+        return sorted;
+    }
+}
+
+QueryService::QueryService(u32 threads) : _threads(std::max<u32>(threads, 1)) {
+}
+
+std::shared_ptr<Dataset> QueryService::query(const std::shared_ptr<const Dataset>& source, const std::string& where,
+                                             const std::string& orderBy) const {
+    const auto startedAt = std::chrono::steady_clock::now();
+
+    // разбор - до чтения колонок, чтобы синтаксическая ошибка не ждала сборки выбранных строк
+    std::optional<QueryExpression> condition;
+    if (!where.empty()) {
+        condition = parseQueryExpression(where);
+    }
+    std::vector<QuerySortKey> sortKeys;
+    if (!orderBy.empty()) {
+        sortKeys = parseQueryOrder(orderBy);
+    }
+
+    const auto plan = TransformPlan::of(source);
+    const auto columns = plan->materializeColumns();
+    const auto headers = plan->headers();
+    const size_t rowCount = plan->rowCount();
+
+    std::vector<u64> rows;
+    if (condition) {
+        rows = filterRows(compile(*condition, columns, headers), rowCount, _threads);
+    } else {
+        rows.resize(rowCount);
+        std::iota(rows.begin(), rows.end(), u64{0});
+    }
+
+    if (!sortKeys.empty()) {
+        std::vector<SortColumn> keys;
+        for (const auto& sortKey : sortKeys) {
+            const auto it = std::ranges::find(headers, sortKey.column);
+            if (it == headers.end()) {
+                throw std::runtime_error("Unknown column '" + sortKey.column + "'.");
+            }
+            keys.push_back(sortColumn(columns[it - headers.begin()], rows, sortKey.descending));
+        }
+        rows = sortRows(rows, keys, _threads);
+    }
+
+    const size_t matched = rows.size();
+    auto result = std::make_shared<Dataset>();
+    result->plan = plan->withRows(std::move(rows));
+    result->headers = result->plan->headers();
+    result->rowCount = result->plan->rowCount();
+    result->columnCount = result->headers.size();
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startedAt);
+    Log::Logger().info("Query on dataset '{}': {} of {} rows, {} ms", source->name, matched, rowCount, elapsed.count());
+    return result;
+}
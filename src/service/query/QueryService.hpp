@@ -0,0 +1,44 @@
+#ifndef QUERYSERVICE_HPP
+#define QUERYSERVICE_HPP
+
+#include <memory>
+#include <string>
+
+#include "QueryExpression.hpp"
+#include "../DatasetService.hpp"
+
+/**
+ * @brief Фильтр и сортировка строк датасета на стороне сервера.
+ *
+ * Условие вычисляется по колонкам, а не по строкам: строки режутся на пакеты, пакеты
+ * обрабатываются параллельно, и каждое сравнение за один плотный цикл по значениям одной
+ * колонки даёт битовую маску пакета; AND и OR - это операции над словами масок. Сравнения
+ * со строковой колонкой вычисляются один раз на значение словаря, а по строкам идёт только
+ * выборка по коду. Пустая ячейка удовлетворяет только IS NULL, как в SQL.
+ *
+ * Результат - не копия строк, а план с номерами выбранных строк (TransformPlan::withRows),
+ * так что страницы результата читаются прямо из колонок источника.
+ */
+class QueryService {
+public:
+    /**
+     * @param threads Сколько потоков использовать для одного запроса.
+     */
+    explicit QueryService(u32 threads = Concurrency::defaultThreadCount());
+
+    /**
+     * @brief Новый датасет из строк source, удовлетворяющих where, в порядке orderBy.
+     *
+     * Пустой where выбирает все строки, пустой orderBy сохраняет порядок источника. Сортировка
+     * устойчивая, пустые ячейки идут последними при любом направлении.
+     * @throws std::runtime_error при синтаксической ошибке, неизвестной колонке, несравнимых
+     * типах или если колонок источника нет в памяти (ленивый датасет).
+     */
+    std::shared_ptr<Dataset> query(const std::shared_ptr<const Dataset>& source, const std::string& where,
+                                   const std::string& orderBy) const;
+
+private:
+    u32 _threads;
+};
+
+#endif
@@ -0,0 +1,417 @@
+#include "Column.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+namespace {
+    // максимальная длина кратчайшего представления double с запасом
+    constexpr size_t numberBufferSize = 32;
+
+    template<typename T>
+    std::string_view toChars(char (&buffer)[numberBufferSize], T value) {
+        auto [ptr, ec] = std::to_chars(buffer, buffer + numberBufferSize, value);
+        return {buffer, static_cast<size_t>(ptr - buffer)};
+    }
+
+    // целое принимаем только в канонической записи, чтобы не потерять "007" или "+5" при сохранении
+    bool parseI64(std::string_view text, i64& out) {
+        auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), out);
+        if (ec != std::errc() || ptr != text.data() + text.size()) {
+            return false;
+        }
+        char buffer[numberBufferSize];
+        return toChars(buffer, out) == text;
+    }
+
+    bool parseF64(std::string_view text, f64& out) {
+        // ведущие нули ("007", "00.5") означают, что это не число, а код - оставляем строкой
+        const std::string_view digits = text.starts_with('-') ? text.substr(1) : text;
+        if (digits.size() > 1 && digits[0] == '0' && digits[1] >= '0' && digits[1] <= '9') {
+            return false;
+        }
+        auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), out);
+        return ec == std::errc() && ptr == text.data() + text.size() && std::isfinite(out);
+    }
+
+    // f32 подходит, если кратчайшая запись float совпадает с кратчайшей записью double,
+    // то есть значащих цифр в исходном тексте не больше, чем помещается во float
+    bool fitsF32(f64 value) {
+        const auto narrowed = static_cast<f32>(value);
+        if (!std::isfinite(narrowed)) {
+            return false;
+        }
+        char a[numberBufferSize];
+        char b[numberBufferSize];
+        return toChars(a, narrowed) == toChars(b, value);
+    }
+
+    constexpr i64 maxExactF32Integer = i64{1} << 24;
+    constexpr i64 maxExactF64Integer = i64{1} << 53;
+}
+
+Column::Column(Storage values, ColumnBuffer<u64> validity, size_t size, size_t nullCount)
+    : _values(std::move(values)), _validity(std::move(validity)), _size(size), _nullCount(nullCount) {
+}
+
+void Column::appendText(std::string& out, size_t row) const {
+    if (!isValid(row)) {
+        return;
+    }
+    char buffer[numberBufferSize];
+    switch (type()) {
+        case ColumnType::I64:
+            out.append(toChars(buffer, values<i64>()[row]));
+            break;
+        case ColumnType::F32:
+            out.append(toChars(buffer, values<f32>()[row]));
+            break;
+        case ColumnType::F64:
+            out.append(toChars(buffer, values<f64>()[row]));
+            break;
+        case ColumnType::STRING:
+            out.append(stringAt(row));
+            break;
+    }
+}
+
+std::string Column::textAt(size_t row) const {
+    std::string text;
+    appendText(text, row);
+    return text;
+}
+
+Column Column::gather(std::span<const u64> rows) const {
+    std::vector<u64> validity((rows.size() + 63) / 64, 0);
+    size_t nullCount = 0;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const bool valid = isValid(rows[i]);
+        validity[i >> 6] |= u64{valid} << (i & 63);
+        nullCount += !valid;
+    }
+
+    auto values = std::visit([&rows]<typename T>(const T& source) -> Storage {
+        if constexpr (std::is_same_v<T, StringColumnData>) {
+            std::vector<u32> codes(rows.size());
+            for (size_t i = 0; i < rows.size(); ++i) {
+                codes[i] = source.codes[rows[i]];
+            }
+            return StringColumnData{source.dictionaryBytes, source.dictionaryOffsets, ColumnBuffer<u32>(std::move(codes))};
+        } else {
+            std::vector<typename std::remove_cvref_t<decltype(source[0])>> gathered(rows.size());
+            for (size_t i = 0; i < rows.size(); ++i) {
+                gathered[i] = source[rows[i]];
+            }
+            return T(std::move(gathered));
+        }
+    }, _values);
+
+    return Column(std::move(values), ColumnBuffer<u64>(std::move(validity)), rows.size(), nullCount);
+}
+
+size_t Column::memoryBytes() const {
+    size_t bytes = _validity.heapBytes();
+    std::visit([&bytes]<typename T>(const T& values) {
+        if constexpr (std::is_same_v<T, StringColumnData>) {
+            bytes += values.codes.heapBytes();
+            bytes += values.dictionaryBytes.heapBytes();
+            bytes += values.dictionaryOffsets.heapBytes();
+        } else {
+            bytes += values.heapBytes();
+        }
+    }, _values);
+    return bytes;
+}
+
+void ColumnBuilder::append(std::string_view cell) {
+    if (cell.empty()) {
+        // пустая ячейка - null, в буфер кладём заглушку, чтобы индексы строк совпадали
+        switch (_type) {
+            case ColumnType::I64: _i64.push_back(0); break;
+            case ColumnType::F32: _f32.push_back(0); break;
+            case ColumnType::F64: _f64.push_back(0); break;
+            case ColumnType::STRING: _strings->codes.push_back(0); break;
+        }
+        pushValidity(false);
+        return;
+    }
+
+    while (!tryAppend(cell)) {
+        promote();
+    }
+    pushValidity(true);
+}
+
+void ColumnBuilder::append(Column&& column) {
+    if (column.size() == 0) {
+        return;
+    }
+    if (_size == 0) {
+        adopt(std::move(column));
+        return;
+    }
+
+    // расширяем билдер до типа колонки; promote() может перескочить дальше, если значения не влезают
+    while (_type < column.type()) {
+        promote();
+    }
+    if (_type == column.type()) {
+        appendSameType(column);
+        return;
+    }
+
+    // билдер уже шире колонки - переводим значения через текст, как при обычном разборе
+    std::string text;
+    for (size_t row = 0; row < column.size(); ++row) {
+        text.clear();
+        column.appendText(text, row);
+        append(text);
+    }
+}
+
+void ColumnBuilder::adopt(Column&& column) {
+    // буферы забираются без копирования, если колонка ни с кем их не разделяет
+    _type = column.type();
+    _size = column._size;
+    _nullCount = column._nullCount;
+    _validity = std::move(column._validity).release();
+
+    switch (_type) {
+        case ColumnType::I64: _i64 = std::get<ColumnBuffer<i64>>(std::move(column._values)).release(); break;
+        case ColumnType::F32: _f32 = std::get<ColumnBuffer<f32>>(std::move(column._values)).release(); break;
+        case ColumnType::F64: _f64 = std::get<ColumnBuffer<f64>>(std::move(column._values)).release(); break;
+        case ColumnType::STRING: {
+            auto source = std::get<StringColumnData>(std::move(column._values));
+            _strings = std::make_unique<StringState>();
+            _strings->dictionary.bytes = std::move(source.dictionaryBytes).release();
+            _strings->dictionary.offsets = std::move(source.dictionaryOffsets).release();
+            _strings->codes = std::move(source.codes).release();
+            const size_t dictionarySize = _strings->dictionary.size();
+            _strings->lookup.reserve(dictionarySize);
+            for (size_t code = 0; code < dictionarySize; ++code) {
+                _strings->lookup.insert(static_cast<u32>(code));
+            }
+            break;
+        }
+    }
+    column = Column();
+}
+
+void ColumnBuilder::appendSameType(const Column& column) {
+    switch (_type) {
+        case ColumnType::I64: {
+            const auto& values = column.values<i64>();
+            _i64.insert(_i64.end(), values.begin(), values.end());
+            break;
+        }
+        case ColumnType::F32: {
+            const auto& values = column.values<f32>();
+            _f32.insert(_f32.end(), values.begin(), values.end());
+            break;
+        }
+        case ColumnType::F64: {
+            const auto& values = column.values<f64>();
+            _f64.insert(_f64.end(), values.begin(), values.end());
+            break;
+        }
+        case ColumnType::STRING: {
+            // словари разных кусков независимы - перекодируем коды в словарь билдера
+            const auto& source = column.strings();
+            std::vector<u32> remap(source.dictionarySize());
+            for (size_t code = 0; code < remap.size(); ++code) {
+                const std::string_view value = source.dictionaryAt(static_cast<u32>(code));
+                if (auto it = _strings->lookup.find(value); it != _strings->lookup.end()) {
+                    remap[code] = *it;
+                } else {
+                    remap[code] = _strings->dictionary.add(value);
+                    _strings->lookup.insert(remap[code]);
+                }
+            }
+            auto& codes = _strings->codes;
+            codes.reserve(codes.size() + source.codes.size());
+            for (size_t row = 0; row < source.codes.size(); ++row) {
+                codes.push_back(column.isValid(row) ? remap[source.codes[row]] : 0);
+            }
+            break;
+        }
+    }
+    appendValidity(column._validity.span(), column._size);
+    _nullCount += column._nullCount;
+}
+
+void ColumnBuilder::appendValidity(std::span<const u64> validity, size_t count) {
+    const size_t shift = _size & 63;
+    for (size_t word = 0; word < validity.size() && count > 0; ++word) {
+        const size_t bitsInWord = std::min<size_t>(64, count);
+        u64 bits = validity[word];
+        if (bitsInWord < 64) {
+            bits &= (u64{1} << bitsInWord) - 1;
+        }
+
+        if (shift == 0) {
+            _validity.push_back(bits);
+        } else {
+            _validity.back() |= bits << shift;
+            if (shift + bitsInWord > 64) {
+                _validity.push_back(bits >> (64 - shift));
+            }
+        }
+        count -= bitsInWord;
+        _size += bitsInWord;
+    }
+}
+
+bool ColumnBuilder::tryAppend(std::string_view cell) {
+    switch (_type) {
+        case ColumnType::I64: {
+            i64 value;
+            if (!parseI64(cell, value)) return false;
+            _i64.push_back(value);
+            return true;
+        }
+        case ColumnType::F32: {
+            f64 value;
+            if (!parseF64(cell, value) || !fitsF32(value)) return false;
+            _f32.push_back(static_cast<f32>(value));
+            return true;
+        }
+        case ColumnType::F64: {
+            f64 value;
+            if (!parseF64(cell, value)) return false;
+            _f64.push_back(value);
+            return true;
+        }
+        case ColumnType::STRING:
+            appendString(cell);
+            return true;
+    }
+    return false;
+}
+
+void ColumnBuilder::promote() {
+    // пробуем перейти на следующий тип; если накопленные значения в него не влезают без потерь - идём дальше
+    if (_type == ColumnType::I64) {
+        bool fits = true;
+        for (size_t i = 0; i < _size && fits; ++i) {
+            fits = _i64[i] >= -maxExactF32Integer && _i64[i] <= maxExactF32Integer;
+        }
+        if (fits) {
+            _f32.reserve(_i64.capacity());
+            for (const i64 value : _i64) _f32.push_back(static_cast<f32>(value));
+            std::vector<i64>().swap(_i64);
+            _type = ColumnType::F32;
+            return;
+        }
+        fits = true;
+        for (size_t i = 0; i < _size && fits; ++i) {
+            fits = _i64[i] >= -maxExactF64Integer && _i64[i] <= maxExactF64Integer;
+        }
+        if (fits) {
+            _f64.reserve(_i64.capacity());
+            for (const i64 value : _i64) _f64.push_back(static_cast<f64>(value));
+            std::vector<i64>().swap(_i64);
+            _type = ColumnType::F64;
+            return;
+        }
+    } else if (_type == ColumnType::F32) {
+        // переводим через текст, иначе 0.1f превратится в 0.10000000149011612
+        _f64.reserve(_f32.capacity());
+        char buffer[numberBufferSize];
+        for (const f32 value : _f32) {
+            f64 widened = 0;
+            parseF64(toChars(buffer, value), widened);
+            _f64.push_back(widened);
+        }
+        std::vector<f32>().swap(_f32);
+        _type = ColumnType::F64;
+        return;
+    }
+
+    // ничего числового не подошло - переводим всё в строки
+    Column numeric = finish();
+    _strings = std::make_unique<StringState>();
+    _strings->codes.reserve(numeric.size());
+    _type = ColumnType::STRING;
+    std::string text;
+    for (size_t i = 0; i < numeric.size(); ++i) {
+        if (numeric.isValid(i)) {
+            text.clear();
+            numeric.appendText(text, i);
+            appendString(text);
+        } else {
+            _strings->codes.push_back(0);
+        }
+    }
+    // finish() сбросил маску валидности, восстанавливаем её
+    for (size_t i = 0; i < numeric.size(); ++i) {
+        pushValidity(numeric.isValid(i));
+    }
+}
+
+void ColumnBuilder::appendString(std::string_view value) {
+    auto& state = *_strings;
+    if (auto it = state.lookup.find(value); it != state.lookup.end()) {
+        state.codes.push_back(*it);
+        return;
+    }
+    const u32 code = state.dictionary.add(value);
+    state.lookup.insert(code);
+    state.codes.push_back(code);
+}
+
+void ColumnBuilder::pushValidity(bool valid) {
+    if ((_size & 63) == 0) {
+        _validity.push_back(0);
+    }
+    if (valid) {
+        _validity.back() |= u64{1} << (_size & 63);
+    } else {
+        ++_nullCount;
+    }
+    ++_size;
+}
+
+Column ColumnBuilder::finish() {
+    Column::Storage storage;
+    switch (_type) {
+        case ColumnType::I64:
+            _i64.shrink_to_fit();
+            storage = ColumnBuffer<i64>(std::move(_i64));
+            break;
+        case ColumnType::F32:
+            _f32.shrink_to_fit();
+            storage = ColumnBuffer<f32>(std::move(_f32));
+            break;
+        case ColumnType::F64:
+            _f64.shrink_to_fit();
+            storage = ColumnBuffer<f64>(std::move(_f64));
+            break;
+        case ColumnType::STRING: {
+            auto& dictionary = _strings->dictionary;
+            _strings->codes.shrink_to_fit();
+            dictionary.bytes.shrink_to_fit();
+            dictionary.offsets.shrink_to_fit();
+            storage = StringColumnData{
+                ColumnBuffer<char>(std::move(dictionary.bytes)),
+                ColumnBuffer<u64>(std::move(dictionary.offsets)),
+                ColumnBuffer<u32>(std::move(_strings->codes))
+            };
+            break;
+        }
+    }
+    _validity.shrink_to_fit();
+
+    Column column(std::move(storage), ColumnBuffer<u64>(std::move(_validity)), _size, _nullCount);
+
+    // билдер возвращается в исходное состояние
+    _type = ColumnType::I64;
+    _size = 0;
+    _nullCount = 0;
+    _validity = {};
+    _i64 = {};
+    _f32 = {};
+    _f64 = {};
+    _strings.reset();
+
+    return column;
+}
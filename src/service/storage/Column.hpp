@@ -0,0 +1,240 @@
+#ifndef COLUMN_HPP
+#define COLUMN_HPP
+
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <variant>
+#include <vector>
+
+#include "ColumnBuffer.hpp"
+#include "../../util/types/types.hpp"
+
+/**
+ * @brief Физический тип колонки, выбирается при загрузке по содержимому.
+ *
+ * Порядок важен: при выводе типа колонка "расширяется" слева направо,
+ * I64 -> F32 -> F64 -> STRING, пока все значения не поместятся без потерь.
+ */
+enum class ColumnType : u8 {
+    I64,
+    F32,
+    F64,
+    STRING
+};
+
+/**
+ * @brief Изменяемый словарь уникальных строк, в который ColumnBuilder складывает значения:
+ * все значения лежат подряд в одном буфере.
+ */
+struct StringDictionary {
+    std::vector<char> bytes;
+    // offsets[i]..offsets[i + 1] - границы i-го значения в bytes, offsets.size() == size() + 1
+    std::vector<u64> offsets{0};
+
+    [[nodiscard]] size_t size() const { return offsets.size() - 1; }
+
+    [[nodiscard]] std::string_view at(u32 code) const {
+        return {bytes.data() + offsets[code], offsets[code + 1] - offsets[code]};
+    }
+
+    u32 add(std::string_view value) {
+        bytes.insert(bytes.end(), value.begin(), value.end());
+        offsets.push_back(bytes.size());
+        return static_cast<u32>(size() - 1);
+    }
+};
+
+/**
+ * @brief Строковая колонка в словарном кодировании: на ячейку хранится только код значения.
+ *
+ * Словарь хранится так же, как в StringDictionary: байты значений подряд и границы между ними.
+ */
+struct StringColumnData {
+    ColumnBuffer<char> dictionaryBytes;
+    // dictionaryOffsets[i]..dictionaryOffsets[i + 1] - границы i-го значения в dictionaryBytes
+    ColumnBuffer<u64> dictionaryOffsets;
+    ColumnBuffer<u32> codes;
+
+    [[nodiscard]] size_t dictionarySize() const {
+        return dictionaryOffsets.empty() ? 0 : dictionaryOffsets.size() - 1;
+    }
+
+    [[nodiscard]] std::string_view dictionaryAt(u32 code) const {
+        return {dictionaryBytes.data() + dictionaryOffsets[code], dictionaryOffsets[code + 1] - dictionaryOffsets[code]};
+    }
+};
+
+/**
+ * @brief Неизменяемая типизированная колонка датасета.
+ *
+ * Значения хранятся непрерывным буфером своего типа, пустые ячейки отмечены
+ * в битовой маске валидности (бит 0 - значения нет, в буфере лежит заглушка).
+ * Буферы разделяемые и неизменяемые, поэтому копирование колонки не копирует данные,
+ * а сами буферы могут смотреть прямо в отображённый файл снапшота.
+ */
+class Column {
+public:
+    using Storage = std::variant<ColumnBuffer<i64>, ColumnBuffer<f32>, ColumnBuffer<f64>, StringColumnData>;
+
+    Column() = default;
+    Column(Storage values, ColumnBuffer<u64> validity, size_t size, size_t nullCount);
+
+    [[nodiscard]] ColumnType type() const { return static_cast<ColumnType>(_values.index()); }
+    [[nodiscard]] size_t size() const { return _size; }
+    [[nodiscard]] size_t nullCount() const { return _nullCount; }
+
+    [[nodiscard]] bool isValid(size_t row) const {
+        return (_validity[row >> 6] >> (row & 63)) & 1;
+    }
+
+    template<typename T>
+    [[nodiscard]] const ColumnBuffer<T>& values() const { return std::get<ColumnBuffer<T>>(_values); }
+
+    [[nodiscard]] const StringColumnData& strings() const { return std::get<StringColumnData>(_values); }
+
+    /**
+     * @brief Битовая маска валидности, по биту на строку, (size() + 63) / 64 слов.
+     */
+    [[nodiscard]] const ColumnBuffer<u64>& validity() const { return _validity; }
+
+    /**
+     * @brief Значение строковой колонки без копирования. Для пустой ячейки - пустая строка.
+     */
+    [[nodiscard]] std::string_view stringAt(size_t row) const {
+        if (!isValid(row)) return {};
+        const auto& data = strings();
+        return data.dictionaryAt(data.codes[row]);
+    }
+
+    /**
+     * @brief Дописывает текстовое представление ячейки в out. Пустая ячейка ничего не дописывает.
+     *
+     * Числа печатаются кратчайшим представлением, которое парсится обратно в то же значение,
+     * поэтому "1.50" из исходного файла вернётся как "1.5".
+     */
+    void appendText(std::string& out, size_t row) const;
+
+    [[nodiscard]] std::string textAt(size_t row) const;
+
+    /**
+     * @brief Новая колонка из строк rows в заданном порядке. Строковая колонка
+     * разделяет словарь с исходной - копируются только коды.
+     */
+    [[nodiscard]] Column gather(std::span<const u64> rows) const;
+
+    /**
+     * @brief Примерный объём кучи, занимаемый буферами колонки, в байтах.
+     * Буферы поверх отображённого файла не учитываются.
+     */
+    [[nodiscard]] size_t memoryBytes() const;
+
+    /**
+     * @brief Вызывает fn(identity, bytes) для каждого буфера колонки, лежащего в куче.
+     * У буферов, разделяемых несколькими колонками, identity одинаков - по нему
+     * общий объём памяти считается без повторов.
+     */
+    template<typename Fn>
+    void forEachHeapBuffer(Fn&& fn) const {
+        auto visit = [&fn](const auto& buffer) {
+            if (buffer.heapBytes() > 0) {
+                fn(buffer.identity(), buffer.heapBytes());
+            }
+        };
+        visit(_validity);
+        std::visit([&visit]<typename T>(const T& values) {
+            if constexpr (std::is_same_v<T, StringColumnData>) {
+                visit(values.codes);
+                visit(values.dictionaryBytes);
+                visit(values.dictionaryOffsets);
+            } else {
+                visit(values);
+            }
+        }, _values);
+    }
+
+private:
+    friend class ColumnBuilder;
+
+    Storage _values{};
+    ColumnBuffer<u64> _validity{};
+    size_t _size = 0;
+    size_t _nullCount = 0;
+};
+
+/**
+ * @brief Строит колонку из текстовых ячеек, на лету выводя её тип.
+ *
+ * Колонка начинается как I64 и расширяется до F32, F64 или STRING, как только
+ * очередное значение перестаёт помещаться в текущий тип. Уже накопленные значения
+ * при этом конвертируются, так что повторный проход по файлу не нужен.
+ */
+class ColumnBuilder {
+public:
+    ColumnBuilder() = default;
+    ColumnBuilder(ColumnBuilder&&) noexcept = default;
+    ColumnBuilder& operator=(ColumnBuilder&&) noexcept = default;
+
+    void append(std::string_view cell);
+
+    /**
+     * @brief Дописывает в конец все значения готовой колонки.
+     *
+     * Используется для склейки колонок, разобранных по кускам в разных потоках. Пустой билдер
+     * забирает буферы колонки без копирования; при совпадении типов значения копируются
+     * целиком, при расхождении тип билдера расширяется так же, как при построчном добавлении.
+     */
+    void append(Column&& column);
+
+    [[nodiscard]] size_t size() const { return _size; }
+
+    Column finish();
+
+private:
+    // хэш и сравнение по коду строки, смотрят в словарь, чтобы не дублировать значения в таблице поиска
+    struct CodeHash {
+        using is_transparent = void;
+        const StringDictionary* dictionary;
+        size_t operator()(u32 code) const { return std::hash<std::string_view>{}(dictionary->at(code)); }
+        size_t operator()(std::string_view value) const { return std::hash<std::string_view>{}(value); }
+    };
+
+    struct CodeEqual {
+        using is_transparent = void;
+        const StringDictionary* dictionary;
+        bool operator()(u32 a, u32 b) const { return a == b; }
+        bool operator()(std::string_view a, u32 b) const { return a == dictionary->at(b); }
+        bool operator()(u32 a, std::string_view b) const { return dictionary->at(a) == b; }
+    };
+
+    struct StringState {
+        StringDictionary dictionary;
+        std::vector<u32> codes;
+        std::unordered_set<u32, CodeHash, CodeEqual> lookup;
+
+        StringState() : lookup(16, CodeHash{&dictionary}, CodeEqual{&dictionary}) {}
+    };
+
+    bool tryAppend(std::string_view cell);
+    void adopt(Column&& column);
+    void appendSameType(const Column& column);
+    void appendValidity(std::span<const u64> validity, size_t count);
+    void promote();
+    void appendString(std::string_view value);
+    void pushValidity(bool valid);
+
+    ColumnType _type = ColumnType::I64;
+    size_t _size = 0;
+    size_t _nullCount = 0;
+    std::vector<u64> _validity{};
+
+    std::vector<i64> _i64{};
+    std::vector<f32> _f32{};
+    std::vector<f64> _f64{};
+    // лежит в куче, чтобы хэш-таблица могла держать указатель на словарь при перемещении билдера
+    std::unique_ptr<StringState> _strings{};
+};
+
+#endif
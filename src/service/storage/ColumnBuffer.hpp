@@ -0,0 +1,96 @@
+#ifndef COLUMNBUFFER_HPP
+#define COLUMNBUFFER_HPP
+
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "../../util/types/types.hpp"
+
+/**
+ * @brief Неизменяемый непрерывный буфер значений колонки с разделяемым владением.
+ *
+ * Память либо принадлежит буферу (перенесённый std::vector), либо лежит снаружи,
+ * например в отображённом файле снапшота, - тогда владелец удерживает её, пока жив
+ * хоть один буфер. Копирование буфера не копирует данные: производные датасеты
+ * разделяют буферы с родителем по счётчику ссылок.
+ *
+ * Записи в буфер нет. Забрать значения обратно в вектор можно через release(): без копии,
+ * только если буфер владеет памятью единолично, иначе значения копируются.
+ */
+template<typename T>
+class ColumnBuffer {
+public:
+    ColumnBuffer() = default;
+
+    explicit ColumnBuffer(std::vector<T> values) {
+        adoptVector(std::make_shared<std::vector<T>>(std::move(values)));
+    }
+
+    /**
+     * @brief Буфер поверх чужой памяти. owner должен удерживать data, пока жив буфер.
+     */
+    ColumnBuffer(std::shared_ptr<const void> owner, const T* data, size_t size)
+        : _owner(std::move(owner)), _data(data), _size(size) {
+    }
+
+    [[nodiscard]] const T* data() const { return _data; }
+    [[nodiscard]] size_t size() const { return _size; }
+    [[nodiscard]] bool empty() const { return _size == 0; }
+
+    [[nodiscard]] const T& operator[](size_t i) const { return _data[i]; }
+    [[nodiscard]] const T* begin() const { return _data; }
+    [[nodiscard]] const T* end() const { return _data + _size; }
+    [[nodiscard]] std::span<const T> span() const { return {_data, _size}; }
+
+    /**
+     * @brief Сколько байт кучи занимает буфер. Для внешней памяти (mmap) - ноль.
+     */
+    [[nodiscard]] size_t heapBytes() const { return _vector ? _size * sizeof(T) : 0; }
+
+    /**
+     * @brief Идентификатор памяти буфера: совпадает у буферов, разделяющих одни данные.
+     */
+    [[nodiscard]] const void* identity() const { return _owner.get(); }
+
+    /**
+     * @brief true, если память больше не разделяется ни с одним другим буфером.
+     *
+     * Ответ верен, только пока другие потоки не копируют этот буфер, - то есть для буфера,
+     * который ещё не отдан наружу (загрузчик, собирающий колонку).
+     */
+    [[nodiscard]] bool isUnique() const { return _owner.use_count() == 1; }
+
+    /**
+     * @brief Забирает значения в вектор; без копирования, если память ни с кем не разделяется.
+     * Буфер после вызова пуст. Как и isUnique(), только для буфера, который видит один поток.
+     */
+    std::vector<T> release() && {
+        detach();
+        std::vector<T> values = std::move(*_vector);
+        *this = ColumnBuffer();
+        return values;
+    }
+
+private:
+    void detach() {
+        if (!_vector || !isUnique()) {
+            adoptVector(std::make_shared<std::vector<T>>(begin(), end()));
+        }
+    }
+
+    void adoptVector(std::shared_ptr<std::vector<T>> values) {
+        _vector = values.get();
+        _data = values->data();
+        _size = values->size();
+        _owner = std::move(values);
+    }
+
+    std::shared_ptr<const void> _owner{};
+    // не null, если память - собственный вектор буфера, а не внешний владелец
+    std::vector<T>* _vector = nullptr;
+    const T* _data = nullptr;
+    size_t _size = 0;
+};
+
+#endif
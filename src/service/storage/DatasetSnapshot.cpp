@@ -0,0 +1,311 @@
+#include "DatasetSnapshot.hpp"
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <stdexcept>
+
+#include "../../util/concurrency/Parallel.hpp"
+#include "../../util/hash/XxHash64.hpp"
+#include "../../util/io/MappedFile.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+    static_assert(std::endian::native == std::endian::little, "Dataset snapshots are stored in little-endian order");
+
+    constexpr std::array<char, 8> snapshotMagic{'N', 'E', 'U', 'R', 'O', 'D', 'S', '\0'};
+    constexpr u32 snapshotVersion = 1;
+    // выравнивание буферов: подходит для любого типа значений и совпадает с кэш-линией
+    constexpr size_t bufferAlignment = 64;
+
+    struct FileHeader {
+        std::array<char, 8> magic;
+        u32 version;
+        u32 columnCount;
+        u64 rowCount;
+        u64 schemaOffset;
+        u64 schemaSize;
+        u64 schemaChecksum;
+        u8 reserved[16];
+    };
+    static_assert(sizeof(FileHeader) == 64, "Snapshot header layout must not change");
+
+    struct BufferRef {
+        u64 offset;
+        u64 size;
+        u64 checksum;
+    };
+
+    size_t validityWords(size_t rowCount) {
+        return (rowCount + 63) / 64;
+    }
+
+    template<typename T>
+    void appendPod(std::string& out, const T& value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    // пишет буферы подряд с выравниванием и считает их контрольные суммы
+    class SnapshotWriter {
+    public:
+        explicit SnapshotWriter(const fs::path& path) : _out(path, std::ios::binary | std::ios::trunc) {
+            if (!_out.is_open()) {
+                throw std::runtime_error("Could not open file for writing: " + path.string());
+            }
+        }
+
+        void write(const void* data, size_t size) {
+            _out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            _position += size;
+        }
+
+        void align() {
+            static constexpr char zeros[bufferAlignment] = {};
+            const size_t padding = (bufferAlignment - _position % bufferAlignment) % bufferAlignment;
+            write(zeros, padding);
+        }
+
+        template<typename T>
+        BufferRef writeBuffer(std::span<const T> values) {
+            align();
+            const BufferRef ref{_position, values.size_bytes(), xxHash64(values.data(), values.size_bytes())};
+            write(values.data(), values.size_bytes());
+            return ref;
+        }
+
+        [[nodiscard]] u64 position() const { return _position; }
+
+        void finish(const FileHeader& header) {
+            _out.seekp(0);
+            _out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            _out.close();
+            if (!_out) {
+                throw std::runtime_error("Failed to write dataset snapshot.");
+            }
+        }
+
+    private:
+        std::ofstream _out;
+        u64 _position = 0;
+    };
+
+    // последовательное чтение схемы с проверкой границ
+    class SchemaCursor {
+    public:
+        explicit SchemaCursor(std::string_view data) : _data(data) {}
+
+        template<typename T>
+        T read() {
+            T value;
+            std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+            return value;
+        }
+
+        std::string_view take(size_t size) {
+            if (size > _data.size() - _position) {
+                throw std::runtime_error("Dataset snapshot schema is truncated.");
+            }
+            const std::string_view bytes = _data.substr(_position, size);
+            _position += size;
+            return bytes;
+        }
+
+    private:
+        std::string_view _data;
+        size_t _position = 0;
+    };
+
+    template<typename T>
+    ColumnBuffer<T> mapBuffer(const std::shared_ptr<const MappedFile>& file, const BufferRef& ref,
+                              size_t expectedCount, const std::string& columnName) {
+        const bool inBounds = ref.offset <= file->size() && ref.size <= file->size() - ref.offset;
+        if (!inBounds || ref.offset % bufferAlignment != 0 || ref.size % sizeof(T) != 0) {
+            throw std::runtime_error("Dataset snapshot has an invalid buffer in column '" + columnName + "'.");
+        }
+        const size_t count = ref.size / sizeof(T);
+        if (expectedCount != std::dynamic_extent && count != expectedCount) {
+            throw std::runtime_error("Dataset snapshot buffer size does not match row count in column '" + columnName + "'.");
+        }
+        return ColumnBuffer<T>(file, reinterpret_cast<const T*>(file->data() + ref.offset), count);
+    }
+
+    void validateStrings(const StringColumnData& strings, const ColumnBuffer<u64>& validity, const std::string& columnName) {
+        const auto& offsets = strings.dictionaryOffsets;
+        bool valid = !offsets.empty() && offsets[0] == 0 && offsets[offsets.size() - 1] == strings.dictionaryBytes.size();
+        for (size_t i = 1; valid && i < offsets.size(); ++i) {
+            valid = offsets[i - 1] <= offsets[i];
+        }
+
+        const size_t dictionarySize = strings.dictionarySize();
+        for (size_t row = 0; valid && row < strings.codes.size(); ++row) {
+            const bool present = (validity[row >> 6] >> (row & 63)) & 1;
+            valid = !present || strings.codes[row] < dictionarySize;
+        }
+
+        if (!valid) {
+            throw std::runtime_error("Dataset snapshot has an inconsistent dictionary in column '" + columnName + "'.");
+        }
+    }
+}
+
+void writeDatasetSnapshot(const std::string& filePath, const std::vector<std::string>& headers,
+                          const std::vector<Column>& columns, size_t rowCount) {
+    if (headers.size() != columns.size()) {
+        throw std::runtime_error("Dataset snapshot needs exactly one header per column.");
+    }
+
+    // пишем рядом и переименовываем в конце, чтобы при сбое не оставить битый файл под итоговым именем
+    const fs::path finalPath(filePath);
+    const fs::path tempPath = fs::path(filePath + ".tmp");
+
+    try {
+        SnapshotWriter writer(tempPath);
+
+        FileHeader header{};
+        writer.write(&header, sizeof(header)); // место под заголовок, заполним в конце
+
+        std::string schema;
+        for (size_t i = 0; i < columns.size(); ++i) {
+            const Column& column = columns[i];
+            if (column.size() != rowCount) {
+                throw std::runtime_error("Column '" + headers[i] + "' has a different row count than the dataset.");
+            }
+
+            std::vector<BufferRef> buffers;
+            buffers.push_back(writer.writeBuffer(column.validity().span()));
+            switch (column.type()) {
+                case ColumnType::I64: buffers.push_back(writer.writeBuffer(column.values<i64>().span())); break;
+                case ColumnType::F32: buffers.push_back(writer.writeBuffer(column.values<f32>().span())); break;
+                case ColumnType::F64: buffers.push_back(writer.writeBuffer(column.values<f64>().span())); break;
+                case ColumnType::STRING: {
+                    const auto& strings = column.strings();
+                    buffers.push_back(writer.writeBuffer(strings.codes.span()));
+                    buffers.push_back(writer.writeBuffer(strings.dictionaryOffsets.span()));
+                    buffers.push_back(writer.writeBuffer(strings.dictionaryBytes.span()));
+                    break;
+                }
+            }
+
+            appendPod(schema, static_cast<u32>(headers[i].size()));
+            schema.append(headers[i]);
+            appendPod(schema, static_cast<u8>(column.type()));
+            appendPod(schema, static_cast<u64>(column.nullCount()));
+            appendPod(schema, static_cast<u32>(buffers.size()));
+            for (const auto& buffer : buffers) {
+                appendPod(schema, buffer);
+            }
+        }
+
+        writer.align();
+        header.magic = snapshotMagic;
+        header.version = snapshotVersion;
+        header.columnCount = static_cast<u32>(columns.size());
+        header.rowCount = rowCount;
+        header.schemaOffset = writer.position();
+        header.schemaSize = schema.size();
+        header.schemaChecksum = xxHash64(schema.data(), schema.size());
+        writer.write(schema.data(), schema.size());
+        writer.finish(header);
+
+        fs::rename(tempPath, finalPath);
+    } catch (...) {
+        std::error_code ignored;
+        fs::remove(tempPath, ignored);
+        throw;
+    }
+}
+
+DatasetSnapshotData readDatasetSnapshot(const std::string& filePath, bool verifyChecksums) {
+    // контрольные суммы читают файл целиком, без них обращения будут точечными
+    const auto file = std::make_shared<const MappedFile>(
+        filePath, verifyChecksums ? MappedFile::AccessPattern::SEQUENTIAL : MappedFile::AccessPattern::RANDOM);
+
+    FileHeader header;
+    if (file->size() < sizeof(header)) {
+        throw std::runtime_error("File '" + filePath + "' is not a dataset snapshot.");
+    }
+    std::memcpy(&header, file->data(), sizeof(header));
+    if (header.magic != snapshotMagic) {
+        throw std::runtime_error("File '" + filePath + "' is not a dataset snapshot.");
+    }
+    if (header.version != snapshotVersion) {
+        throw std::runtime_error("Unsupported dataset snapshot version " + std::to_string(header.version) + ".");
+    }
+    if (header.schemaOffset > file->size() || header.schemaSize > file->size() - header.schemaOffset) {
+        throw std::runtime_error("Dataset snapshot schema is out of file bounds.");
+    }
+
+    const std::string_view schemaBytes = file->view().substr(header.schemaOffset, header.schemaSize);
+    if (xxHash64(schemaBytes.data(), schemaBytes.size()) != header.schemaChecksum) {
+        throw std::runtime_error("Dataset snapshot schema checksum mismatch.");
+    }
+
+    DatasetSnapshotData snapshot;
+    snapshot.rowCount = header.rowCount;
+    snapshot.headers.reserve(header.columnCount);
+    snapshot.columns.reserve(header.columnCount);
+
+    // буферы проверяем все вместе в конце, чтобы распараллелить хэширование
+    std::vector<std::pair<BufferRef, size_t>> checksums;
+
+    SchemaCursor cursor(schemaBytes);
+    for (u32 i = 0; i < header.columnCount; ++i) {
+        const u32 nameLength = cursor.read<u32>();
+        std::string name(cursor.take(nameLength));
+        const u8 typeIndex = cursor.read<u8>();
+        const u64 nullCount = cursor.read<u64>();
+        const u32 bufferCount = cursor.read<u32>();
+
+        if (typeIndex > static_cast<u8>(ColumnType::STRING) || nullCount > header.rowCount) {
+            throw std::runtime_error("Dataset snapshot has an invalid descriptor for column '" + name + "'.");
+        }
+        const auto type = static_cast<ColumnType>(typeIndex);
+        const u32 expectedBuffers = type == ColumnType::STRING ? 4 : 2;
+        if (bufferCount != expectedBuffers) {
+            throw std::runtime_error("Dataset snapshot has an invalid descriptor for column '" + name + "'.");
+        }
+
+        std::vector<BufferRef> buffers(bufferCount);
+        for (auto& buffer : buffers) {
+            buffer = cursor.read<BufferRef>();
+            checksums.emplace_back(buffer, i);
+        }
+
+        auto validity = mapBuffer<u64>(file, buffers[0], validityWords(header.rowCount), name);
+        Column::Storage storage;
+        switch (type) {
+            case ColumnType::I64: storage = mapBuffer<i64>(file, buffers[1], header.rowCount, name); break;
+            case ColumnType::F32: storage = mapBuffer<f32>(file, buffers[1], header.rowCount, name); break;
+            case ColumnType::F64: storage = mapBuffer<f64>(file, buffers[1], header.rowCount, name); break;
+            case ColumnType::STRING: {
+                StringColumnData strings{
+                    mapBuffer<char>(file, buffers[3], std::dynamic_extent, name),
+                    mapBuffer<u64>(file, buffers[2], std::dynamic_extent, name),
+                    mapBuffer<u32>(file, buffers[1], header.rowCount, name)
+                };
+                validateStrings(strings, validity, name);
+                storage = std::move(strings);
+                break;
+            }
+        }
+
+        snapshot.columns.emplace_back(std::move(storage), std::move(validity), header.rowCount, nullCount);
+        snapshot.headers.push_back(std::move(name));
+    }
+
+    if (verifyChecksums) {
+        Concurrency::parallelFor(checksums.size(), Concurrency::defaultThreadCount(), [&](size_t i) {
+            const auto& [buffer, column] = checksums[i];
+            if (xxHash64(file->data() + buffer.offset, buffer.size) != buffer.checksum) {
+                throw std::runtime_error("Dataset snapshot checksum mismatch in column '" + snapshot.headers[column] + "'.");
+            }
+        });
+    }
+
+    return snapshot;
+}
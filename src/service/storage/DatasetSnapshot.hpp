@@ -0,0 +1,52 @@
+#ifndef DATASETSNAPSHOT_HPP
+#define DATASETSNAPSHOT_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Column.hpp"
+#include "../../util/types/types.hpp"
+
+/**
+ * @brief Расширение файлов бинарного снапшота датасета.
+ */
+inline constexpr std::string_view datasetSnapshotExtension = ".nds";
+
+/**
+ * @brief Содержимое снапшота: заголовки и колонки, буферы которых смотрят прямо в отображённый файл.
+ */
+struct DatasetSnapshotData {
+    std::vector<std::string> headers;
+    std::vector<Column> columns;
+    size_t rowCount = 0;
+};
+
+/**
+ * @brief Записывает колонки в бинарный колоночный снапшот.
+ *
+ * Формат (little-endian, версия 1):
+ *  - заголовок 64 байта: магия "NEURODS\0", версия, число колонок, число строк,
+ *    смещение, размер и контрольная сумма схемы;
+ *  - буферы колонок в том же виде, что и в памяти, каждый выровнен на 64 байта:
+ *    маска валидности, затем значения (числовые колонки) или коды, границы и байты словаря (строковые);
+ *  - схема: для каждой колонки имя, тип, число пустых ячеек и список буферов
+ *    (смещение, размер, контрольная сумма XXH64).
+ *
+ * Файл пишется во временный и переименовывается, так что недописанный снапшот не виден под итоговым именем.
+ * @throws std::runtime_error если файл не удалось записать.
+ */
+void writeDatasetSnapshot(const std::string& filePath, const std::vector<std::string>& headers,
+                          const std::vector<Column>& columns, size_t rowCount);
+
+/**
+ * @brief Открывает снапшот без разбора: файл отображается в память, колонки ссылаются на него напрямую.
+ *
+ * Проверяются магия, версия, границы и размеры всех буферов, согласованность словарей и,
+ * если verifyChecksums, контрольные суммы (параллельно по буферам).
+ * Отображение живёт, пока жива хоть одна колонка из результата.
+ * @throws std::runtime_error если файл повреждён или имеет неподдерживаемую версию.
+ */
+DatasetSnapshotData readDatasetSnapshot(const std::string& filePath, bool verifyChecksums = true);
+
+#endif
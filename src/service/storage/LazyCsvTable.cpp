@@ -0,0 +1,69 @@
+#include "LazyCsvTable.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "../../util/csv/CsvReader.hpp"
+
+LazyCsvTable::LazyCsvTable(const std::string& filePath, const ProgressCallback& onProgress)
+    : _file(filePath, MappedFile::AccessPattern::SEQUENTIAL) {
+    const std::string_view data = _file.view();
+
+    std::vector<std::string_view> cells;
+    CsvReader headerReader(data);
+    if (!headerReader.next(cells)) {
+        throw std::runtime_error("CSV file is empty or header is missing.");
+    }
+    _headers.assign(cells.begin(), cells.end());
+    const size_t dataBegin = headerReader.position();
+
+    size_t reportedBytes = dataBegin;
+    size_t reportedRows = 0;
+    if (onProgress) {
+        onProgress(dataBegin, 0);
+    }
+
+    _index = CsvRowIndex::build(data, dataBegin, ',', [&](size_t scannedUpTo, size_t rows) {
+        // прочитанное больше не понадобится, не держим его в резидентной памяти
+        _file.dropPages(reportedBytes, scannedUpTo - reportedBytes);
+        if (onProgress) {
+            onProgress(scannedUpTo - reportedBytes, rows - reportedRows);
+        }
+        reportedBytes = scannedUpTo;
+        reportedRows = rows;
+    });
+    if (onProgress && _index.rowCount() > reportedRows) {
+        onProgress(0, _index.rowCount() - reportedRows);
+    }
+
+    // дальше страницы читаются точечно, упреждающее чтение только зря гоняло бы диск
+    _file.advise(MappedFile::AccessPattern::RANDOM);
+}
+
+size_t LazyCsvTable::memoryBytes() const {
+    size_t bytes = _index.memoryBytes();
+    for (const auto& header : _headers) {
+        bytes += header.capacity();
+    }
+    return bytes;
+}
+
+void LazyCsvTable::readRows(size_t firstRow, size_t count, const std::function<void(std::span<const std::string_view>)>& onRow) const {
+    const auto span = _index.span(firstRow, count);
+    if (span.begin == span.end) {
+        return;
+    }
+
+    // разбираем только кусок файла от ближайшей контрольной точки до следующей за последней строкой
+    CsvReader reader(_file.view().substr(span.begin, span.end - span.begin));
+    std::vector<std::string_view> row;
+    for (size_t i = 0; i < span.skipRows; ++i) {
+        reader.next(row);
+    }
+
+    const size_t rows = std::min(count, rowCount() - firstRow);
+    for (size_t i = 0; i < rows && reader.next(row); ++i) {
+        row.resize(_headers.size());
+        onRow(row);
+    }
+}
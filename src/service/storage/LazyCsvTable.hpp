@@ -0,0 +1,57 @@
+#ifndef LAZYCSVTABLE_HPP
+#define LAZYCSVTABLE_HPP
+
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../../util/csv/CsvRowIndex.hpp"
+#include "../../util/io/MappedFile.hpp"
+#include "../../util/types/types.hpp"
+
+/**
+ * @brief Таблица, которая остаётся на диске: в памяти только заголовок и разреженный индекс строк.
+ *
+ * При открытии файл один раз читается последовательно (уже прочитанные страницы сразу
+ * отпускаются), после чего отображение переключается в режим случайного доступа,
+ * и каждое чтение разбирает только нужный диапазон записей.
+ * Объект неизменяем, читать из него можно из нескольких потоков одновременно.
+ */
+class LazyCsvTable {
+public:
+    /**
+     * @brief Вызывается по ходу построения индекса с приращениями прочитанных байт и найденных строк.
+     */
+    using ProgressCallback = std::function<void(u64 bytes, u64 rows)>;
+
+    /**
+     * @param filePath Путь к CSV-файлу.
+     * @throws std::runtime_error если файл не удалось открыть или в нём нет заголовка.
+     */
+    explicit LazyCsvTable(const std::string& filePath, const ProgressCallback& onProgress = {});
+
+    [[nodiscard]] const std::vector<std::string>& headers() const { return _headers; }
+    [[nodiscard]] size_t rowCount() const { return _index.rowCount(); }
+
+    /**
+     * @brief Память, занимаемая таблицей в куче (индекс и заголовок), без отображённого файла.
+     */
+    [[nodiscard]] size_t memoryBytes() const;
+
+    /**
+     * @brief Разбирает записи [firstRow, firstRow + count) и передаёт каждую в onRow.
+     *
+     * Количество ячеек всегда равно числу заголовков: недостающие считаются пустыми, лишние
+     * отбрасываются. View ячеек живут только до возврата из onRow.
+     */
+    void readRows(size_t firstRow, size_t count, const std::function<void(std::span<const std::string_view>)>& onRow) const;
+
+private:
+    MappedFile _file;
+    std::vector<std::string> _headers{};
+    CsvRowIndex _index{};
+};
+
+#endif
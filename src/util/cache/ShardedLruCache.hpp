@@ -0,0 +1,156 @@
+#ifndef SHARDEDLRUCACHE_HPP
+#define SHARDEDLRUCACHE_HPP
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../types/types.hpp"
+
+namespace Cache {
+
+    /**
+     * @brief Счётчики кэша на момент запроса.
+     */
+    struct CacheStats {
+        u64 hits;
+        u64 misses;
+        size_t entries;
+        size_t bytes;
+        size_t capacityBytes;
+    };
+
+    /**
+     * @brief Ограниченный по байтам LRU-кэш со строковыми ключами, разбитый на шарды.
+     *
+     * Каждый шард - отдельный LRU со своим мьютексом и равной долей ёмкости, так что
+     * параллельные запросы к разным ключам почти не конкурируют. Размер значения
+     * передаёт вызывающий; значение больше доли шарда не кэшируется.
+     * Value копируется при чтении, поэтому для больших данных стоит хранить shared_ptr.
+     */
+    template<typename Value>
+    class ShardedLruCache {
+        struct Entry {
+            std::string key;
+            Value value;
+            size_t bytes;
+        };
+
+        struct KeyHash {
+            using is_transparent = void;
+            size_t operator()(std::string_view key) const { return std::hash<std::string_view>{}(key); }
+        };
+
+        struct Shard {
+            std::mutex mutex;
+            std::list<Entry> entries; // в начале - самые свежие
+            std::unordered_map<std::string, typename std::list<Entry>::iterator, KeyHash, std::equal_to<>> index;
+            size_t bytes = 0;
+        };
+
+        std::vector<Shard> _shards;
+        size_t _shardCapacity;
+        std::atomic<u64> _hits{0};
+        std::atomic<u64> _misses{0};
+
+    public:
+        explicit ShardedLruCache(size_t capacityBytes, size_t shardCount = 16)
+            : _shards(std::max<size_t>(shardCount, 1)), _shardCapacity(capacityBytes / _shards.size()) {}
+
+        ShardedLruCache(const ShardedLruCache&) = delete;
+        ShardedLruCache& operator=(const ShardedLruCache&) = delete;
+
+        /**
+         * @brief Наибольший размер значения, которое кэш согласится сохранить.
+         */
+        [[nodiscard]] size_t maxValueBytes() const { return _shardCapacity; }
+
+        [[nodiscard]] std::optional<Value> get(std::string_view key) {
+            Shard& shard = shardFor(key);
+            std::lock_guard lock(shard.mutex);
+            const auto it = shard.index.find(key);
+            if (it == shard.index.end()) {
+                _misses.fetch_add(1, std::memory_order_relaxed);
+                return std::nullopt;
+            }
+            _hits.fetch_add(1, std::memory_order_relaxed);
+            shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+            return it->second->value;
+        }
+
+        /**
+         * @brief Кладёт значение, вытесняя самые старые записи шарда, пока не хватит места.
+         * @return false, если значение больше доли шарда и не сохранено.
+         */
+        bool put(std::string key, Value value, size_t bytes) {
+            if (bytes > _shardCapacity) {
+                return false;
+            }
+            Shard& shard = shardFor(key);
+            std::lock_guard lock(shard.mutex);
+
+            if (const auto it = shard.index.find(key); it != shard.index.end()) {
+                shard.bytes -= it->second->bytes;
+                shard.entries.erase(it->second);
+                shard.index.erase(it);
+            }
+            while (shard.bytes + bytes > _shardCapacity && !shard.entries.empty()) {
+                const Entry& oldest = shard.entries.back();
+                shard.bytes -= oldest.bytes;
+                shard.index.erase(oldest.key);
+                shard.entries.pop_back();
+            }
+
+            shard.entries.push_front(Entry{key, std::move(value), bytes});
+            shard.index.emplace(std::move(key), shard.entries.begin());
+            shard.bytes += bytes;
+            return true;
+        }
+
+        /**
+         * @brief Удаляет все записи, ключ которых начинается с prefix. Проходит по всем шардам.
+         * @return Сколько записей удалено.
+         */
+        size_t erasePrefix(std::string_view prefix) {
+            size_t erased = 0;
+            for (Shard& shard : _shards) {
+                std::lock_guard lock(shard.mutex);
+                for (auto it = shard.entries.begin(); it != shard.entries.end();) {
+                    if (it->key.starts_with(prefix)) {
+                        shard.bytes -= it->bytes;
+                        shard.index.erase(it->key);
+                        it = shard.entries.erase(it);
+                        ++erased;
+                    } else {
+                        ++it;
+                    }
+                }
+            }
+            return erased;
+        }
+
+        [[nodiscard]] CacheStats stats() {
+            CacheStats stats{_hits.load(std::memory_order_relaxed), _misses.load(std::memory_order_relaxed),
+                             0, 0, _shardCapacity * _shards.size()};
+            for (Shard& shard : _shards) {
+                std::lock_guard lock(shard.mutex);
+                stats.entries += shard.entries.size();
+                stats.bytes += shard.bytes;
+            }
+            return stats;
+        }
+
+    private:
+        Shard& shardFor(std::string_view key) {
+            return _shards[KeyHash{}(key) % _shards.size()];
+        }
+    };
+}
+
+#endif
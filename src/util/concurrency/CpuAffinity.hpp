@@ -0,0 +1,30 @@
+#ifndef CPUAFFINITY_HPP
+#define CPUAFFINITY_HPP
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "../types/types.hpp"
+
+namespace Concurrency {
+
+    /**
+     * @brief Привязывает текущий поток к одному ядру.
+     * @return false, если платформа не поддерживает привязку или ядра с таким номером нет.
+     */
+    inline bool pinCurrentThreadToCpu(u32 cpu) {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        (void)cpu;
+        return false;
+#endif
+    }
+}
+
+#endif
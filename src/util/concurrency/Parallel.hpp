@@ -0,0 +1,76 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../types/types.hpp"
+
+namespace Concurrency {
+
+    /**
+     * @brief Число потоков по умолчанию - по количеству аппаратных потоков, но не меньше одного.
+     */
+    inline u32 defaultThreadCount() {
+        const u32 hardware = std::thread::hardware_concurrency();
+        return hardware == 0 ? 1 : hardware;
+    }
+
+    /**
+     * @brief Вызывает fn(i) для каждого i из [0, count), распределяя индексы между threads потоками.
+     *
+     * Вызывающий поток тоже участвует в работе. Индексы раздаются динамически, так что
+     * неравные по стоимости задачи балансируются сами. Первое выброшенное исключение
+     * останавливает раздачу новых индексов и пробрасывается наружу после завершения всех потоков.
+     */
+    template<typename Fn>
+    void parallelFor(size_t count, u32 threads, Fn&& fn) {
+        if (count == 0) {
+            return;
+        }
+        threads = static_cast<u32>(std::min<size_t>(std::max<u32>(threads, 1), count));
+        if (threads == 1) {
+            for (size_t i = 0; i < count; ++i) {
+                fn(i);
+            }
+            return;
+        }
+
+        std::atomic<size_t> nextIndex{0};
+        std::exception_ptr error;
+        std::mutex errorMutex;
+
+        auto worker = [&] {
+            for (size_t i = nextIndex.fetch_add(1); i < count; i = nextIndex.fetch_add(1)) {
+                try {
+                    fn(i);
+                } catch (...) {
+                    std::lock_guard lock(errorMutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                    nextIndex.store(count);
+                }
+            }
+        };
+
+        {
+            std::vector<std::jthread> pool;
+            pool.reserve(threads - 1);
+            for (u32 t = 1; t < threads; ++t) {
+                pool.emplace_back(worker);
+            }
+            worker();
+        } // jthread присоединяется в деструкторе
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef SPSCRING_HPP
+#define SPSCRING_HPP
+
+#include <atomic>
+#include <bit>
+#include <vector>
+
+namespace Concurrency {
+
+    /**
+     * @brief Кольцевой буфер без блокировок для одного производителя и одного потребителя.
+     *
+     * Ёмкость округляется вверх до степени двойки. Индексы растут монотонно, слот выбирается
+     * маской. Каждая сторона кэширует чужой индекс и перечитывает его только тогда, когда
+     * кэш говорит, что буфер полон (или пуст), так что в обычном случае push и pop
+     * не трогают кэш-линию другой стороны.
+     */
+    template<typename T>
+    class SpscRing {
+        std::vector<T> _slots;
+        size_t _mask;
+
+        alignas(64) std::atomic<size_t> _head{0}; // следующий слот для записи, пишет производитель
+        size_t _cachedTail = 0;                   // последнее виденное производителем значение _tail
+        alignas(64) std::atomic<size_t> _tail{0}; // следующий слот для чтения, пишет потребитель
+        size_t _cachedHead = 0;                   // последнее виденное потребителем значение _head
+
+    public:
+        explicit SpscRing(size_t capacity)
+            : _slots(std::bit_ceil(std::max<size_t>(capacity, 2))), _mask(_slots.size() - 1) {}
+
+        SpscRing(const SpscRing&) = delete;
+        SpscRing& operator=(const SpscRing&) = delete;
+
+        [[nodiscard]] size_t capacity() const { return _slots.size(); }
+
+        /**
+         * @brief Только для производителя.
+         * @return false, если буфер полон; value тогда не тронут.
+         */
+        bool tryPush(T&& value) {
+            const size_t head = _head.load(std::memory_order_relaxed);
+            if (head - _cachedTail == _slots.size()) {
+                _cachedTail = _tail.load(std::memory_order_acquire);
+                if (head - _cachedTail == _slots.size()) {
+                    return false;
+                }
+            }
+            _slots[head & _mask] = std::move(value);
+            _head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Только для потребителя: передаёт в fn (T&) до max элементов по порядку.
+         * @return Сколько элементов забрано.
+         */
+        template<typename Fn>
+        size_t drain(Fn&& fn, size_t max = static_cast<size_t>(-1)) {
+            size_t tail = _tail.load(std::memory_order_relaxed);
+            if (tail == _cachedHead) {
+                _cachedHead = _head.load(std::memory_order_acquire);
+            }
+            size_t taken = 0;
+            while (tail != _cachedHead && taken < max) {
+                fn(_slots[tail & _mask]);
+                ++tail;
+                ++taken;
+            }
+            _tail.store(tail, std::memory_order_release);
+            return taken;
+        }
+
+        // приблизительно: точна только для вызывающей стороны
+        [[nodiscard]] bool empty() const {
+            return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+        }
+    };
+}
+
+#endif
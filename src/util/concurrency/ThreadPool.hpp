@@ -0,0 +1,120 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../logging.hpp"
+#include "../types/types.hpp"
+
+namespace Concurrency {
+
+    /**
+     * @brief Фиксированный набор рабочих потоков с общей очередью задач.
+     *
+     * Исключение из задачи логируется и не роняет поток. Деструктор дожидается выполнения
+     * всех уже поставленных задач, поэтому пул стоит объявлять последним членом класса,
+     * чьи поля используют задачи.
+     */
+    class ThreadPool {
+        std::vector<std::jthread> _threads;
+        std::deque<std::function<void()>> _queue;
+        mutable std::mutex _mutex;
+        std::condition_variable _cv;
+        bool _stopping = false;
+        std::atomic<size_t> _active{0};
+        std::atomic<u64> _completed{0};
+
+    public:
+        explicit ThreadPool(u32 threads) {
+            _threads.reserve(threads);
+            for (u32 i = 0; i < std::max<u32>(threads, 1); ++i) {
+                _threads.emplace_back([this] { workerLoop(); });
+            }
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard lock(_mutex);
+                _stopping = true;
+            }
+            _cv.notify_all();
+            _threads.clear(); // jthread присоединяется в деструкторе
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        void submit(std::function<void()> task) {
+            {
+                std::lock_guard lock(_mutex);
+                _queue.push_back(std::move(task));
+            }
+            _cv.notify_one();
+        }
+
+        /**
+         * @brief Ставит задачу, только если в очереди меньше maxQueueDepth задач.
+         * @return false, если очередь заполнена и задача не принята.
+         */
+        bool trySubmit(std::function<void()> task, size_t maxQueueDepth) {
+            {
+                std::lock_guard lock(_mutex);
+                if (_queue.size() >= maxQueueDepth) {
+                    return false;
+                }
+                _queue.push_back(std::move(task));
+            }
+            _cv.notify_one();
+            return true;
+        }
+
+        /**
+         * @brief Сколько задач ждёт свободного потока.
+         */
+        [[nodiscard]] size_t queueDepth() const {
+            std::lock_guard lock(_mutex);
+            return _queue.size();
+        }
+
+        [[nodiscard]] size_t threadCount() const { return _threads.size(); }
+
+        // сколько задач выполняется прямо сейчас и сколько завершено за всё время
+        [[nodiscard]] size_t activeCount() const { return _active.load(std::memory_order_relaxed); }
+        [[nodiscard]] u64 completedCount() const { return _completed.load(std::memory_order_relaxed); }
+
+    private:
+        void workerLoop() {
+            for (;;) {
+                std::function<void()> task;
+                {
+                    std::unique_lock lock(_mutex);
+                    _cv.wait(lock, [this] { return _stopping || !_queue.empty(); });
+                    if (_queue.empty()) {
+                        return; // _stopping и задач больше нет
+                    }
+                    task = std::move(_queue.front());
+                    _queue.pop_front();
+                }
+
+                _active.fetch_add(1, std::memory_order_relaxed);
+                try {
+                    task();
+                } catch (const std::exception& e) {
+                    Log::Logger().error("Unhandled exception in worker thread: {}", e.what());
+                } catch (...) {
+                    Log::Logger().error("Unhandled unknown exception in worker thread");
+                }
+                _active.fetch_sub(1, std::memory_order_relaxed);
+                _completed.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    };
+}
+
+#endif
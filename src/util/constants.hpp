@@ -1,6 +1,9 @@
 
 #ifndef CONSTANTS_HPP
 #define CONSTANTS_HPP
+#include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <string>
 
 namespace FRAMEWORK_CONSTANTS {
@@ -14,10 +17,64 @@ namespace FRAMEWORK_CONSTANTS {
         LOG_DEBUG    // Детальная отладочная информация
     };
 
+    // что делает поток, когда его кольцо записей лога заполнено
+    enum class LogOverflowPolicy {
+        DROP, // запись теряется и учитывается в счётчике потерянных
+        BLOCK // поток ждёт, пока фоновый писатель освободит место
+    };
+
+    // уровни выше compileTimeLogLevel не компилируются вовсе, выше runtimeLogLevel - отбрасываются до форматирования
     constexpr LogLevel compileTimeLogLevel = LogLevel::LOG_DEBUG;
-    constexpr LogLevel runtimeLogLevel = compileTimeLogLevel;
+    inline std::atomic<LogLevel> runtimeLogLevel{compileTimeLogLevel};
+
+    // записи лога пишет фоновый поток; false - каждый вызов печатает сам, как раньше
+    inline std::atomic<bool> asyncLogging{true};
+    inline std::atomic<LogOverflowPolicy> logOverflowPolicy{LogOverflowPolicy::DROP};
+    // записей в кольце каждого потока; читается при первой записи потока
+    inline size_t logRingCapacity = 1024;
 
     inline std::string datasetsDirectory = "datasets";
+
+    // сколько кучи могут занимать колонки загруженных датасетов, прежде чем давно не использованные начнут вытесняться на диск
+    inline size_t datasetMemoryBudgetBytes = size_t{4} << 30;
+    // куда вытесняются датасеты; не внутри datasetsDirectory, чтобы файлы вытеснения не попадали в список доступных
+    inline std::string spillDirectory = "spill";
+
+    // наибольший размер страницы датасета в строках: страница файлового датасета или выборки строк
+    // собирается в памяти целиком, поэтому размер запроса не может быть произвольным
+    inline unsigned maxPageSize = 10000;
+
+    // сколько памяти занимают готовые тела страниц в кэше ответов; страница больше 1/16 этого объёма не кэшируется
+    inline size_t pageCacheBytes = size_t{256} << 20;
+
+    // сколько памяти занимает кэш статистики колонок; статистика одного датасета - сотни байт на колонку
+    inline size_t statsCacheBytes = size_t{16} << 20;
+    // интервалов гистограммы колонки по умолчанию и наибольшее число, которое можно запросить
+    inline unsigned defaultHistogramBins = 20;
+    inline unsigned maxHistogramBins = 1000;
+
+    // потоки пула вычислений, в котором выполняются тяжёлые обработчики (RouteExecution::compute)
+    inline unsigned computeThreads = 4;
+    // сколько тяжёлых запросов может ждать свободного потока; сверх этого сервер отвечает 503
+    inline size_t computeQueueLimit = 64;
+
+    // keep-alive соединение без запросов закрывается через httpIdleTimeout
+    inline std::chrono::seconds httpIdleTimeout{60};
+    // начатый запрос должен прийти целиком, а ответ - уйти целиком (для потоковых - каждая порция) за эти сроки
+    inline std::chrono::seconds httpReadTimeout{30};
+    inline std::chrono::seconds httpWriteTimeout{30};
+    // после стольких запросов соединение закрывается с Connection: close
+    inline size_t maxRequestsPerConnection = 1000;
+    // сколько присланных подряд запросов одного соединения обрабатываются одновременно, не дожидаясь ответов
+    inline size_t maxPipelinedRequests = 16;
+    // заголовок и тело запроса; вместе они ограничивают и буфер чтения соединения
+    inline size_t maxRequestHeaderBytes = size_t{8} << 10;
+    inline size_t maxRequestBodyBytes = size_t{1} << 20;
+
+    // как часто долгая задача публикует промежуточный прогресс подписчикам WebSocket
+    inline std::chrono::milliseconds progressPublishInterval{100};
+    // сообщения клиента WebSocket - только команды подписки
+    inline size_t maxWebSocketMessageBytes = size_t{4} << 10;
 }
 
 #endif
\ No newline at end of file
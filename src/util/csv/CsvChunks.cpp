@@ -0,0 +1,68 @@
+#include "CsvChunks.hpp"
+
+#include <algorithm>
+
+#include "CsvTokenizer.hpp"
+#include "../concurrency/Parallel.hpp"
+
+namespace {
+    constexpr size_t realignWindowSize = 64 * 1024;
+    constexpr size_t minChunkBytes = 4 << 20;
+
+    // первая позиция после перевода строки вне кавычек, начиная с from; data.size(), если такой нет
+    size_t findRecordStart(std::string_view data, size_t from, bool inQuotes, char delimiter) {
+        CsvTokenizer tokenizer(delimiter);
+        tokenizer.setInQuotes(inQuotes);
+        std::vector<u64> separators;
+
+        for (size_t position = from; position < data.size(); position += realignWindowSize) {
+            const size_t windowEnd = std::min(data.size(), position + realignWindowSize);
+            separators.clear();
+            tokenizer.scan(data, position, windowEnd, separators);
+            for (const u64 separator : separators) {
+                if (data[separator] == '\n') {
+                    return separator + 1;
+                }
+            }
+        }
+        return data.size();
+    }
+}
+
+size_t csvChunkCount(size_t bytes, u32 threads) {
+    return std::clamp<size_t>(bytes / minChunkBytes, 1, std::max<u32>(threads, 1));
+}
+
+std::vector<CsvChunk> splitCsvIntoChunks(std::string_view data, size_t begin, size_t chunkCount, char delimiter, u32 threads) {
+    const size_t end = data.size();
+    if (chunkCount <= 1 || begin >= end) {
+        return {{begin, end}};
+    }
+
+    const size_t length = end - begin;
+    std::vector<size_t> cuts(chunkCount + 1);
+    for (size_t i = 0; i <= chunkCount; ++i) {
+        cuts[i] = begin + length * i / chunkCount;
+    }
+
+    std::vector<size_t> quoteCounts(chunkCount);
+    Concurrency::parallelFor(chunkCount, threads, [&](size_t i) {
+        quoteCounts[i] = CsvTokenizer::countQuotes(data, cuts[i], cuts[i + 1]);
+    });
+
+    std::vector<CsvChunk> chunks;
+    chunks.reserve(chunkCount);
+    size_t chunkBegin = begin;
+    bool inQuotes = false;
+    for (size_t i = 1; i < chunkCount; ++i) {
+        inQuotes ^= (quoteCounts[i - 1] & 1) != 0;
+        const size_t recordStart = findRecordStart(data, cuts[i], inQuotes, delimiter);
+        // длинная запись может перекрыть несколько точек разреза - такие куски схлопываются
+        if (recordStart > chunkBegin && recordStart < end) {
+            chunks.push_back({chunkBegin, recordStart});
+            chunkBegin = recordStart;
+        }
+    }
+    chunks.push_back({chunkBegin, end});
+    return chunks;
+}
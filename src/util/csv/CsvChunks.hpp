@@ -0,0 +1,36 @@
+#ifndef CSVCHUNKS_HPP
+#define CSVCHUNKS_HPP
+
+#include <string_view>
+#include <vector>
+
+#include "../types/types.hpp"
+
+/**
+ * @brief Кусок CSV-буфера [begin, end), который начинается и заканчивается на границе записи.
+ */
+struct CsvChunk {
+    size_t begin;
+    size_t end;
+};
+
+/**
+ * @brief Сколько кусков имеет смысл делать для буфера размером bytes: не больше threads
+ * и не мельче 4 МиБ на кусок, чтобы запуск потоков и склейка не съели выигрыш.
+ */
+size_t csvChunkCount(size_t bytes, u32 threads);
+
+/**
+ * @brief Делит data[begin, data.size()) на куски для параллельного разбора.
+ *
+ * Сначала буфер режется на равные по байтам части и в каждой (параллельно) считаются кавычки:
+ * чётность суммы кавычек до точки разреза говорит, находится ли она внутри кавычек. Затем каждая
+ * точка сдвигается вперёд до первого перевода строки вне кавычек. Так границы попадают ровно
+ * на начала записей, даже если в ячейках есть переводы строк.
+ *
+ * @param chunkCount Желаемое количество кусков; кусков может получиться меньше.
+ * @param threads Сколько потоков использовать для подсчёта кавычек.
+ */
+std::vector<CsvChunk> splitCsvIntoChunks(std::string_view data, size_t begin, size_t chunkCount, char delimiter, u32 threads);
+
+#endif
@@ -0,0 +1,112 @@
+#include "CsvReader.hpp"
+
+#include <algorithm>
+
+namespace {
+    constexpr size_t scanWindowSize = 1 << 20;
+}
+
+CsvReader::CsvReader(std::string_view data, char delimiter)
+    : _data(data), _tokenizer(delimiter) {
+}
+
+size_t CsvReader::nextSeparator() {
+    while (_separatorIndex == _separators.size()) {
+        if (_scannedUpTo >= _data.size()) {
+            return std::string_view::npos;
+        }
+        _separators.clear();
+        _separatorIndex = 0;
+        const size_t windowEnd = std::min(_data.size(), _scannedUpTo + scanWindowSize);
+        _tokenizer.scan(_data, _scannedUpTo, windowEnd, _separators);
+        _scannedUpTo = windowEnd;
+    }
+    return _separators[_separatorIndex++];
+}
+
+bool CsvReader::next(std::vector<std::string_view>& cells) {
+    cells.clear();
+
+    while (_position < _data.size()) {
+        _rawCells.clear();
+
+        const size_t recordStart = _position;
+        size_t cellStart = _position;
+        size_t recordEnd = _data.size();
+
+        // набираем ячейки до перевода строки вне кавычек или до конца данных
+        for (size_t separator = nextSeparator(); separator != std::string_view::npos; separator = nextSeparator()) {
+            if (_data[separator] == '\n') {
+                recordEnd = separator;
+                break;
+            }
+            _rawCells.push_back({cellStart, separator});
+            cellStart = separator + 1;
+        }
+
+        // убираем возможный символ возврата каретки
+        size_t cellEnd = recordEnd;
+        if (cellEnd > cellStart && _data[cellEnd - 1] == '\r') {
+            --cellEnd;
+        }
+        _rawCells.push_back({cellStart, cellEnd});
+        _position = recordEnd < _data.size() ? recordEnd + 1 : recordEnd;
+
+        // пустая строка
+        if (_rawCells.size() == 1 && cellStart == cellEnd) {
+            continue;
+        }
+
+        // разэкранированная ячейка не длиннее сырой, поэтому резерва под всю запись хватит
+        // и арена не переаллоцируется, пока на неё смотрят уже выданные view
+        _arena.clear();
+        _arena.reserve(_position - recordStart);
+
+        cells.reserve(_rawCells.size());
+        for (const auto& raw : _rawCells) {
+            cells.push_back(unescape(raw));
+        }
+        return true;
+    }
+
+    return false;
+}
+
+std::string_view CsvReader::unescape(const RawCell& cell) {
+    const std::string_view text = _data.substr(cell.begin, cell.end - cell.begin);
+    if (text.find('"') == std::string_view::npos) {
+        return text;
+    }
+
+    // быстрый путь: значение целиком в кавычках и без экранирования внутри
+    if (text.size() >= 2 && text.front() == '"' && text.back() == '"') {
+        const std::string_view inner = text.substr(1, text.size() - 2);
+        if (inner.find('"') == std::string_view::npos) {
+            return inner;
+        }
+    }
+
+    const size_t start = _arena.size();
+    bool inQuotes = false;
+    for (size_t i = 0; i < text.size(); ++i) {
+        const char c = text[i];
+        if (inQuotes) {
+            if (c == '"') {
+                // проверяем, это экранированная кавычка или конец поля
+                if (i + 1 < text.size() && text[i + 1] == '"') {
+                    _arena += '"';
+                    ++i;
+                } else {
+                    inQuotes = false;
+                }
+            } else {
+                _arena += c;
+            }
+        } else if (c == '"') {
+            inQuotes = true;
+        } else {
+            _arena += c;
+        }
+    }
+    return std::string_view(_arena).substr(start);
+}
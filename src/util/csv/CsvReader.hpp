@@ -0,0 +1,61 @@
+#ifndef CSVREADER_HPP
+#define CSVREADER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CsvTokenizer.hpp"
+#include "../types/types.hpp"
+
+/**
+ * @brief Потоковый разбор CSV поверх непрерывного буфера (обычно отображённого файла).
+ *
+ * Ячейки возвращаются как std::string_view прямо в исходный буфер. Копируются только
+ * ячейки, которые нужно разэкранировать ("" внутри кавычек) - они собираются в общий
+ * буфер-арену записи. Все view из next() живут до следующего вызова next().
+ *
+ * Границы ячеек ищет CsvTokenizer окнами по 1 МиБ. Поддерживаются кавычки с разделителями
+ * и переводами строк внутри, "\r\n" на концах строк; пустые строки пропускаются.
+ */
+class CsvReader {
+public:
+    explicit CsvReader(std::string_view data, char delimiter = ',');
+
+    /**
+     * @brief Разбирает следующую запись.
+     * @param cells Сюда складываются ячейки записи (вектор очищается).
+     * @return false, если данные закончились.
+     */
+    bool next(std::vector<std::string_view>& cells);
+
+    /**
+     * @brief Сколько байт буфера уже разобрано.
+     */
+    [[nodiscard]] size_t position() const { return _position; }
+
+private:
+    // сырые границы ячейки в буфере до снятия кавычек
+    struct RawCell {
+        size_t begin;
+        size_t end;
+    };
+
+    // позиция следующего разделителя или перевода строки вне кавычек, npos - если их больше нет
+    size_t nextSeparator();
+    std::string_view unescape(const RawCell& cell);
+
+    std::string_view _data;
+    CsvTokenizer _tokenizer;
+    size_t _position = 0;
+
+    // структурный индекс текущего окна
+    std::vector<u64> _separators{};
+    size_t _separatorIndex = 0;
+    size_t _scannedUpTo = 0;
+
+    std::vector<RawCell> _rawCells{};
+    std::string _arena{};
+};
+
+#endif
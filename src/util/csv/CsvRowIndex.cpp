@@ -0,0 +1,72 @@
+#include "CsvRowIndex.hpp"
+
+#include <algorithm>
+
+#include "CsvTokenizer.hpp"
+
+namespace {
+    constexpr size_t scanWindowSize = 1 << 20;
+
+    // CsvReader пропускает пустые строки и строки из одного '\r', здесь они тоже не считаются записями
+    bool isRecord(std::string_view data, size_t lineBegin, size_t lineEnd) {
+        const size_t length = lineEnd - lineBegin;
+        return length > 1 || (length == 1 && data[lineBegin] != '\r');
+    }
+}
+
+CsvRowIndex CsvRowIndex::build(std::string_view data, size_t begin, char delimiter, const ProgressCallback& onProgress) {
+    CsvRowIndex index;
+    index._end = data.size();
+
+    CsvTokenizer tokenizer(delimiter);
+    std::vector<u64> newlines;
+    size_t lineBegin = begin;
+
+    auto addLine = [&](size_t lineEnd) {
+        if (!isRecord(data, lineBegin, lineEnd)) {
+            return;
+        }
+        if (index._rowCount % rowsPerCheckpoint == 0) {
+            index._checkpoints.push_back(lineBegin);
+        }
+        ++index._rowCount;
+    };
+
+    for (size_t windowBegin = begin; windowBegin < data.size(); windowBegin += scanWindowSize) {
+        const size_t windowEnd = std::min(data.size(), windowBegin + scanWindowSize);
+        newlines.clear();
+        tokenizer.scanNewlines(data, windowBegin, windowEnd, newlines);
+        for (const u64 newline : newlines) {
+            addLine(newline);
+            lineBegin = newline + 1;
+        }
+        if (onProgress) {
+            onProgress(windowEnd, index._rowCount);
+        }
+    }
+
+    // последняя запись без перевода строки в конце
+    if (lineBegin < data.size()) {
+        addLine(data.size());
+    }
+
+    index._checkpoints.shrink_to_fit();
+    return index;
+}
+
+CsvRowIndex::Span CsvRowIndex::span(size_t firstRow, size_t count) const {
+    firstRow = std::min(firstRow, _rowCount);
+    const size_t lastRow = std::min(firstRow + count, _rowCount);
+    if (firstRow == lastRow) {
+        return {_end, _end, 0};
+    }
+
+    const size_t firstCheckpoint = firstRow / rowsPerCheckpoint;
+    // ближайшая контрольная точка после последней нужной записи ограничивает разбор сверху
+    const size_t endCheckpoint = (lastRow + rowsPerCheckpoint - 1) / rowsPerCheckpoint;
+    return {
+        _checkpoints[firstCheckpoint],
+        endCheckpoint < _checkpoints.size() ? _checkpoints[endCheckpoint] : _end,
+        firstRow - firstCheckpoint * rowsPerCheckpoint
+    };
+}
@@ -0,0 +1,63 @@
+#ifndef CSVROWINDEX_HPP
+#define CSVROWINDEX_HPP
+
+#include <functional>
+#include <string_view>
+#include <vector>
+
+#include "../types/types.hpp"
+
+/**
+ * @brief Разреженный индекс смещений записей CSV-буфера.
+ *
+ * Хранит смещение начала каждой rowsPerCheckpoint-й записи, поэтому для файла
+ * из N строк занимает N / 64 * 8 байт. Чтобы прочитать строку k, достаточно начать
+ * разбор с ближайшей контрольной точки и пропустить не больше 63 записей.
+ * Записи считаются так же, как их выдаёт CsvReader: пустые строки не учитываются.
+ */
+class CsvRowIndex {
+public:
+    static constexpr size_t rowsPerCheckpoint = 64;
+
+    /**
+     * @brief Вызывается после каждого просканированного окна.
+     * @param scannedUpTo Абсолютная позиция в буфере, до которой дошёл проход.
+     * @param rowCount Сколько записей найдено к этому моменту.
+     */
+    using ProgressCallback = std::function<void(size_t scannedUpTo, size_t rowCount)>;
+
+    /**
+     * @brief Диапазон буфера, в котором лежат запрошенные записи.
+     * Разбор с begin надо начинать с пропуска skipRows записей.
+     */
+    struct Span {
+        size_t begin;
+        size_t end;
+        size_t skipRows;
+    };
+
+    CsvRowIndex() = default;
+
+    /**
+     * @brief Строит индекс одним последовательным проходом по data[begin, data.size()).
+     * @param begin Начало первой записи данных (обычно сразу после заголовка).
+     */
+    static CsvRowIndex build(std::string_view data, size_t begin, char delimiter = ',', const ProgressCallback& onProgress = {});
+
+    [[nodiscard]] size_t rowCount() const { return _rowCount; }
+
+    /**
+     * @brief Находит диапазон буфера для записей [firstRow, firstRow + count).
+     * Запрос за пределами данных обрезается до rowCount().
+     */
+    [[nodiscard]] Span span(size_t firstRow, size_t count) const;
+
+    [[nodiscard]] size_t memoryBytes() const { return _checkpoints.capacity() * sizeof(u64); }
+
+private:
+    std::vector<u64> _checkpoints{};
+    size_t _rowCount = 0;
+    size_t _end = 0;
+};
+
+#endif
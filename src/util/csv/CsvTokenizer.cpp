@@ -0,0 +1,177 @@
+#include "CsvTokenizer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CSV_TOKENIZER_X86 1
+#include <immintrin.h>
+#else
+#define CSV_TOKENIZER_X86 0
+#endif
+
+namespace {
+    constexpr size_t blockSize = 64;
+    // сколько блоков ядро обрабатывает за один вызов - 4 КиБ, чтобы косвенный вызов не был заметен
+    constexpr size_t blocksPerBatch = 64;
+
+    using MaskKernel = void (*)(const char* data, size_t blockCount, char delimiter, CsvBlockMasks* out);
+
+    [[maybe_unused]] void masksScalar(const char* data, size_t blockCount, char delimiter, CsvBlockMasks* out) {
+        for (size_t b = 0; b < blockCount; ++b) {
+            const char* block = data + b * blockSize;
+            CsvBlockMasks masks{0, 0, 0};
+            for (size_t i = 0; i < blockSize; ++i) {
+                const char c = block[i];
+                masks.quotes |= static_cast<u64>(c == '"') << i;
+                masks.delimiters |= static_cast<u64>(c == delimiter) << i;
+                masks.newlines |= static_cast<u64>(c == '\n') << i;
+            }
+            out[b] = masks;
+        }
+    }
+
+#if CSV_TOKENIZER_X86
+    // SSE2 есть на любом x86-64, отдельный target не нужен
+    void masksSse2(const char* data, size_t blockCount, char delimiter, CsvBlockMasks* out) {
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i delim = _mm_set1_epi8(delimiter);
+        const __m128i newline = _mm_set1_epi8('\n');
+
+        for (size_t b = 0; b < blockCount; ++b) {
+            const char* block = data + b * blockSize;
+            CsvBlockMasks masks{0, 0, 0};
+            for (size_t k = 0; k < blockSize / 16; ++k) {
+                const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + k * 16));
+                const unsigned shift = k * 16;
+                masks.quotes |= static_cast<u64>(static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)))) << shift;
+                masks.delimiters |= static_cast<u64>(static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, delim)))) << shift;
+                masks.newlines |= static_cast<u64>(static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)))) << shift;
+            }
+            out[b] = masks;
+        }
+    }
+
+    __attribute__((target("avx2")))
+    inline u64 movemask64(__m256i low, __m256i high) {
+        return static_cast<u64>(static_cast<u32>(_mm256_movemask_epi8(low)))
+             | static_cast<u64>(static_cast<u32>(_mm256_movemask_epi8(high))) << 32;
+    }
+
+    __attribute__((target("avx2")))
+    void masksAvx2(const char* data, size_t blockCount, char delimiter, CsvBlockMasks* out) {
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i delim = _mm256_set1_epi8(delimiter);
+        const __m256i newline = _mm256_set1_epi8('\n');
+
+        for (size_t b = 0; b < blockCount; ++b) {
+            const char* block = data + b * blockSize;
+            const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+            const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+
+            out[b] = CsvBlockMasks{
+                movemask64(_mm256_cmpeq_epi8(lo, quote), _mm256_cmpeq_epi8(hi, quote)),
+                movemask64(_mm256_cmpeq_epi8(lo, delim), _mm256_cmpeq_epi8(hi, delim)),
+                movemask64(_mm256_cmpeq_epi8(lo, newline), _mm256_cmpeq_epi8(hi, newline))
+            };
+        }
+    }
+#endif
+
+    struct KernelChoice {
+        MaskKernel masks;
+        std::string_view name;
+    };
+
+    const KernelChoice& kernel() {
+        static const KernelChoice choice = [] {
+#if CSV_TOKENIZER_X86
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) {
+                return KernelChoice{masksAvx2, "avx2"};
+            }
+            return KernelChoice{masksSse2, "sse2"};
+#else
+            return KernelChoice{masksScalar, "scalar"};
+#endif
+        }();
+        return choice;
+    }
+
+    // бит i результата - XOR битов 0..i: единицы между открывающей и закрывающей кавычкой
+    u64 prefixXor(u64 bits) {
+        bits ^= bits << 1;
+        bits ^= bits << 2;
+        bits ^= bits << 4;
+        bits ^= bits << 8;
+        bits ^= bits << 16;
+        bits ^= bits << 32;
+        return bits;
+    }
+
+    // прогоняет ядро по data[begin, end) и вызывает onBlock(masks, blockStart, validBits) для каждого блока;
+    // хвост короче 64 байт копируется в буфер с нулями, чтобы не читать за концом данных
+    template<typename OnBlock>
+    void forEachBlock(std::string_view data, size_t begin, size_t end, char delimiter, OnBlock&& onBlock) {
+        const MaskKernel masksOf = kernel().masks;
+        CsvBlockMasks masks[blocksPerBatch];
+
+        size_t position = begin;
+        while (end - position >= blockSize) {
+            const size_t blocks = std::min((end - position) / blockSize, blocksPerBatch);
+            masksOf(data.data() + position, blocks, delimiter, masks);
+            for (size_t b = 0; b < blocks; ++b) {
+                onBlock(masks[b], position + b * blockSize, ~u64{0});
+            }
+            position += blocks * blockSize;
+        }
+
+        if (position < end) {
+            const size_t tail = end - position;
+            alignas(64) char padded[blockSize] = {};
+            std::memcpy(padded, data.data() + position, tail);
+            masksOf(padded, 1, delimiter, masks);
+            onBlock(masks[0], position, (u64{1} << tail) - 1);
+        }
+    }
+}
+
+CsvTokenizer::CsvTokenizer(char delimiter)
+    : _delimiter(delimiter) {
+}
+
+template<bool NewlinesOnly>
+void CsvTokenizer::scanStructural(std::string_view data, size_t begin, size_t end, std::vector<u64>& positions) {
+    forEachBlock(data, begin, end, _delimiter, [&](const CsvBlockMasks& masks, size_t blockStart, u64 validBits) {
+        const u64 quoted = prefixXor(masks.quotes & validBits) ^ (_inQuotes ? ~u64{0} : 0);
+        _inQuotes = quoted >> 63;
+
+        const u64 candidates = NewlinesOnly ? masks.newlines : masks.delimiters | masks.newlines;
+        u64 structural = candidates & ~quoted & validBits;
+        while (structural != 0) {
+            positions.push_back(blockStart + std::countr_zero(structural));
+            structural &= structural - 1;
+        }
+    });
+}
+
+void CsvTokenizer::scan(std::string_view data, size_t begin, size_t end, std::vector<u64>& separators) {
+    scanStructural<false>(data, begin, end, separators);
+}
+
+void CsvTokenizer::scanNewlines(std::string_view data, size_t begin, size_t end, std::vector<u64>& newlines) {
+    scanStructural<true>(data, begin, end, newlines);
+}
+
+size_t CsvTokenizer::countQuotes(std::string_view data, size_t begin, size_t end) {
+    size_t count = 0;
+    forEachBlock(data, begin, end, ',', [&](const CsvBlockMasks& masks, size_t, u64 validBits) {
+        count += std::popcount(masks.quotes & validBits);
+    });
+    return count;
+}
+
+std::string_view CsvTokenizer::kernelName() {
+    return kernel().name;
+}
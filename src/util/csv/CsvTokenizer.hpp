@@ -0,0 +1,66 @@
+#ifndef CSVTOKENIZER_HPP
+#define CSVTOKENIZER_HPP
+
+#include <string_view>
+#include <vector>
+
+#include "../types/types.hpp"
+
+/**
+ * @brief Битовые маски одного 64-байтного блока: бит i соответствует байту i блока.
+ */
+struct CsvBlockMasks {
+    u64 quotes;
+    u64 delimiters;
+    u64 newlines;
+};
+
+/**
+ * @brief Векторный поиск структурных символов CSV.
+ *
+ * Входные данные просматриваются блоками по 64 байта: SIMD-ядро строит маски кавычек,
+ * разделителей и переводов строк, затем префиксный XOR по маске кавычек даёт маску
+ * "внутри кавычек", и из разделителей вне кавычек извлекаются позиции через countr_zero.
+ * Ядро (AVX2, SSE2 или скалярное) выбирается один раз при старте по CPUID.
+ */
+class CsvTokenizer {
+public:
+    explicit CsvTokenizer(char delimiter = ',');
+
+    /**
+     * @brief Находит в data[begin, end) разделители и переводы строк вне кавычек.
+     *
+     * Состояние "внутри кавычек" переносится между вызовами, так что файл можно
+     * сканировать последовательными окнами.
+     * @param separators Сюда дописываются абсолютные позиции найденных символов (по возрастанию).
+     */
+    void scan(std::string_view data, size_t begin, size_t end, std::vector<u64>& separators);
+
+    /**
+     * @brief То же, что scan, но ищет только переводы строк вне кавычек, то есть концы записей.
+     */
+    void scanNewlines(std::string_view data, size_t begin, size_t end, std::vector<u64>& newlines);
+
+    [[nodiscard]] bool inQuotes() const { return _inQuotes; }
+    void setInQuotes(bool inQuotes) { _inQuotes = inQuotes; }
+
+    /**
+     * @brief Количество кавычек в data[begin, end). Нужен для определения состояния кавычек
+     * на границе куска файла без его полного разбора.
+     */
+    static size_t countQuotes(std::string_view data, size_t begin, size_t end);
+
+    /**
+     * @brief Имя выбранного ядра, для логов.
+     */
+    static std::string_view kernelName();
+
+private:
+    template<bool NewlinesOnly>
+    void scanStructural(std::string_view data, size_t begin, size_t end, std::vector<u64>& positions);
+
+    char _delimiter;
+    bool _inQuotes = false;
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef HYPERLOGLOG_HPP
+#define HYPERLOGLOG_HPP
+
+#include <array>
+#include <bit>
+#include <cmath>
+
+#include "../types/types.hpp"
+
+/**
+ * @brief Перемешивание 64-битного ключа (финализатор splitmix64): дешевле xxHash64 для
+ * одного машинного слова, а младшие и старшие биты результата одинаково случайны.
+ */
+inline u64 mixHash64(u64 key) {
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return key;
+}
+
+/**
+ * @brief Оценка числа различных значений по их хэшам (HyperLogLog, 2^12 регистров).
+ *
+ * Занимает 4 КБ при любом числе значений, относительная погрешность около 1.6%.
+ * Оценки, собранные по кускам в разных потоках, объединяются через merge без потерь точности.
+ */
+class HyperLogLog {
+    static constexpr u32 precision = 12;
+    static constexpr size_t registerCount = size_t{1} << precision;
+
+    std::array<u8, registerCount> _registers{};
+
+public:
+    void add(u64 hash) {
+        const size_t index = hash >> (64 - precision);
+        // сторожевой бит ограничивает ранг, если все оставшиеся биты нулевые
+        const u64 rest = (hash << precision) | (u64{1} << (precision - 1));
+        const u8 rank = static_cast<u8>(std::countl_zero(rest) + 1);
+        if (rank > _registers[index]) {
+            _registers[index] = rank;
+        }
+    }
+
+    void merge(const HyperLogLog& other) {
+        for (size_t i = 0; i < registerCount; ++i) {
+            if (other._registers[i] > _registers[i]) {
+                _registers[i] = other._registers[i];
+            }
+        }
+    }
+
+    [[nodiscard]] u64 estimate() const {
+        constexpr f64 m = registerCount;
+        f64 sum = 0;
+        size_t zeros = 0;
+        for (const u8 value : _registers) {
+            sum += std::ldexp(1.0, -value);
+            zeros += value == 0;
+        }
+        const f64 raw = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+        // на малых количествах сырая оценка смещена, там точнее линейный подсчёт пустых регистров
+        if (raw <= 2.5 * m && zeros > 0) {
+            return static_cast<u64>(std::llround(m * std::log(m / static_cast<f64>(zeros))));
+        }
+        return static_cast<u64>(std::llround(raw));
+    }
+};
+
+#endif
@@ -0,0 +1,90 @@
+#include "XxHash64.hpp"
+
+#include <bit>
+#include <cstring>
+
+namespace {
+    constexpr u64 prime1 = 0x9E3779B185EBCA87ULL;
+    constexpr u64 prime2 = 0xC2B2AE3D27D4EB4FULL;
+    constexpr u64 prime3 = 0x165667B19E3779F9ULL;
+    constexpr u64 prime4 = 0x85EBCA77C2B2AE63ULL;
+    constexpr u64 prime5 = 0x27D4EB2F165667C5ULL;
+
+    // читаем без требований к выравниванию; формат предполагает little-endian
+    u64 read64(const unsigned char* p) {
+        u64 value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    u32 read32(const unsigned char* p) {
+        u32 value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    u64 round(u64 accumulator, u64 input) {
+        accumulator += input * prime2;
+        accumulator = std::rotl(accumulator, 31);
+        return accumulator * prime1;
+    }
+
+    u64 mergeRound(u64 accumulator, u64 value) {
+        accumulator ^= round(0, value);
+        return accumulator * prime1 + prime4;
+    }
+}
+
+u64 xxHash64(const void* data, size_t size, u64 seed) {
+    static_assert(std::endian::native == std::endian::little, "xxHash64 expects a little-endian platform");
+
+    const auto* p = static_cast<const unsigned char*>(data);
+    const unsigned char* const end = p + size;
+    u64 hash;
+
+    if (size >= 32) {
+        u64 v1 = seed + prime1 + prime2;
+        u64 v2 = seed + prime2;
+        u64 v3 = seed;
+        u64 v4 = seed - prime1;
+        const unsigned char* const limit = end - 32;
+        do {
+            v1 = round(v1, read64(p));
+            v2 = round(v2, read64(p + 8));
+            v3 = round(v3, read64(p + 16));
+            v4 = round(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        hash = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+        hash = mergeRound(hash, v1);
+        hash = mergeRound(hash, v2);
+        hash = mergeRound(hash, v3);
+        hash = mergeRound(hash, v4);
+    } else {
+        hash = seed + prime5;
+    }
+
+    hash += static_cast<u64>(size);
+
+    for (; p + 8 <= end; p += 8) {
+        hash ^= round(0, read64(p));
+        hash = std::rotl(hash, 27) * prime1 + prime4;
+    }
+    if (p + 4 <= end) {
+        hash ^= static_cast<u64>(read32(p)) * prime1;
+        hash = std::rotl(hash, 23) * prime2 + prime3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        hash ^= static_cast<u64>(*p) * prime5;
+        hash = std::rotl(hash, 11) * prime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    hash *= prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
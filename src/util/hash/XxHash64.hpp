@@ -0,0 +1,16 @@
+#ifndef XXHASH64_HPP
+#define XXHASH64_HPP
+
+#include <cstddef>
+
+#include "../types/types.hpp"
+
+/**
+ * @brief 64-битный некриптографический хэш XXH64.
+ *
+ * Четыре независимые полосы по 8 байт дают несколько ГБ/с на ядро, поэтому хэш годится
+ * для контрольных сумм больших буферов. Результат совпадает с эталонной реализацией xxHash.
+ */
+u64 xxHash64(const void* data, size_t size, u64 seed = 0);
+
+#endif
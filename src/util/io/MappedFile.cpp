@@ -0,0 +1,154 @@
+#include "MappedFile.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& filePath, AccessPattern pattern) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              pattern == AccessPattern::SEQUENTIAL ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Could not open file: " + filePath);
+    }
+    _fileHandle = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        release();
+        throw std::runtime_error("Could not stat file: " + filePath);
+    }
+    _size = static_cast<size_t>(fileSize.QuadPart);
+    if (_size == 0) {
+        return; // пустой файл отобразить нельзя, да и незачем
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        release();
+        throw std::runtime_error("Could not map file: " + filePath);
+    }
+    _mappingHandle = mapping;
+
+    _data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (_data == nullptr) {
+        release();
+        throw std::runtime_error("Could not map file: " + filePath);
+    }
+#else
+    _fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (_fd < 0) {
+        throw std::runtime_error("Could not open file: " + filePath);
+    }
+
+    struct stat st{};
+    if (::fstat(_fd, &st) != 0) {
+        release();
+        throw std::runtime_error("Could not stat file: " + filePath);
+    }
+    _size = static_cast<size_t>(st.st_size);
+    if (_size == 0) {
+        return; // пустой файл отобразить нельзя, да и незачем
+    }
+
+    void* address = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+    if (address == MAP_FAILED) {
+        _size = 0;
+        release();
+        throw std::runtime_error("Could not map file: " + filePath);
+    }
+    _data = static_cast<const char*>(address);
+
+    advise(pattern);
+#endif
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : _data(std::exchange(other._data, nullptr)),
+      _size(std::exchange(other._size, 0)),
+#ifdef _WIN32
+      _fileHandle(std::exchange(other._fileHandle, nullptr)),
+      _mappingHandle(std::exchange(other._mappingHandle, nullptr))
+#else
+      _fd(std::exchange(other._fd, -1))
+#endif
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        _data = std::exchange(other._data, nullptr);
+        _size = std::exchange(other._size, 0);
+#ifdef _WIN32
+        _fileHandle = std::exchange(other._fileHandle, nullptr);
+        _mappingHandle = std::exchange(other._mappingHandle, nullptr);
+#else
+        _fd = std::exchange(other._fd, -1);
+#endif
+    }
+    return *this;
+}
+
+void MappedFile::advise(AccessPattern pattern) const {
+#ifndef _WIN32
+    if (_data == nullptr) {
+        return;
+    }
+    // подсказки не обязательны для корректности, ошибки игнорируем
+    const bool sequential = pattern == AccessPattern::SEQUENTIAL;
+    ::madvise(const_cast<char*>(_data), _size, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+    ::posix_fadvise(_fd, 0, 0, sequential ? POSIX_FADV_SEQUENTIAL : POSIX_FADV_RANDOM);
+#else
+    (void)pattern; // на Windows подсказка задаётся флагами CreateFile при открытии
+#endif
+}
+
+void MappedFile::dropPages(size_t offset, size_t length) const {
+#ifndef _WIN32
+    if (_data == nullptr || offset >= _size) {
+        return;
+    }
+    // madvise работает с целыми страницами: начало выравниваем вверх, чтобы не задеть соседние данные
+    const size_t pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    const size_t begin = (offset + pageSize - 1) / pageSize * pageSize;
+    const size_t end = std::min(offset + length, _size) / pageSize * pageSize;
+    if (begin >= end) {
+        return;
+    }
+    ::madvise(const_cast<char*>(_data) + begin, end - begin, MADV_DONTNEED);
+#else
+    (void)offset;
+    (void)length; // на Windows страницы отображения вытесняет сам менеджер памяти
+#endif
+}
+
+void MappedFile::release() noexcept {
+#ifdef _WIN32
+    if (_data != nullptr) UnmapViewOfFile(_data);
+    if (_mappingHandle != nullptr) CloseHandle(_mappingHandle);
+    if (_fileHandle != nullptr) CloseHandle(_fileHandle);
+    _mappingHandle = nullptr;
+    _fileHandle = nullptr;
+#else
+    if (_data != nullptr) ::munmap(const_cast<char*>(_data), _size);
+    if (_fd >= 0) ::close(_fd);
+    _fd = -1;
+#endif
+    _data = nullptr;
+    _size = 0;
+}
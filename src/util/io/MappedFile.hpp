@@ -0,0 +1,69 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <string>
+#include <string_view>
+
+#include "../types/types.hpp"
+
+/**
+ * @brief Файл, отображённый в память только для чтения (RAII).
+ *
+ * Данные не копируются: view() смотрит прямо в страничный кэш ОС.
+ * Объект только перемещаемый, отображение снимается в деструкторе.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Подсказка ядру о том, как будут читаться страницы.
+     */
+    enum class AccessPattern {
+        SEQUENTIAL, // один проход от начала до конца - включает агрессивное упреждающее чтение
+        RANDOM      // точечные обращения - упреждающее чтение только мешает
+    };
+
+    /**
+     * @param filePath Путь к файлу.
+     * @param pattern Ожидаемый характер чтения, передаётся в madvise/posix_fadvise.
+     * @throws std::runtime_error если файл не удалось открыть или отобразить.
+     */
+    explicit MappedFile(const std::string& filePath, AccessPattern pattern = AccessPattern::SEQUENTIAL);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    [[nodiscard]] const char* data() const { return _data; }
+    [[nodiscard]] size_t size() const { return _size; }
+    [[nodiscard]] std::string_view view() const { return {_data, _size}; }
+
+    /**
+     * @brief Меняет подсказку о характере чтения для уже отображённого файла.
+     */
+    void advise(AccessPattern pattern) const;
+
+    /**
+     * @brief Отпускает уже прочитанные страницы диапазона [offset, offset + length).
+     *
+     * Данные остаются доступны: при следующем обращении страницы снова подтянутся из файла.
+     * Нужен при однократном проходе по файлу больше оперативной памяти, чтобы прочитанное
+     * не копилось в резидентной памяти процесса.
+     */
+    void dropPages(size_t offset, size_t length) const;
+
+private:
+    void release() noexcept;
+
+    const char* _data = nullptr;
+    size_t _size = 0;
+#ifdef _WIN32
+    void* _fileHandle = nullptr;
+    void* _mappingHandle = nullptr;
+#else
+    int _fd = -1;
+#endif
+};
+
+#endif
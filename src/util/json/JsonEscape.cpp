@@ -0,0 +1,74 @@
+#include "JsonEscape.hpp"
+
+#include <bit>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define JSON_ESCAPE_X86 1
+#include <immintrin.h>
+#else
+#define JSON_ESCAPE_X86 0
+#endif
+
+namespace {
+    bool needsEscape(unsigned char c) {
+        return c < 0x20 || c == '"' || c == '\\';
+    }
+
+    void appendEscaped(std::string& out, unsigned char c) {
+        static constexpr char hex[] = "0123456789abcdef";
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default: {
+                const char escaped[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+                out.append(escaped, sizeof(escaped));
+            }
+        }
+    }
+
+    // позиция первого символа, требующего экранирования, начиная с from, или size
+    size_t findEscape(std::string_view value, size_t from) {
+        size_t i = from;
+#if JSON_ESCAPE_X86
+        // SSE2 есть на любом x86-64: 16 байт за итерацию, обычные ячейки проходятся без ветвлений по символам
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i controlMax = _mm_set1_epi8(0x1F);
+        for (; i + 16 <= value.size(); i += 16) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(value.data() + i));
+            // c <= 0x1F без знака: min(c, 0x1F) == c
+            const __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(chunk, controlMax), chunk);
+            const __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)), control);
+            const auto mask = static_cast<u32>(_mm_movemask_epi8(special));
+            if (mask != 0) {
+                return i + std::countr_zero(mask);
+            }
+        }
+#endif
+        for (; i < value.size(); ++i) {
+            if (needsEscape(static_cast<unsigned char>(value[i]))) {
+                return i;
+            }
+        }
+        return value.size();
+    }
+}
+
+void appendJsonString(std::string& out, std::string_view value) {
+    out.reserve(out.size() + value.size() + 2);
+    out += '"';
+    // между спецсимволами копируем целыми отрезками
+    size_t runStart = 0;
+    for (size_t i = findEscape(value, 0); i < value.size(); i = findEscape(value, runStart)) {
+        out.append(value.data() + runStart, i - runStart);
+        appendEscaped(out, static_cast<unsigned char>(value[i]));
+        runStart = i + 1;
+    }
+    out.append(value.data() + runStart, value.size() - runStart);
+    out += '"';
+}
@@ -0,0 +1,17 @@
+#ifndef JSONESCAPE_HPP
+#define JSONESCAPE_HPP
+
+#include <string>
+#include <string_view>
+
+#include "../types/types.hpp"
+
+/**
+ * @brief Дописывает value в out как строковый литерал JSON: в кавычках, с экранированием
+ * кавычек, обратной косой черты и управляющих символов. Байты UTF-8 копируются как есть.
+ *
+ * На x86 поиск символов для экранирования идёт по 16 байт (SSE2).
+ */
+void appendJsonString(std::string& out, std::string_view value);
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef JSONWRITER_HPP
+#define JSONWRITER_HPP
+
+#include <charconv>
+#include <cmath>
+#include <concepts>
+#include <string>
+#include <string_view>
+
+#include "JsonEscape.hpp"
+
+/**
+ * @brief Пишет JSON прямо в строку, без промежуточного дерева.
+ *
+ * Запятые расставляются сами: после ключа значение пишется без запятой, после любого
+ * значения или закрытого контейнера следующий элемент получает запятую. Корректность
+ * вложенности не проверяется - writer рассчитан на горячие сериализаторы с фиксированной схемой.
+ * Числа форматируются std::to_chars, нечисловые double (NaN, бесконечности) пишутся как null, как в nlohmann::json.
+ */
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out) : _out(out) {}
+
+    JsonWriter& beginObject() { return open('{'); }
+    JsonWriter& endObject() { return close('}'); }
+    JsonWriter& beginArray() { return open('['); }
+    JsonWriter& endArray() { return close(']'); }
+
+    JsonWriter& key(std::string_view name) {
+        separate();
+        appendJsonString(_out, name);
+        _out += ':';
+        _needComma = false;
+        return *this;
+    }
+
+    JsonWriter& value(std::string_view text) {
+        separate();
+        appendJsonString(_out, text);
+        return *this;
+    }
+
+    JsonWriter& value(const char* text) { return value(std::string_view(text)); }
+    JsonWriter& value(const std::string& text) { return value(std::string_view(text)); }
+
+    JsonWriter& value(bool flag) {
+        separate();
+        _out += flag ? "true" : "false";
+        return *this;
+    }
+
+    template<std::integral T>
+    JsonWriter& value(T number) {
+        separate();
+        char digits[24];
+        const auto result = std::to_chars(digits, digits + sizeof(digits), number);
+        _out.append(digits, result.ptr);
+        return *this;
+    }
+
+    template<std::floating_point T>
+    JsonWriter& value(T number) {
+        if (!std::isfinite(number)) {
+            return null();
+        }
+        separate();
+        // кратчайшее представление, которое читается обратно в то же число
+        char digits[32];
+        const auto result = std::to_chars(digits, digits + sizeof(digits), number);
+        _out.append(digits, result.ptr);
+        return *this;
+    }
+
+    JsonWriter& null() {
+        separate();
+        _out += "null";
+        return *this;
+    }
+
+    template<typename T>
+    JsonWriter& field(std::string_view name, const T& fieldValue) {
+        key(name);
+        return value(fieldValue);
+    }
+
+    /**
+     * @brief Массив строк или чисел из любого диапазона.
+     */
+    template<typename Range>
+    JsonWriter& array(const Range& values) {
+        beginArray();
+        for (const auto& item : values) {
+            value(item);
+        }
+        return endArray();
+    }
+
+private:
+    void separate() {
+        if (_needComma) {
+            _out += ',';
+        }
+        _needComma = true;
+    }
+
+    JsonWriter& open(char bracket) {
+        separate();
+        _out += bracket;
+        _needComma = false;
+        return *this;
+    }
+
+    JsonWriter& close(char bracket) {
+        _out += bracket;
+        _needComma = true;
+        return *this;
+    }
+
+    std::string& _out;
+    bool _needComma = false;
+};
+
+#endif
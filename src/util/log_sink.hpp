@@ -0,0 +1,411 @@
+#ifndef LOG_SINK_HPP
+#define LOG_SINK_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <source_location>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "colors.hpp"
+#include "constants.hpp"
+#include "concurrency/SpscRing.hpp"
+#include "types/types.hpp"
+
+namespace Log {
+
+    struct LogStats {
+        u64 written = 0;
+        u64 dropped = 0;
+    };
+
+    namespace detail {
+        using LogLevel = FRAMEWORK_CONSTANTS::LogLevel;
+
+        // формирует сообщение из аргументов, скопированных в запись
+        using DeferredFormat = void (*)(std::string& out, std::string_view format, const std::byte* args);
+
+        constexpr size_t deferredArgsBytes = 64;
+
+        /**
+         * @brief Запись лога, как её кладёт вызывающий поток.
+         *
+         * Время берётся в момент вызова, а строка времени, уровень и имя файла собираются уже
+         * фоновым писателем. Сообщение либо готово (text), либо, если все аргументы числа,
+         * откладывается: аргументы побайтно лежат в args, а format указывает на строковый литерал.
+         */
+        struct Record {
+            std::chrono::system_clock::time_point time;
+            std::source_location location;
+            LogLevel level = LogLevel::LOG_NONE;
+            bool includeFunctionName = false;
+            bool raw = false; // withColor: text выводится как есть, без префикса и перевода строки
+            std::string text;
+            std::string_view format;
+            DeferredFormat deferred = nullptr;
+            std::byte args[deferredArgsBytes];
+        };
+
+        template<typename... Args>
+        constexpr bool deferrable = (std::is_arithmetic_v<std::remove_cvref_t<Args>> && ...) &&
+                                    (sizeof(std::remove_cvref_t<Args>) + ... + 0) <= deferredArgsBytes;
+
+        template<typename... Args>
+        void formatDeferred(std::string& out, std::string_view format, const std::byte* args) {
+            std::tuple<Args...> values;
+            size_t offset = 0;
+            std::apply([&](auto&... value) { ((std::memcpy(&value, args + offset, sizeof(value)), offset += sizeof(value)), ...); }, values);
+            std::apply([&](auto&... value) { std::vformat_to(std::back_inserter(out), format, std::make_format_args(value...)); }, values);
+        }
+
+        template<typename... Args>
+        void setMessage(Record& record, std::format_string<Args...> formatStr, Args&&... args) {
+            if constexpr (sizeof...(Args) != 0 && deferrable<Args...>) {
+                size_t offset = 0;
+                ((std::memcpy(record.args + offset, &args, sizeof(args)), offset += sizeof(args)), ...);
+                record.format = formatStr.get();
+                record.deferred = &formatDeferred<std::remove_cvref_t<Args>...>;
+            } else {
+                record.text = std::format(formatStr, std::forward<Args>(args)...);
+            }
+        }
+
+        /**
+         * @brief Строка времени "YYYY-MM-DD HH:MM:SS.nnnnnnnnn"; дата и время до секунд
+         * форматируются один раз на секунду.
+         */
+        class TimestampFormatter {
+            std::chrono::sys_seconds _second{};
+            std::string _prefix;
+
+        public:
+            void append(std::string& out, std::chrono::system_clock::time_point time) {
+                const auto second = std::chrono::floor<std::chrono::seconds>(time);
+                if (second != _second || _prefix.empty()) {
+                    _second = second;
+                    _prefix = std::format("{:%Y-%m-%d %H:%M:%S}", second);
+                }
+                out += _prefix;
+                std::format_to(std::back_inserter(out), ".{:09}",
+                               std::chrono::duration_cast<std::chrono::nanoseconds>(time - second).count());
+            }
+        };
+
+        inline void appendRecord(std::string& out, const Record& record, TimestampFormatter& timestamp) {
+            const auto appendMessage = [&] {
+                if (record.deferred) {
+                    record.deferred(out, record.format, record.args);
+                } else {
+                    out += record.text;
+                }
+            };
+            if (record.raw) {
+                appendMessage();
+                return;
+            }
+
+            std::string_view levelColor = Colors::White;
+            const char* levelStr = "UNKNOWN";
+
+            switch (record.level) {
+                case LogLevel::LOG_ERROR:
+                    levelStr = "ERROR";
+                    levelColor = Colors::BoldRed;
+                    break;
+                case LogLevel::LOG_WARNING:
+                    levelStr = "WARNING";
+                    levelColor = Colors::Yellow;
+                    break;
+                case LogLevel::LOG_MESSAGE:
+                    levelStr = "MESSAGE";
+                    levelColor = Colors::Magenta;
+                    break;
+                case LogLevel::LOG_INFO:
+                    levelStr = "INFO";
+                    levelColor = Colors::Green;
+                    break;
+                case LogLevel::LOG_DEBUG:
+                    levelStr = "DEBUG";
+                    levelColor = Colors::Cyan;
+                    break;
+                case LogLevel::LOG_NONE:
+                    return;
+            }
+
+            const std::string_view filePath = record.location.file_name();
+            const std::string_view fileName = filePath.substr(filePath.find_last_of("/\\") + 1);
+
+            out += '[';
+            timestamp.append(out, record.time);
+            std::format_to(std::back_inserter(out), "] [{}{:<7}{}] [{}:{}] ", levelColor, levelStr, Colors::Reset, fileName, record.location.line());
+            if (record.includeFunctionName) {
+                std::format_to(std::back_inserter(out), "[{}] ", record.location.function_name());
+            }
+            out += levelColor;
+            appendMessage();
+            out += Colors::Reset;
+            out += '\n';
+        }
+
+        /**
+         * @brief Фоновый писатель лога.
+         *
+         * У каждого пишущего потока своё кольцо SpscRing, поэтому запись в лог - это одно
+         * перемещение записи в свой буфер без блокировок и без общей кэш-линии. Писатель раз в
+         * logFlushInterval (или по запросу flush) забирает записи всех колец, упорядочивает по
+         * времени, форматирует одним буфером и отдаёт в std::cout одной операцией.
+         *
+         * Кольцо заполнено: при LogOverflowPolicy::DROP запись теряется и попадает в счётчик,
+         * о потерях писатель сообщает отдельной строкой; при BLOCK поток ждёт места. Ошибки
+         * никогда не теряются: error() ждёт, пока запись будет выведена.
+         *
+         * Объект живёт до конца процесса; при завершении писатель выводит остаток и
+         * останавливается, после чего записи печатаются вызывающим потоком напрямую.
+         */
+        class AsyncSink {
+            struct ThreadRing {
+                Concurrency::SpscRing<Record> ring;
+                std::atomic<bool> orphaned{false}; // поток завершился, кольцо удаляется после опустошения
+
+                explicit ThreadRing(size_t capacity) : ring(capacity) {}
+            };
+
+            // держит кольцо потока и помечает его брошенным при завершении потока
+            struct ThreadRingHandle {
+                std::shared_ptr<ThreadRing> ring;
+
+                ~ThreadRingHandle() {
+                    if (ring) {
+                        ring->orphaned.store(true, std::memory_order_release);
+                    }
+                }
+            };
+
+            static constexpr std::chrono::milliseconds logFlushInterval{10};
+
+            std::mutex _ringsMutex;
+            std::vector<std::shared_ptr<ThreadRing>> _rings;
+
+            std::mutex _wakeMutex;
+            std::condition_variable _wake;
+            bool _wakeRequested = false;
+
+            std::atomic<bool> _running{true};
+            std::atomic<bool> _stopping{false};
+            std::atomic<u64> _flushRequested{0};
+            std::atomic<u64> _flushCompleted{0};
+            std::atomic<u64> _written{0};
+            std::atomic<u64> _dropped{0};
+
+            std::thread _writer;
+
+            AsyncSink() : _writer([this] { writerLoop(); }) {}
+
+            // останавливает писатель при выходе из процесса; сам AsyncSink не разрушается,
+            // чтобы логирование из деструкторов других статических объектов оставалось корректным
+            struct Shutdown {
+                ~Shutdown() { instance().stop(); }
+            };
+
+        public:
+            static AsyncSink& instance() {
+                static AsyncSink* sink = new AsyncSink();
+                static Shutdown shutdown;
+                return *sink;
+            }
+
+            void push(Record&& record) {
+                const bool isError = record.level == LogLevel::LOG_ERROR;
+                if (!_running.load(std::memory_order_acquire)) {
+                    writeDirect(record);
+                    return;
+                }
+
+                ThreadRing& ring = localRing();
+                if (!ring.ring.tryPush(std::move(record))) {
+                    if (!isError && FRAMEWORK_CONSTANTS::logOverflowPolicy.load(std::memory_order_relaxed) == FRAMEWORK_CONSTANTS::LogOverflowPolicy::DROP) {
+                        _dropped.fetch_add(1, std::memory_order_relaxed);
+                        return;
+                    }
+                    wake();
+                    while (!ring.ring.tryPush(std::move(record))) {
+                        if (!_running.load(std::memory_order_acquire)) {
+                            writeDirect(record);
+                            return;
+                        }
+                        std::this_thread::yield();
+                    }
+                }
+                if (isError) {
+                    flush();
+                }
+            }
+
+            /**
+             * @brief Ждёт, пока всё, что этот поток записал до вызова, будет выведено.
+             */
+            void flush() {
+                if (!_running.load(std::memory_order_acquire)) {
+                    std::cout.flush();
+                    return;
+                }
+                const u64 ticket = _flushRequested.fetch_add(1, std::memory_order_acq_rel) + 1;
+                wake();
+                u64 completed = _flushCompleted.load(std::memory_order_acquire);
+                while (completed < ticket) {
+                    _flushCompleted.wait(completed, std::memory_order_acquire);
+                    completed = _flushCompleted.load(std::memory_order_acquire);
+                }
+            }
+
+            [[nodiscard]] LogStats stats() const {
+                return {_written.load(std::memory_order_relaxed), _dropped.load(std::memory_order_relaxed)};
+            }
+
+            void writeDirect(const Record& record) {
+                TimestampFormatter timestamp;
+                std::string out;
+                appendRecord(out, record, timestamp);
+                std::cout << out;
+                if (record.raw) {
+                    std::cout.flush();
+                }
+                _written.fetch_add(1, std::memory_order_relaxed);
+            }
+
+        private:
+            ThreadRing& localRing() {
+                thread_local ThreadRingHandle handle;
+                if (!handle.ring) {
+                    handle.ring = std::make_shared<ThreadRing>(FRAMEWORK_CONSTANTS::logRingCapacity);
+                    std::lock_guard lock(_ringsMutex);
+                    _rings.push_back(handle.ring);
+                }
+                return *handle.ring;
+            }
+
+            void wake() {
+                {
+                    std::lock_guard lock(_wakeMutex);
+                    _wakeRequested = true;
+                }
+                _wake.notify_one();
+            }
+
+            void stop() {
+                _stopping.store(true, std::memory_order_release);
+                wake();
+                if (_writer.joinable()) {
+                    _writer.join();
+                }
+            }
+
+            void writerLoop() {
+                std::vector<Record> batch;
+                std::string out;
+                TimestampFormatter timestamp;
+                u64 reportedDrops = 0;
+
+                for (;;) {
+                    // читаются до сбора: всё, что записано до flush или остановки, попадёт в этот проход
+                    const u64 flushTicket = _flushRequested.load(std::memory_order_acquire);
+                    const bool stopping = _stopping.load(std::memory_order_acquire);
+
+                    collect(batch);
+                    const u64 dropped = _dropped.load(std::memory_order_relaxed);
+
+                    if (!batch.empty() || dropped != reportedDrops) {
+                        // внутри потока записи уже по порядку, stable_sort его сохраняет
+                        std::stable_sort(batch.begin(), batch.end(), [](const Record& a, const Record& b) { return a.time < b.time; });
+                        out.clear();
+                        for (const Record& record : batch) {
+                            appendRecord(out, record, timestamp);
+                        }
+                        if (dropped != reportedDrops) {
+                            Record notice;
+                            notice.time = std::chrono::system_clock::now();
+                            notice.location = std::source_location::current();
+                            notice.level = LogLevel::LOG_WARNING;
+                            notice.text = std::format("{} log records dropped: ring buffer full", dropped - reportedDrops);
+                            appendRecord(out, notice, timestamp);
+                            reportedDrops = dropped;
+                        }
+                        std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+                        std::cout.flush();
+                        _written.fetch_add(batch.size(), std::memory_order_relaxed);
+                    }
+
+                    _flushCompleted.store(flushTicket, std::memory_order_release);
+                    _flushCompleted.notify_all();
+
+                    if (stopping) {
+                        break;
+                    }
+                    if (batch.empty()) {
+                        std::unique_lock lock(_wakeMutex);
+                        _wake.wait_for(lock, logFlushInterval, [this] { return _wakeRequested; });
+                        _wakeRequested = false;
+                    }
+                    batch.clear();
+                }
+
+                // дальше потоки печатают сами; ждущие flush отпускаются
+                _running.store(false, std::memory_order_release);
+                _flushCompleted.store(std::numeric_limits<u64>::max(), std::memory_order_release);
+                _flushCompleted.notify_all();
+            }
+
+            void collect(std::vector<Record>& batch) {
+                std::lock_guard lock(_ringsMutex);
+                std::erase_if(_rings, [&batch](const std::shared_ptr<ThreadRing>& ring) {
+                    // флаг читается до опустошения: брошенное кольцо после него уже не пополнится
+                    const bool orphaned = ring->orphaned.load(std::memory_order_acquire);
+                    ring->ring.drain([&batch](Record& record) { batch.push_back(std::move(record)); });
+                    return orphaned;
+                });
+            }
+        };
+    }
+
+    // уровень, начиная с которого записи отбрасываются; меняется на ходу
+    inline void setLevel(FRAMEWORK_CONSTANTS::LogLevel level) {
+        FRAMEWORK_CONSTANTS::runtimeLogLevel.store(level, std::memory_order_relaxed);
+    }
+
+    inline FRAMEWORK_CONSTANTS::LogLevel level() {
+        return FRAMEWORK_CONSTANTS::runtimeLogLevel.load(std::memory_order_relaxed);
+    }
+
+    inline bool enabled(FRAMEWORK_CONSTANTS::LogLevel level) {
+        return level != FRAMEWORK_CONSTANTS::LogLevel::LOG_NONE && level <= Log::level();
+    }
+
+    /**
+     * @brief Выводит всё, что текущий поток записал в лог до вызова; нужен перед прямой печатью
+     * в std::cout, чтобы она не обогнала записи лога.
+     */
+    inline void flush() {
+        if (FRAMEWORK_CONSTANTS::asyncLogging.load(std::memory_order_relaxed)) {
+            detail::AsyncSink::instance().flush();
+        } else {
+            std::cout.flush();
+        }
+    }
+
+    inline LogStats stats() {
+        return detail::AsyncSink::instance().stats();
+    }
+}
+
+#endif //LOG_SINK_HPP
@@ -0,0 +1,200 @@
+#include "MetricsRegistry.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <limits>
+
+namespace Metrics {
+
+    namespace {
+        void appendNumber(std::string& out, double value) {
+            if (std::isnan(value)) {
+                out += "NaN";
+            } else if (std::isinf(value)) {
+                out += value > 0 ? "+Inf" : "-Inf";
+            } else {
+                char buffer[32];
+                const auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+                out.append(buffer, end);
+            }
+        }
+
+        template<std::integral T>
+        void appendNumber(std::string& out, T value) {
+            char buffer[24];
+            const auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            out.append(buffer, end);
+        }
+
+        // в значениях меток экранируются \, " и перевод строки
+        void appendLabelValue(std::string& out, std::string_view value) {
+            for (const char c : value) {
+                switch (c) {
+                    case '\\': out += "\\\\"; break;
+                    case '"': out += "\\\""; break;
+                    case '\n': out += "\\n"; break;
+                    default: out += c;
+                }
+            }
+        }
+    }
+
+    size_t LatencyHistogram::bucketIndex(u64 value) {
+        if (value < subBuckets) {
+            return static_cast<size_t>(value);
+        }
+        const u32 exponent = static_cast<u32>(std::bit_width(value)) - 1;
+        if (exponent > maxExponent) {
+            return bucketCount - 1;
+        }
+        const u64 mantissa = (value >> (exponent - subBucketBits)) & (subBuckets - 1);
+        return (exponent - subBucketBits + 1) * subBuckets + static_cast<size_t>(mantissa);
+    }
+
+    u64 LatencyHistogram::bucketLowerBound(size_t index) {
+        const size_t row = index / subBuckets;
+        const u64 mantissa = index % subBuckets;
+        if (row == 0) {
+            return mantissa;
+        }
+        return (subBuckets + mantissa) << (row - 1);
+    }
+
+    HistogramSnapshot LatencyHistogram::snapshot() const {
+        HistogramSnapshot snapshot;
+        snapshot.buckets.assign(bucketCount, 0);
+        for (const auto& cell : _cells) {
+            for (size_t i = 0; i < bucketCount; ++i) {
+                snapshot.buckets[i] += cell.buckets[i].load(std::memory_order_relaxed);
+            }
+            snapshot.sum += cell.sum.load(std::memory_order_relaxed);
+        }
+        for (const u64 count : snapshot.buckets) {
+            snapshot.count += count;
+        }
+        return snapshot;
+    }
+
+    u64 HistogramSnapshot::quantile(double q) const {
+        if (count == 0) {
+            return 0;
+        }
+        const u64 rank = std::max<u64>(1, static_cast<u64>(std::ceil(std::clamp(q, 0.0, 1.0) * static_cast<double>(count))));
+        u64 seen = 0;
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                // верхняя граница корзины: оценка сверху, как у HDR
+                return i + 1 < LatencyHistogram::bucketCount ? LatencyHistogram::bucketLowerBound(i + 1) - 1 : LatencyHistogram::bucketLowerBound(i);
+            }
+        }
+        return LatencyHistogram::bucketLowerBound(buckets.size() - 1);
+    }
+
+    u64 HistogramSnapshot::countAtMost(u64 bound) const {
+        u64 total = 0;
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            // корзина целиком ниже границы; корзина, которую граница режет, относится к следующей
+            const u64 upper = i + 1 < LatencyHistogram::bucketCount ? LatencyHistogram::bucketLowerBound(i + 1) - 1 : std::numeric_limits<u64>::max();
+            if (upper > bound) {
+                break;
+            }
+            total += buckets[i];
+        }
+        return total;
+    }
+
+    PrometheusWriter& PrometheusWriter::family(std::string_view name, std::string_view type, std::string_view help) {
+        _out += "# HELP ";
+        _out += name;
+        _out += ' ';
+        _out += help;
+        _out += "\n# TYPE ";
+        _out += name;
+        _out += ' ';
+        _out += type;
+        _out += '\n';
+        return *this;
+    }
+
+    void PrometheusWriter::writeSeries(std::string_view name, Labels labels, std::string_view extraName, std::string_view extraValue) {
+        _out += name;
+        if (labels.size() != 0 || !extraName.empty()) {
+            _out += '{';
+            bool first = true;
+            const auto writeLabel = [&](std::string_view label, std::string_view value) {
+                if (!first) {
+                    _out += ',';
+                }
+                first = false;
+                _out += label;
+                _out += "=\"";
+                appendLabelValue(_out, value);
+                _out += '"';
+            };
+            for (const auto& [label, value] : labels) {
+                writeLabel(label, value);
+            }
+            if (!extraName.empty()) {
+                writeLabel(extraName, extraValue);
+            }
+            _out += '}';
+        }
+        _out += ' ';
+    }
+
+    PrometheusWriter& PrometheusWriter::sample(std::string_view name, Labels labels, double value) {
+        writeSeries(name, labels);
+        appendNumber(_out, value);
+        _out += '\n';
+        return *this;
+    }
+
+    PrometheusWriter& PrometheusWriter::sample(std::string_view name, Labels labels, u64 value) {
+        writeSeries(name, labels);
+        appendNumber(_out, value);
+        _out += '\n';
+        return *this;
+    }
+
+    PrometheusWriter& PrometheusWriter::sample(std::string_view name, Labels labels, i64 value) {
+        writeSeries(name, labels);
+        appendNumber(_out, value);
+        _out += '\n';
+        return *this;
+    }
+
+    PrometheusWriter& PrometheusWriter::histogram(std::string_view name, Labels labels, const HistogramSnapshot& snapshot,
+                                                  double unitsPerOutput, std::initializer_list<double> bounds) {
+        const std::string bucketName = std::string(name) + "_bucket";
+        for (const double bound : bounds) {
+            std::string le;
+            appendNumber(le, bound);
+            writeSeries(bucketName, labels, "le", le);
+            appendNumber(_out, snapshot.countAtMost(static_cast<u64>(std::llround(bound * unitsPerOutput))));
+            _out += '\n';
+        }
+        writeSeries(bucketName, labels, "le", "+Inf");
+        appendNumber(_out, snapshot.count);
+        _out += '\n';
+
+        writeSeries(std::string(name) + "_sum", labels);
+        appendNumber(_out, static_cast<double>(snapshot.sum) / unitsPerOutput);
+        _out += '\n';
+        writeSeries(std::string(name) + "_count", labels);
+        appendNumber(_out, snapshot.count);
+        _out += '\n';
+        return *this;
+    }
+
+    std::string MetricsRegistry::renderPrometheus() const {
+        std::string out;
+        PrometheusWriter writer(out);
+        for (const auto& collector : _collectors) {
+            collector(writer);
+        }
+        return out;
+    }
+}
@@ -0,0 +1,181 @@
+#ifndef METRICSREGISTRY_HPP
+#define METRICSREGISTRY_HPP
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../types/types.hpp"
+
+namespace Metrics {
+
+    // столько независимых ячеек у каждого счётчика; поток пишет только в свою
+    constexpr size_t shardCount = 16;
+
+    /**
+     * @brief Номер ячейки текущего потока: потоки получают номера по кругу при первом обращении.
+     */
+    inline size_t threadShard() {
+        static std::atomic<size_t> nextShard{0};
+        thread_local const size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % shardCount;
+        return shard;
+    }
+
+    /**
+     * @brief Монотонный счётчик без общей точки записи.
+     *
+     * Каждый поток увеличивает свою ячейку на отдельной кэш-линии, поэтому запись - одна
+     * relaxed-операция без борьбы за линию; чтение складывает все ячейки.
+     */
+    class Counter {
+        struct alignas(64) Cell {
+            std::atomic<u64> value{0};
+        };
+        std::array<Cell, shardCount> _cells;
+
+    public:
+        void add(u64 delta = 1) {
+            _cells[threadShard()].value.fetch_add(delta, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] u64 value() const {
+            u64 total = 0;
+            for (const auto& cell : _cells) {
+                total += cell.value.load(std::memory_order_relaxed);
+            }
+            return total;
+        }
+    };
+
+    /**
+     * @brief Значение, которое растёт и убывает (запросы в работе). Увеличение и уменьшение
+     * могут прийти из разных потоков: сумма ячеек всё равно верна.
+     */
+    class Gauge {
+        struct alignas(64) Cell {
+            std::atomic<i64> value{0};
+        };
+        std::array<Cell, shardCount> _cells;
+
+    public:
+        void add(i64 delta) {
+            _cells[threadShard()].value.fetch_add(delta, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] i64 value() const {
+            i64 total = 0;
+            for (const auto& cell : _cells) {
+                total += cell.value.load(std::memory_order_relaxed);
+            }
+            return total;
+        }
+    };
+
+    /**
+     * @brief Сумма ячеек гистограммы на момент чтения.
+     */
+    struct HistogramSnapshot {
+        std::vector<u64> buckets;
+        u64 count = 0;
+        u64 sum = 0;
+
+        /**
+         * @brief Значение, не меньше которого q-я доля записей (с точностью корзины, ~6%).
+         */
+        [[nodiscard]] u64 quantile(double q) const;
+
+        /**
+         * @brief Сколько записей не больше bound.
+         */
+        [[nodiscard]] u64 countAtMost(u64 bound) const;
+    };
+
+    /**
+     * @brief Гистограмма в духе HDR: корзины логарифмические по степеням двойки, и каждая
+     * степень делится на 16 равных частей.
+     *
+     * Относительная ошибка не больше 1/16 во всём диапазоне 0..2^36 при фиксированных 528
+     * корзинах, поэтому перцентили считаются по самой гистограмме, а не по выборке. Запись -
+     * две relaxed-операции в ячейках своего потока.
+     */
+    class LatencyHistogram {
+    public:
+        static constexpr u32 subBucketBits = 4;
+        static constexpr u32 subBuckets = 1u << subBucketBits;
+        static constexpr u32 maxExponent = 35;
+        static constexpr size_t bucketCount = (maxExponent - subBucketBits + 2) * subBuckets;
+
+        void record(u64 value) {
+            Cell& cell = _cells[threadShard()];
+            cell.buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+            cell.sum.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] HistogramSnapshot snapshot() const;
+
+        static size_t bucketIndex(u64 value);
+        // наименьшее значение, попадающее в корзину
+        static u64 bucketLowerBound(size_t index);
+
+    private:
+        struct alignas(64) Cell {
+            std::array<std::atomic<u64>, bucketCount> buckets{};
+            std::atomic<u64> sum{0};
+        };
+        std::array<Cell, shardCount> _cells;
+    };
+
+    using Labels = std::initializer_list<std::pair<std::string_view, std::string_view>>;
+
+    /**
+     * @brief Пишет метрики в текстовом формате Prometheus 0.0.4.
+     */
+    class PrometheusWriter {
+        std::string& _out;
+
+    public:
+        explicit PrometheusWriter(std::string& out) : _out(out) {}
+
+        // заголовок семейства: # HELP и # TYPE (counter, gauge, histogram)
+        PrometheusWriter& family(std::string_view name, std::string_view type, std::string_view help);
+
+        PrometheusWriter& sample(std::string_view name, Labels labels, double value);
+        PrometheusWriter& sample(std::string_view name, Labels labels, u64 value);
+        PrometheusWriter& sample(std::string_view name, Labels labels, i64 value);
+
+        /**
+         * @brief Серии _bucket/_sum/_count гистограммы. Значения snapshot делятся на unitsPerOutput
+         * (1e6 - микросекунды в секунды), границы bounds задаются уже в итоговых единицах.
+         */
+        PrometheusWriter& histogram(std::string_view name, Labels labels, const HistogramSnapshot& snapshot,
+                                    double unitsPerOutput, std::initializer_list<double> bounds);
+
+    private:
+        void writeSeries(std::string_view name, Labels labels, std::string_view extraName = {}, std::string_view extraValue = {});
+    };
+
+    /**
+     * @brief Источники метрик, опрашиваемые при каждом чтении /metrics.
+     *
+     * Горячий путь в реестр не заходит: компоненты держат свои Counter/Gauge/LatencyHistogram
+     * и регистрируют функцию, которая выписывает их значения. Регистрация - только при запуске,
+     * до первого запроса; сборщик не должен пережить объект, на который ссылается.
+     */
+    class MetricsRegistry {
+        std::vector<std::function<void(PrometheusWriter&)>> _collectors;
+
+    public:
+        void addCollector(std::function<void(PrometheusWriter&)> collector) {
+            _collectors.push_back(std::move(collector));
+        }
+
+        [[nodiscard]] std::string renderPrometheus() const;
+    };
+}
+
+#endif
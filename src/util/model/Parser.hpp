@@ -2,69 +2,138 @@
 #ifndef PARSER_HPP
 #define PARSER_HPP
 
-#include <fstream>
+#include <cctype>
+#include <charconv>
 #include <map>
+#include <optional>
 #include <vector>
-#include <sstream>
 
 #include "../types/eigen_types.hpp"
+#include "../concurrency/Parallel.hpp"
+#include "../csv/CsvChunks.hpp"
+#include "../csv/CsvReader.hpp"
+#include "../io/MappedFile.hpp"
 
 
 class Parser {
     std::vector<Eigen::VectorXf> _inputs;
     std::vector<Eigen::VectorXf> _outputs;
     std::vector<std::string> _header;
-    std::map<std::string, u32> _classMap;
+    std::map<std::string, u32, std::less<>> _classMap;
     u32 _nextClassId = 0;
 
-public:
-    explicit Parser(const std::string& filepath, const std::vector<u32>& featureColumns, u32 targetColumn, bool hasHeader = true, char delimiter = ',') {
-        std::ifstream file(filepath);
-        if (!file.is_open()) {
-            throw std::runtime_error("Could not open file: " + filepath);
-        }
+    // целевое значение строки: число или метка класса (индекс в ParsedChunk::labels)
+    struct ChunkTarget {
+        f32 value = 0;
+        u32 label = 0;
+        bool isLabel = false;
+    };
 
-        std::string line;
+    // результат разбора одного куска файла в своём потоке
+    struct ParsedChunk {
+        std::vector<Eigen::VectorXf> inputs;
+        std::vector<ChunkTarget> targets;
+        std::vector<std::string> labels;
+    };
 
-        if (hasHeader && std::getline(file, line)) {
-            std::stringstream ss(line);
-            std::string cell;
-            while (std::getline(ss, cell, delimiter)) {
-                _header.push_back(cell);
-            }
+    // как std::stof: пробелы в начале пропускаются, хвост после числа игнорируется
+    static std::optional<f32> tryParseFloat(std::string_view text) {
+        while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front()))) {
+            text.remove_prefix(1);
+        }
+        f32 value = 0;
+        auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (ec != std::errc()) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    static f32 parseFloat(std::string_view text) {
+        if (auto value = tryParseFloat(text)) {
+            return *value;
         }
+        throw std::invalid_argument("Not a number in feature column: " + std::string(text));
+    }
 
-        while (std::getline(file, line)) {
-            std::vector<std::string> row;
-            std::stringstream ss(line);
-            std::string cell;
+    static ParsedChunk parseChunk(std::string_view data, const std::vector<u32>& featureColumns, u32 targetColumn, char delimiter) {
+        ParsedChunk chunk;
+        std::map<std::string, u32, std::less<>> labelIndex;
+        CsvReader reader(data, delimiter);
+        std::vector<std::string_view> row;
 
-            while (std::getline(ss, cell, delimiter)) {
-                row.push_back(cell);
-            }
+        const u32 requiredColumns = std::max(*std::ranges::max_element(featureColumns), targetColumn);
 
-            if (row.size() <= std::max(*std::ranges::max_element(featureColumns), targetColumn)) {
+        while (reader.next(row)) {
+            if (row.size() <= requiredColumns) {
                 continue;
             }
 
             Eigen::VectorXf currentInput(featureColumns.size());
             for (i64 i = 0; i < featureColumns.size(); ++i) {
-                currentInput(i) = std::stof(row.at(featureColumns[i]));
+                currentInput(i) = parseFloat(row[featureColumns[i]]);
             }
-            _inputs.push_back(currentInput);
+            chunk.inputs.push_back(std::move(currentInput));
 
-            const std::string& targetValue = row.at(targetColumn);
-            try {
-                f32 numericOutput = std::stof(targetValue);
-                Eigen::VectorXf out(1);
-                out(0) = numericOutput;
-                _outputs.push_back(out);
-            } catch (const std::invalid_argument&) {
-                if (!_classMap.contains(targetValue)) {
-                    _classMap[targetValue] = _nextClassId++;
+            const std::string_view targetValue = row[targetColumn];
+            if (auto numericOutput = tryParseFloat(targetValue)) {
+                chunk.targets.push_back({*numericOutput, 0, false});
+            } else {
+                auto it = labelIndex.find(targetValue);
+                if (it == labelIndex.end()) {
+                    it = labelIndex.emplace(std::string(targetValue), static_cast<u32>(chunk.labels.size())).first;
+                    chunk.labels.emplace_back(targetValue);
                 }
+                chunk.targets.push_back({0, it->second, true});
+            }
+        }
+        return chunk;
+    }
+
+public:
+    explicit Parser(const std::string& filepath, const std::vector<u32>& featureColumns, u32 targetColumn, bool hasHeader = true, char delimiter = ',',
+                    u32 threads = Concurrency::defaultThreadCount()) {
+        const MappedFile file(filepath, MappedFile::AccessPattern::SEQUENTIAL);
+        const std::string_view data = file.view();
+
+        size_t dataBegin = 0;
+        if (hasHeader) {
+            CsvReader headerReader(data, delimiter);
+            std::vector<std::string_view> row;
+            if (headerReader.next(row)) {
+                _header.assign(row.begin(), row.end());
+            }
+            dataBegin = headerReader.position();
+        }
+
+        // куски разбираются параллельно, затем результаты сливаются по порядку
+        const auto chunks = splitCsvIntoChunks(data, dataBegin, csvChunkCount(data.size() - dataBegin, threads), delimiter, threads);
+        std::vector<ParsedChunk> parsed(chunks.size());
+        Concurrency::parallelFor(chunks.size(), threads, [&](size_t i) {
+            parsed[i] = parseChunk(data.substr(chunks[i].begin, chunks[i].end - chunks[i].begin), featureColumns, targetColumn, delimiter);
+        });
+
+        for (auto& chunk : parsed) {
+            // номера классов раздаются в порядке первого появления в файле, как при последовательном разборе
+            std::vector<std::optional<u32>> classIds(chunk.labels.size());
+            for (size_t r = 0; r < chunk.inputs.size(); ++r) {
+                _inputs.push_back(std::move(chunk.inputs[r]));
+
+                const auto& target = chunk.targets[r];
                 Eigen::VectorXf out(1);
-                out(0) = static_cast<f32>(_classMap[targetValue]);
+                if (target.isLabel) {
+                    auto& classId = classIds[target.label];
+                    if (!classId) {
+                        auto it = _classMap.find(chunk.labels[target.label]);
+                        if (it == _classMap.end()) {
+                            it = _classMap.emplace(chunk.labels[target.label], _nextClassId++).first;
+                        }
+                        classId = it->second;
+                    }
+                    out(0) = static_cast<f32>(*classId);
+                } else {
+                    out(0) = target.value;
+                }
                 _outputs.push_back(out);
             }
         }
@@ -7,31 +7,66 @@
 #include "../util/logging.hpp"
 #include "../util/types/types.hpp"
 #include "controllers/api/DatasetController.hpp"
+#include "controllers/api/ServerController.hpp"
 #include "controllers/api/TransformationController.hpp"
 #include "../service/TransformationService.hpp"
 
-#include "internal/RestServer.hpp"
+#include "internal/IoRuntime.hpp"
+#include "internal/ProgressWebSocketSession.hpp"
 
 
 class Starter {
 
 public:
-    static i32 run(const u16 port = 8080, const u16 threads = 4, const std::string& address = "0.0.0.0") {
+    /**
+     * @brief Роутер со всеми контроллерами API поверх готовых пулов и сервиса датасетов.
+     *
+     * Отдельно от run, чтобы сервер можно было поднять в чужом процессе (нагрузочный тест).
+     */
+    static std::shared_ptr<Router> createRouter(const std::shared_ptr<WorkerPools>& pools,
+                                                const std::shared_ptr<DatasetService>& datasetService) {
+        auto metrics = std::make_shared<Metrics::MetricsRegistry>();
+        auto router = std::make_shared<Router>(pools, *metrics);
+        auto transformationService = std::make_shared<TransformationService>();
+        auto statsService = std::make_shared<ColumnStatsService>();
+        auto queryService = std::make_shared<QueryService>();
+
+        router->addController<DatasetController>(datasetService, statsService, metrics);
+        router->addController<TransformationController>(datasetService, transformationService, queryService);
+        router->addController<ServerController>(pools, metrics);
+
+        // прогресс фоновых задач без опроса REST: клиент подписывается на задачи и получает события
+        auto progressHub = std::make_shared<ProgressHub>();
+        datasetService->setProgressHub(progressHub);
+        router->addWebSocketEndpoint("/api/v1/ws/progress", [progressHub](beast::tcp_stream&& stream, http::request<http::string_body>&& request) {
+            std::make_shared<ProgressWebSocketSession>(std::move(stream), progressHub)->run(std::move(request));
+        });
+        metrics->addCollector([progressHub](Metrics::PrometheusWriter& w) { writeProgressMetrics(w, *progressHub); });
+        return router;
+    }
+
+    /**
+     * @param threads потоков io; 0 - по числу ядер.
+     * @param mode CONTEXT_PER_CORE - свой io_context и acceptor с SO_REUSEPORT на каждый поток.
+     * @param pinThreads привязать потоки io к ядрам.
+     */
+    static i32 run(const u16 port = 8080, const u16 threads = 0, const std::string& address = "0.0.0.0",
+                   const ServerMode mode = ServerMode::SHARED_CONTEXT, const bool pinThreads = false) {
         Log::Logger().message(R"(
 Starting...)");
         auto const _address = net::ip::make_address(address);
 
-        net::io_context ioc{threads};
-
-        auto router = std::make_shared<Router>();
-
-        auto datasetService = std::make_shared<DatasetService>();
-        auto transformationService = std::make_shared<TransformationService>();
+        IoRuntime runtime(mode, threads, pinThreads);
 
-        router->addController<DatasetController>(datasetService);
-        router->addController<TransformationController>(datasetService, transformationService);
+        auto pools = std::make_shared<WorkerPools>(runtime.threadCount(), FRAMEWORK_CONSTANTS::computeThreads, FRAMEWORK_CONSTANTS::computeQueueLimit);
+        auto router = createRouter(pools, std::make_shared<DatasetService>());
 
-        std::make_shared<RestServer>(router, ioc, tcp::endpoint{_address, port})->run();
+        try {
+            runtime.listen(router, tcp::endpoint{_address, port});
+        } catch (const std::exception& e) {
+            Log::Logger().error("Failed to start the server on {}:{}: {}", address, port, e.what());
+            return 1;
+        }
 
         Log::Logger().message(R"(
 Server is running.)");
@@ -50,7 +85,8 @@ Server is running.)");
 
 ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-|| Started with {} threads on: )", threads);
+|| Started with {} threads ({}) on: )", runtime.threadCount(),
+            runtime.mode() == ServerMode::CONTEXT_PER_CORE ? "io_context per core" : "shared io_context");
 
         Log::Logger().withColor(Log::Colors::Cyan, R"(http://{}:{})", address, port);
         Log::Logger().withColor(Log::Colors::Magenta, R"(
@@ -59,14 +95,7 @@ Server is running.)");
 
 )");
 
-        std::vector<std::thread> v;
-        v.reserve(threads - 1);
-        for (auto i = threads - 1; i > 0; --i)
-            v.emplace_back(
-                [&ioc]{
-                    ioc.run();
-                });
-        ioc.run();
+        runtime.run();
 
         return 0;
     }
@@ -0,0 +1,72 @@
+#ifndef APIRESPONSE_HPP
+#define APIRESPONSE_HPP
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <variant>
+
+#include "../server_types.h"
+
+/**
+ * @brief Примерный размер одной порции потокового ответа. Источник дописывает данные,
+ * пока буфер не дорастёт до этого размера, и сессия отправляет его одним HTTP-чанком.
+ */
+inline constexpr size_t streamingChunkBytes = 64 * 1024;
+
+/**
+ * @brief Источник тела потокового ответа: дописывает в buffer следующую порцию.
+ * @return false, если это была последняя порция.
+ *
+ * Вызывается на потоке сессии по мере того, как сокет принимает предыдущие порции, буфер
+ * переиспользуется между вызовами. Исключение после отправки заголовков обрывает соединение.
+ */
+using BodyChunkSource = std::function<bool(std::string& buffer)>;
+
+/**
+ * @brief Ответ, тело которого формируется порциями во время отправки (Transfer-Encoding: chunked).
+ */
+struct StreamingResponse {
+    http::response<http::empty_body> header; // статус и заголовки; длину тела сессия не выставляет
+    BodyChunkSource nextChunk;
+};
+
+/**
+ * @brief Тело ответа, разделяющее неизменяемую строку с кэшем: при отправке байты не копируются.
+ */
+struct SharedStringBody {
+    using value_type = std::shared_ptr<const std::string>;
+
+    static std::uint64_t size(const value_type& body) {
+        return body ? body->size() : 0;
+    }
+
+    class writer {
+        const value_type& _body;
+
+    public:
+        using const_buffers_type = net::const_buffer;
+
+        template<bool isRequest, class Fields>
+        writer(const http::header<isRequest, Fields>&, const value_type& body) : _body(body) {}
+
+        void init(beast::error_code& ec) {
+            ec = {};
+        }
+
+        boost::optional<std::pair<const_buffers_type, bool>> get(beast::error_code& ec) {
+            ec = {};
+            if (!_body || _body->empty()) {
+                return boost::none;
+            }
+            return {{const_buffers_type(_body->data(), _body->size()), false}};
+        }
+    };
+};
+
+/**
+ * @brief Результат обработчика: готовое тело в строке, разделяемое тело из кэша или потоковое тело.
+ */
+using ApiResponse = std::variant<http::response<http::string_body>, http::response<SharedStringBody>, StreamingResponse>;
+
+#endif
@@ -5,38 +5,117 @@
 #ifndef ROUTE_H
 #define ROUTE_H
 
+#include <array>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <set>
-#include <regex>
 #include <stdexcept>
 #include <boost/beast/http/verb.hpp>
 
+/**
+ * @brief Значения параметров пути ({id} и т.п.) без выделения памяти.
+ *
+ * Имена смотрят в Route, значения - в target запроса, поэтому объект живёт не дольше запроса.
+ */
+class PathParams {
+public:
+    static constexpr size_t maxParams = 8;
+
+    void add(std::string_view name, std::string_view value) {
+        _items[_size++] = {name, value};
+    }
+
+    /**
+     * @throws std::out_of_range если параметра с таким именем нет в маршруте.
+     */
+    [[nodiscard]] std::string_view at(std::string_view name) const {
+        for (size_t i = 0; i < _size; ++i) {
+            if (_items[i].first == name) {
+                return _items[i].second;
+            }
+        }
+        throw std::out_of_range("Path parameter '" + std::string(name) + "' is not part of the route.");
+    }
+
+    [[nodiscard]] bool contains(std::string_view name) const {
+        for (size_t i = 0; i < _size; ++i) {
+            if (_items[i].first == name) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    [[nodiscard]] size_t size() const { return _size; }
+
+private:
+    std::array<std::pair<std::string_view, std::string_view>, maxParams> _items{};
+    size_t _size = 0;
+};
+
+/**
+ * @brief Один сегмент шаблона пути: литерал или параметр.
+ */
+struct RouteSegment {
+    std::string text; // литерал целиком или имя параметра без скобок
+    bool isParam = false;
+};
+
+/**
+ * @brief Где выполняется обработчик маршрута.
+ *
+ * io - прямо в потоке io_context: быстрые обработчики, которым лишний переход между потоками дороже самой работы.
+ * compute - в отдельном пуле вычислений: всё, что считает по всем строкам датасета или ждёт диска.
+ */
+enum class RouteExecution {
+    io,
+    compute
+};
+
 class Route {
     std::string _pathTemplate;            // Оригинальный путь, например "/datasets/{id}"
-    std::regex _pathRegex;                // Скомпилированный regex, например "/datasets/([^/]+)"
+    std::vector<RouteSegment> _segments;  // Разобранный шаблон, например {"datasets", {id}}
     std::vector<std::string> _paramNames; // Имена параметров, например {"id"}
 
 public:
     const std::set<http::verb> methods;
+    const RouteExecution execution;
+
+    explicit Route(std::string pathTemplate, std::set<http::verb> methods, RouteExecution execution = RouteExecution::io)
+        : _pathTemplate(std::move(pathTemplate)), methods(std::move(methods)), execution(execution) {
 
-    explicit Route(std::string pathTemplate, std::set<http::verb> methods)
-        : _pathTemplate(pathTemplate), methods(std::move(methods)) {
+        if (!_pathTemplate.starts_with('/')) {
+            throw std::logic_error("Route must start with '/': " + _pathTemplate);
+        }
 
-        std::string regexString = "^" + pathTemplate + "$";
-        std::regex paramRegex("\\{([^}]+)\\}");
-        auto wordsBegin = std::sregex_iterator(pathTemplate.begin(), pathTemplate.end(), paramRegex);
-        auto wordsEnd = std::sregex_iterator();
+        std::string_view rest = _pathTemplate;
+        rest.remove_prefix(1);
+        for (;;) {
+            const auto slash = rest.find('/');
+            const std::string_view segment = rest.substr(0, slash);
 
-        for (std::sregex_iterator i = wordsBegin; i != wordsEnd; ++i) {
-            _paramNames.push_back((*i)[1].str());
+            if (segment.size() > 2 && segment.front() == '{' && segment.back() == '}') {
+                _paramNames.emplace_back(segment.substr(1, segment.size() - 2));
+                _segments.push_back({_paramNames.back(), true});
+            } else if (segment.find_first_of("{}") != std::string_view::npos) {
+                throw std::logic_error("Path parameter must occupy a whole segment: " + _pathTemplate);
+            } else {
+                _segments.push_back({std::string(segment), false});
+            }
+
+            if (slash == std::string_view::npos) {
+                break;
+            }
+            rest.remove_prefix(slash + 1);
         }
 
-        regexString = std::regex_replace(regexString, paramRegex, "([^/]+)");
-        _pathRegex = std::regex(regexString);
+        if (_paramNames.size() > PathParams::maxParams) {
+            throw std::logic_error("Too many path parameters in route: " + _pathTemplate);
+        }
     }
     [[nodiscard]] const std::string& getPathTemplate() const { return _pathTemplate; }
-    [[nodiscard]] const std::regex& getPathRegex() const { return _pathRegex; }
+    [[nodiscard]] const std::vector<RouteSegment>& getSegments() const { return _segments; }
     [[nodiscard]] const std::vector<std::string>& getParamNames() const { return _paramNames; }
 
     bool operator<(const Route& other) const {
@@ -44,4 +123,4 @@ public:
     }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,133 @@
+#ifndef ROUTETRIE_HPP
+#define ROUTETRIE_HPP
+
+#include <array>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "api/IController.hpp"
+
+/**
+ * @brief Префиксное дерево маршрутов по сегментам пути.
+ *
+ * Строится один раз при регистрации контроллеров; поиск идёт по string_view сегментам target,
+ * без regex и без выделения памяти. Литеральный сегмент приоритетнее параметра: "/datasets/memory"
+ * выигрывает у "/datasets/{id}" независимо от порядка регистрации. Если ветка литерала не дала
+ * совпадения, поиск возвращается и пробует параметр.
+ */
+class RouteTrie {
+    struct Endpoint {
+        http::verb method;
+        const RouteHandler* routeHandler;
+    };
+
+    struct Node {
+        std::vector<std::pair<std::string, std::unique_ptr<Node>>> literals;
+        std::unique_ptr<Node> param;
+        std::vector<Endpoint> endpoints;
+    };
+
+    using Captures = std::array<std::string_view, PathParams::maxParams>;
+
+    Node _root;
+
+public:
+    /**
+     * @brief Добавляет маршрут. routeHandler должен жить дольше дерева.
+     * @throws std::logic_error если путь с тем же методом уже зарегистрирован.
+     */
+    void insert(const RouteHandler& routeHandler) {
+        Node* node = &_root;
+        for (const auto& segment : routeHandler.route.getSegments()) {
+            node = segment.isParam ? paramChild(*node) : literalChild(*node, segment.text);
+        }
+
+        for (const auto method : routeHandler.route.methods) {
+            for (const auto& endpoint : node->endpoints) {
+                if (endpoint.method == method) {
+                    throw std::logic_error("Duplicate route registered: " + std::string(http::to_string(method)) + ":"
+                                           + routeHandler.route.getPathTemplate() + " (conflicts with "
+                                           + endpoint.routeHandler->route.getPathTemplate() + ")");
+                }
+            }
+            node->endpoints.push_back({method, &routeHandler});
+        }
+    }
+
+    /**
+     * @brief Ищет обработчик для пути (без query) и метода, заполняя params.
+     * @param pathMatched выставляется, если путь совпал с каким-то маршрутом, но не с методом.
+     * @return nullptr, если подходящего маршрута нет.
+     */
+    const RouteHandler* find(std::string_view path, http::verb method, PathParams& params, bool& pathMatched) const {
+        if (!path.starts_with('/')) {
+            return nullptr;
+        }
+
+        Captures captures;
+        const RouteHandler* found = match(_root, path, 1, method, captures, 0, pathMatched);
+        if (found) {
+            const auto& names = found->route.getParamNames();
+            for (size_t i = 0; i < names.size(); ++i) {
+                params.add(names[i], captures[i]);
+            }
+        }
+        return found;
+    }
+
+private:
+    static Node* literalChild(Node& node, const std::string& text) {
+        for (auto& [literal, child] : node.literals) {
+            if (literal == text) {
+                return child.get();
+            }
+        }
+        return node.literals.emplace_back(text, std::make_unique<Node>()).second.get();
+    }
+
+    static Node* paramChild(Node& node) {
+        if (!node.param) {
+            node.param = std::make_unique<Node>();
+        }
+        return node.param.get();
+    }
+
+    // position - начало очередного сегмента, npos - путь разобран целиком
+    static const RouteHandler* match(const Node& node, std::string_view path, size_t position, http::verb method,
+                                     Captures& captures, size_t captured, bool& pathMatched) {
+        if (position == std::string_view::npos) {
+            for (const auto& endpoint : node.endpoints) {
+                if (endpoint.method == method) {
+                    return endpoint.routeHandler;
+                }
+            }
+            pathMatched = pathMatched || !node.endpoints.empty();
+            return nullptr;
+        }
+
+        const auto slash = path.find('/', position);
+        const std::string_view segment = path.substr(position, slash - position);
+        const size_t next = slash == std::string_view::npos ? slash : slash + 1;
+
+        for (const auto& [literal, child] : node.literals) {
+            if (literal == segment) {
+                if (const auto* found = match(*child, path, next, method, captures, captured, pathMatched)) {
+                    return found;
+                }
+                break;
+            }
+        }
+
+        // параметр, как и прежний "([^/]+)", не совпадает с пустым сегментом
+        if (node.param && !segment.empty() && captured < captures.size()) {
+            captures[captured] = segment;
+            return match(*node.param, path, next, method, captures, captured + 1, pathMatched);
+        }
+        return nullptr;
+    }
+};
+
+#endif
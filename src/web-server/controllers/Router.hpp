@@ -5,72 +5,218 @@
 #ifndef CONTROLLER_H
 #define CONTROLLER_H
 
+#include <chrono>
+#include <deque>
+#include <unordered_map>
+
 #include "../server_types.h"
+#include "../../util/metrics/MetricsRegistry.hpp"
+#include "RouteTrie.hpp"
+#include "WorkerPools.hpp"
 #include "api/IController.hpp"
 
+/**
+ * @brief Счётчики одного маршрута; пишутся из любых потоков без блокировок.
+ */
+struct RouteMetrics {
+    std::string route;   // шаблон пути, "unmatched" - запросы без маршрута
+    std::string methods; // через запятую, как в Allow
+    std::array<Metrics::Counter, 5> responses; // по классам статуса 1xx..5xx
+    Metrics::Counter responseBytes;
+    Metrics::Gauge inFlight;
+    Metrics::LatencyHistogram latencyUs; // от разбора запроса до готового ответа, включая очередь пула вычислений
+};
+
+/**
+ * @brief Принимает соединение, запросившее Upgrade: websocket; дальше соединением владеет обработчик.
+ */
+using WebSocketHandler = std::function<void(beast::tcp_stream&& stream, http::request<http::string_body>&& request)>;
+
 class Router {
     std::vector<std::unique_ptr<IController>> _controllers;
-    // Для быстрой проверки дубликатов путей при запуске
-    std::set<std::string> _registeredPaths;
+    // точные пути WebSocket; заполняются при запуске, как и маршруты
+    std::unordered_map<std::string, WebSocketHandler> _webSocketEndpoints;
+    // Маршруты всех контроллеров, собранные при запуске; обработчики живут в _controllers
+    RouteTrie _routes;
+    std::shared_ptr<WorkerPools> _pools;
+    // заполняется в addController и дальше только читается, поэтому поиск идёт без блокировок
+    std::deque<RouteMetrics> _routeMetrics;
+    std::unordered_map<const RouteHandler*, RouteMetrics*> _metricsByHandler;
+    RouteMetrics& _unmatchedMetrics;
 
 public:
-    Router() = default;
+    Router(std::shared_ptr<WorkerPools> pools, Metrics::MetricsRegistry& metrics)
+        : _pools(std::move(pools)), _unmatchedMetrics(_routeMetrics.emplace_back()) {
+        _unmatchedMetrics.route = "unmatched";
+        metrics.addCollector([this](Metrics::PrometheusWriter& w) { writeMetrics(w); });
+    }
+
+    Router(const Router&) = delete;
+    Router& operator=(const Router&) = delete;
 
     template<typename TController, typename... Args>
     void addController(Args&&... args) {
         auto controller = std::make_unique<TController>(std::forward<Args>(args)...);
 
+        // дубликаты путей ловит само дерево
         for (const auto& handler : controller->getRouteHandlers()) {
-            const std::string& path = handler.route.getPathTemplate();
-            for (const auto& method : handler.route.methods) {
-                std::string uniqueIdentifier = std::string(http::to_string(method)) + ":" + path;
-                if (_registeredPaths.contains(uniqueIdentifier)) {
-                    throw std::logic_error("Duplicate route registered: " + uniqueIdentifier);
-                }
-                _registeredPaths.insert(uniqueIdentifier);
+            _routes.insert(handler);
+
+            RouteMetrics& metrics = _routeMetrics.emplace_back();
+            metrics.route = handler.route.getPathTemplate();
+            for (const auto method : handler.route.methods) {
+                metrics.methods += (metrics.methods.empty() ? "" : ",") + std::string(http::to_string(method));
             }
+            _metricsByHandler.emplace(&handler, &metrics);
         }
         _controllers.push_back(std::move(controller));
     }
 
-    http::response<http::string_body> handleRequest(const http::request<http::string_body>& req) {
+    void addWebSocketEndpoint(const std::string& path, WebSocketHandler handler) {
+        if (!_webSocketEndpoints.emplace(path, std::move(handler)).second) {
+            throw std::logic_error("WebSocket endpoint '" + path + "' is already registered");
+        }
+    }
+
+    /**
+     * @return Обработчик WebSocket для пути запроса (строка запроса не учитывается) или nullptr.
+     */
+    [[nodiscard]] const WebSocketHandler* findWebSocketEndpoint(std::string_view target) const {
+        target = target.substr(0, target.find('?'));
+        const auto it = _webSocketEndpoints.find(std::string(target));
+        return it != _webSocketEndpoints.end() ? &it->second : nullptr;
+    }
+
+    /**
+     * @brief Находит обработчик и передаёт его ответ в done.
+     *
+     * Обработчики RouteExecution::io и ответы об ошибках маршрутизации вызывают done сразу, в текущем
+     * потоке. Обработчики RouteExecution::compute выполняются в пуле вычислений, а done вызывается через
+     * executor (strand сессии). Маршрут с chooseExecution выбирает одно из двух для каждого запроса.
+     * req должен жить до вызова done.
+     */
+    template<typename Done>
+    void handleRequest(const http::request<http::string_body>& req, net::any_io_executor executor, Done done) {
         std::string_view target_path = req.target();
         auto query_pos = target_path.find('?');
         if (query_pos != std::string_view::npos) {
             target_path = target_path.substr(0, query_pos);
         }
 
+        RequestCtx ctx{req};
         bool path_matched = false;
-        for (const auto& controller : _controllers) {
-            for (const auto& routeHandler : controller->getRouteHandlers()) {
-                std::smatch match;
-                std::string target_str(target_path);
-
-                if (std::regex_match(target_str, match, routeHandler.route.getPathRegex())) {
-                    path_matched = true;
-                    if (routeHandler.route.methods.contains(req.method())) {
-                        // НАШЛИ ПОЛНОЕ СОВПАДЕНИЕ (путь + метод)!
-
-                        // собираем контекст
-                        RequestCtx ctx{req};
-                        const auto& paramNames = routeHandler.route.getParamNames();
-                        for (size_t i = 0; i < paramNames.size(); ++i) {
-                            ctx.pathParams[paramNames[i]] = match[i + 1].str();
-                        }
-
-                        // передаем управление контроллеру
-                        return controller->dispatch(routeHandler.route, ctx);
-                    }
+        const RouteHandler* routeHandler = _routes.find(target_path, req.method(), ctx.pathParams, path_matched);
+
+        RouteMetrics& metrics = routeHandler ? *_metricsByHandler.at(routeHandler) : _unmatchedMetrics;
+        metrics.inFlight.add(1);
+        auto finish = [&metrics, start = std::chrono::steady_clock::now(), done = std::move(done)](ApiResponse res) mutable {
+            recordResponse(metrics, res, start);
+            done(std::move(res));
+        };
+
+        if (!routeHandler) {
+            // если мы здесь - значит полного совпадения не найдено
+            return finish(path_matched ? ApiResponse(IController::methodNotAllowed()) : ApiResponse(IController::notFound("Route not found")));
+        }
+
+        const RouteExecution execution = routeHandler->chooseExecution ? routeHandler->chooseExecution(ctx)
+                                                                       : routeHandler->route.execution;
+        if (execution == RouteExecution::io) {
+            return _pools->runOnIo([&] { finish(invoke(*routeHandler, ctx)); });
+        }
+
+        const bool accepted = _pools->runOnCompute(std::move(executor),
+                                                   [routeHandler, ctx] { return invoke(*routeHandler, ctx); },
+                                                   finish);
+        if (!accepted) {
+            finish(IController::serviceUnavailable("Server is busy, retry later"));
+        }
+    }
+
+private:
+    static void recordResponse(RouteMetrics& metrics, ApiResponse& res, std::chrono::steady_clock::time_point start) {
+        metrics.inFlight.add(-1);
+        metrics.latencyUs.record(static_cast<u64>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count()));
+
+        std::visit([&metrics]<typename Response>(Response& response) {
+            unsigned status;
+            if constexpr (std::is_same_v<Response, StreamingResponse>) {
+                status = response.header.result_int();
+                // размер потокового тела известен только по мере отправки: считаем порции,
+                // которые источник дописывает в пустой буфер
+                response.nextChunk = [&metrics, next = std::move(response.nextChunk)](std::string& out) {
+                    const bool more = next(out);
+                    metrics.responseBytes.add(out.size());
+                    return more;
+                };
+            } else {
+                status = response.result_int();
+                if constexpr (std::is_same_v<Response, http::response<SharedStringBody>>) {
+                    metrics.responseBytes.add(response.body() ? response.body()->size() : 0);
+                } else {
+                    metrics.responseBytes.add(response.body().size());
+                }
+            }
+            metrics.responses[std::clamp(status / 100, 1u, 5u) - 1].add();
+        }, res);
+    }
+
+    void writeMetrics(Metrics::PrometheusWriter& w) const {
+        static constexpr std::array<std::string_view, 5> statusClasses{"1xx", "2xx", "3xx", "4xx", "5xx"};
+
+        w.family("neuro_http_responses_total", "counter", "HTTP responses by route and status class.");
+        for (const auto& metrics : _routeMetrics) {
+            for (size_t i = 0; i < statusClasses.size(); ++i) {
+                if (const u64 count = metrics.responses[i].value(); count != 0) {
+                    w.sample("neuro_http_responses_total", {{"route", metrics.route}, {"method", metrics.methods}, {"code", statusClasses[i]}}, count);
                 }
             }
         }
 
-        // если мы здесь - значит полного совпадения не найдено
-        if (path_matched) {
-            return IController::methodNotAllowed();
+        w.family("neuro_http_response_bytes_total", "counter", "Response body bytes by route.");
+        for (const auto& metrics : _routeMetrics) {
+            w.sample("neuro_http_response_bytes_total", {{"route", metrics.route}, {"method", metrics.methods}}, metrics.responseBytes.value());
+        }
+
+        w.family("neuro_http_requests_in_flight", "gauge", "Requests accepted but not yet answered, by route.");
+        for (const auto& metrics : _routeMetrics) {
+            w.sample("neuro_http_requests_in_flight", {{"route", metrics.route}, {"method", metrics.methods}}, metrics.inFlight.value());
         }
 
-        return IController::notFound("Route not found");
+        // снимки берутся один раз: по ним пишутся и корзины, и перцентили
+        std::vector<Metrics::HistogramSnapshot> snapshots;
+        snapshots.reserve(_routeMetrics.size());
+        for (const auto& metrics : _routeMetrics) {
+            snapshots.push_back(metrics.latencyUs.snapshot());
+        }
+
+        w.family("neuro_http_request_duration_seconds", "histogram", "Time from a parsed request to a ready response, by route.");
+        for (size_t i = 0; i < _routeMetrics.size(); ++i) {
+            w.histogram("neuro_http_request_duration_seconds", {{"route", _routeMetrics[i].route}, {"method", _routeMetrics[i].methods}},
+                        snapshots[i], 1e6, {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10});
+        }
+
+        w.family("neuro_http_request_duration_quantile_seconds", "gauge", "Latency percentiles from the route's HDR histogram (about 6% precision).");
+        for (size_t i = 0; i < _routeMetrics.size(); ++i) {
+            if (snapshots[i].count == 0) {
+                continue;
+            }
+            for (const auto& [label, q] : {std::pair{"0.5", 0.5}, {"0.9", 0.9}, {"0.99", 0.99}, {"0.999", 0.999}}) {
+                w.sample("neuro_http_request_duration_quantile_seconds",
+                         {{"route", _routeMetrics[i].route}, {"method", _routeMetrics[i].methods}, {"quantile", label}},
+                         static_cast<double>(snapshots[i].quantile(q)) / 1e6);
+            }
+        }
+    }
+
+    // исключение, не пойманное обработчиком, превращается в 500, а не оставляет запрос без ответа
+    static ApiResponse invoke(const RouteHandler& routeHandler, const RequestCtx& ctx) {
+        try {
+            return routeHandler.handler(ctx);
+        } catch (const std::exception& e) {
+            return IController::createErrorResponse(http::status::internal_server_error, e.what());
+        }
     }
 };
 #endif //CONTROLLER_H
@@ -0,0 +1,103 @@
+#ifndef WORKERPOOLS_HPP
+#define WORKERPOOLS_HPP
+
+#include <atomic>
+
+#include "../server_types.h"
+#include "../../util/concurrency/ThreadPool.hpp"
+#include "../../util/types/types.hpp"
+
+/**
+ * @brief Снимок загрузки одного пула для мониторинга.
+ */
+struct WorkerPoolStats {
+    size_t threads = 0;
+    size_t queued = 0;   // ждут свободного потока
+    size_t active = 0;   // выполняются прямо сейчас
+    u64 completed = 0;
+    u64 rejected = 0;    // не приняты из-за переполненной очереди
+    size_t queueLimit = 0;
+};
+
+/**
+ * @brief Потоки io_context и ограниченный пул вычислений, в который уходят тяжёлые обработчики.
+ *
+ * У io_context нет своей очереди, которую можно измерить, поэтому для него считаются
+ * обработчики, выполняющиеся в потоках io, и готовые ответы пула вычислений, ещё не забранные
+ * strand'ом сессии.
+ */
+class WorkerPools {
+    size_t _ioThreads;
+    size_t _computeQueueLimit;
+    std::atomic<size_t> _ioActive{0};
+    std::atomic<size_t> _ioQueued{0};
+    std::atomic<u64> _ioCompleted{0};
+    std::atomic<u64> _computeRejected{0};
+    // последним: деструктор пула дожидается задач, которые обращаются к счётчикам выше
+    Concurrency::ThreadPool _compute;
+
+public:
+    WorkerPools(size_t ioThreads, u32 computeThreads, size_t computeQueueLimit)
+        : _ioThreads(ioThreads), _computeQueueLimit(computeQueueLimit), _compute(computeThreads) {}
+
+    /**
+     * @brief Выполняет fn в текущем потоке io, учитывая его в статистике.
+     */
+    template<typename Fn>
+    decltype(auto) runOnIo(Fn&& fn) {
+        _ioActive.fetch_add(1, std::memory_order_relaxed);
+        struct Finish {
+            WorkerPools& pools;
+            ~Finish() {
+                pools._ioActive.fetch_sub(1, std::memory_order_relaxed);
+                pools._ioCompleted.fetch_add(1, std::memory_order_relaxed);
+            }
+        } finish{*this};
+        return fn();
+    }
+
+    /**
+     * @brief Выполняет work в пуле вычислений и передаёт результат done через executor.
+     * @return false, если очередь пула заполнена; тогда ни work, ни done не вызываются.
+     */
+    template<typename Work, typename Done>
+    bool runOnCompute(net::any_io_executor executor, Work work, Done done) {
+        const bool accepted = _compute.trySubmit(
+            [this, executor = std::move(executor), work = std::move(work), done = std::move(done)]() mutable {
+                auto result = work();
+                _ioQueued.fetch_add(1, std::memory_order_relaxed);
+                net::post(executor, [this, done = std::move(done), result = std::move(result)]() mutable {
+                    _ioQueued.fetch_sub(1, std::memory_order_relaxed);
+                    runOnIo([&] { done(std::move(result)); });
+                });
+            },
+            _computeQueueLimit);
+
+        if (!accepted) {
+            _computeRejected.fetch_add(1, std::memory_order_relaxed);
+        }
+        return accepted;
+    }
+
+    [[nodiscard]] WorkerPoolStats ioStats() const {
+        return {
+            .threads = _ioThreads,
+            .queued = _ioQueued.load(std::memory_order_relaxed),
+            .active = _ioActive.load(std::memory_order_relaxed),
+            .completed = _ioCompleted.load(std::memory_order_relaxed),
+        };
+    }
+
+    [[nodiscard]] WorkerPoolStats computeStats() const {
+        return {
+            .threads = _compute.threadCount(),
+            .queued = _compute.queueDepth(),
+            .active = _compute.activeCount(),
+            .completed = _compute.completedCount(),
+            .rejected = _computeRejected.load(std::memory_order_relaxed),
+            .queueLimit = _computeQueueLimit,
+        };
+    }
+};
+
+#endif
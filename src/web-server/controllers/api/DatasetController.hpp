@@ -4,37 +4,242 @@
 
 #ifndef DATASETCONTROLLER_H
 #define DATASETCONTROLLER_H
+#include <algorithm>
+#include <cmath>
 #include <filesystem>
+#include <format>
+#include <ranges>
 #include "IController.hpp"
+#include "../../../service/ColumnStatsService.hpp"
 #include "../../../service/DatasetService.hpp"
+#include "../../../service/PageFrame.hpp"
 #include "../../../util/constants.hpp"
+#include "../../../util/cache/ShardedLruCache.hpp"
+#include "../../../util/hash/XxHash64.hpp"
+#include "../../../util/json/JsonWriter.hpp"
+#include "../../../util/metrics/MetricsRegistry.hpp"
 
 using StringResponse = http::response<http::string_body>;
+
+// бинарный колоночный кадр страницы, формат описан у appendPageFrame
+inline constexpr std::string_view pageFrameMediaType = "application/vnd.neuro.page-frame";
 using json = nlohmann::json;
 namespace fs = std::filesystem;
 
+// курсор страницы - номер её первой строки; для клиента это непрозрачная строка
+inline std::string encodePageCursor(size_t firstRow) {
+    return std::format("{:x}", firstRow);
+}
+
+inline std::optional<size_t> decodePageCursor(std::string_view cursor) {
+    size_t firstRow = 0;
+    const auto [end, ec] = std::from_chars(cursor.data(), cursor.data() + cursor.size(), firstRow, 16);
+    if (cursor.empty() || ec != std::errc() || end != cursor.data() + cursor.size()) {
+        return std::nullopt;
+    }
+    return firstRow;
+}
+
+// курсор следующей страницы или пустая строка, если это последняя
+inline std::string nextPageCursor(const DatasetPageView& view) {
+    const size_t end = view.firstRow + view.rowCount;
+    return view.rowCount > 0 && end < view.dataset->rowCount ? encodePageCursor(end) : std::string();
+}
+
 // --- JSON Сериализация для наших структур данных ---
-// Это специальная функция, которую nlohmann::json находит сам
-// и использует для преобразования наших кастомных структур в JSON.
-inline void to_json(json& j, const PaginatedData& p) {
-    j = json{
-        {"id", p.id},
-        {"name", p.name},
-        {"page", p.page},
-        {"pageSize", p.pageSize},
-        {"totalPages", p.totalPages},
-        {"totalRows", p.totalRows},
-        {"headers", p.headers},
-        {"data", p.data}
-    };
+// Горячие ответы пишутся JsonWriter'ом прямо в тело ответа, без промежуточного дерева nlohmann::json.
+inline void writePageMetadata(JsonWriter& w, const std::string& id, const std::string& name, u32 page, u32 pageSize,
+                              u32 totalPages, size_t totalRows, const std::vector<std::string>& headers) {
+    w.field("id", id)
+     .field("name", name)
+     .field("page", page)
+     .field("pageSize", pageSize)
+     .field("totalPages", totalPages)
+     .field("totalRows", totalRows)
+     .key("headers").array(headers);
+}
+
+inline void writeJson(JsonWriter& w, const PaginatedData& p) {
+    w.beginObject();
+    writePageMetadata(w, p.id, p.name, p.page, p.pageSize, p.totalPages, p.totalRows, p.headers);
+    w.key("data").beginArray();
+    for (const auto& row : p.data) {
+        w.array(row);
+    }
+    w.endArray().endObject();
+}
+
+inline void writeJson(JsonWriter& w, const DatasetMemoryInfo& m) {
+    w.beginObject()
+     .field("id", m.id)
+     .field("name", m.name)
+     .field("memoryBytes", m.memoryBytes)
+     .field("spilled", m.spilled)
+     .endObject();
+}
+
+inline void writeJson(JsonWriter& w, const MemoryUsage& u) {
+    w.beginObject()
+     .field("budgetBytes", u.budgetBytes)
+     .field("residentBytes", u.residentBytes)
+     .key("datasets").beginArray();
+    for (const auto& dataset : u.datasets) {
+        writeJson(w, dataset);
+    }
+    w.endArray().endObject();
+}
+
+inline std::string_view toString(DatasetLoadMode mode) {
+    switch (mode) {
+        case DatasetLoadMode::IN_MEMORY: return "memory";
+        case DatasetLoadMode::LAZY: return "lazy";
+    }
+    return "unknown";
+}
+
+inline std::string_view toString(LoadJobState state) {
+    switch (state) {
+        case LoadJobState::QUEUED: return "queued";
+        case LoadJobState::RUNNING: return "running";
+        case LoadJobState::COMPLETED: return "completed";
+        case LoadJobState::FAILED: return "failed";
+    }
+    return "unknown";
+}
+
+inline void writeJson(JsonWriter& w, const LoadJobStatus& s) {
+    w.beginObject()
+     .field("jobId", s.id)
+     .field("filePath", s.filePath)
+     .field("mode", toString(s.mode))
+     .field("state", toString(s.state))
+     .field("totalBytes", s.totalBytes)
+     .field("bytesProcessed", s.bytesProcessed)
+     .field("rowsProcessed", s.rowsProcessed);
+    if (s.state == LoadJobState::COMPLETED) {
+        w.field("datasetId", s.datasetId);
+    }
+    if (s.state == LoadJobState::FAILED) {
+        w.field("error", s.error);
+    }
+    w.endObject();
+}
+
+inline std::string_view toString(ColumnType type) {
+    switch (type) {
+        case ColumnType::I64: return "i64";
+        case ColumnType::F32: return "f32";
+        case ColumnType::F64: return "f64";
+        case ColumnType::STRING: return "string";
+    }
+    return "unknown";
+}
+
+inline void writeJson(JsonWriter& w, const ColumnStatistics& c) {
+    w.beginObject()
+     .field("name", c.name)
+     .field("type", toString(c.type))
+     .field("count", c.count)
+     .field("nulls", c.nulls)
+     .field("distinct", c.distinct)
+     .field("distinctExact", c.distinctExact);
+    if (c.nonFinite > 0) {
+        w.field("nonFinite", c.nonFinite);
+    }
+    if (c.summary) {
+        w.field("min", c.summary->min)
+         .field("max", c.summary->max)
+         .field("mean", c.summary->mean)
+         .field("variance", c.summary->variance)
+         .field("stddev", std::sqrt(c.summary->variance));
+    }
+    if (c.histogram) {
+        w.key("histogram").beginObject()
+         .field("lower", c.histogram->lower)
+         .field("upper", c.histogram->upper)
+         .key("counts").array(c.histogram->counts)
+         .endObject();
+    }
+    w.endObject();
+}
+
+inline void writeJson(JsonWriter& w, const DatasetStatistics& s) {
+    w.beginObject()
+     .field("id", s.datasetId)
+     .field("rows", s.rows)
+     .field("bins", s.bins)
+     .field("computeMs", s.computeMs)
+     .key("columns").beginArray();
+    for (const auto& column : s.columns) {
+        writeJson(w, column);
+    }
+    w.endArray().endObject();
 }
 
+/**
+ * @brief Сериализует страницу в JSON порциями прямо из колонок (или файла) датасета.
+ *
+ * Формат совпадает с writeJson(PaginatedData), но строки не копируются в промежуточные
+ * структуры: каждый вызов вычисляет столько строк, сколько помещается в одну порцию.
+ */
+class PageJsonSource {
+    DatasetPageView _view;
+    size_t _rowsWritten = 0;
+    size_t _rowsPerBatch = 64; // подстраивается под средний размер строки
+    bool _prefixWritten = false;
+
+public:
+    explicit PageJsonSource(DatasetPageView view) : _view(std::move(view)) {}
+
+    bool operator()(std::string& buffer) {
+        if (!_prefixWritten) {
+            writePrefix(buffer);
+            _prefixWritten = true;
+        }
+
+        while (buffer.size() < streamingChunkBytes && _rowsWritten < _view.rowCount) {
+            const size_t batch = std::min(_rowsPerBatch, _view.rowCount - _rowsWritten);
+            const size_t before = buffer.size();
+            _view.plan->readRows(_view.firstRow + _rowsWritten, batch, [&](std::span<const std::string_view> cells) {
+                if (_rowsWritten++ > 0) {
+                    buffer += ',';
+                }
+                JsonWriter(buffer).array(cells);
+            });
+            const size_t bytesPerRow = std::max<size_t>((buffer.size() - before) / batch, 1);
+            _rowsPerBatch = std::clamp<size_t>(streamingChunkBytes / bytesPerRow, 1, 65536);
+        }
+
+        if (_rowsWritten < _view.rowCount) {
+            return true;
+        }
+        buffer += "]}";
+        return false;
+    }
+
+private:
+    void writePrefix(std::string& buffer) const {
+        const Dataset& dataset = *_view.dataset;
+        JsonWriter w(buffer);
+        w.beginObject();
+        writePageMetadata(w, dataset.id, dataset.name, _view.page, _view.pageSize, _view.totalPages, dataset.rowCount, _view.plan->headers());
+        w.field("firstRow", _view.firstRow);
+        if (const auto cursor = nextPageCursor(_view); !cursor.empty()) {
+            w.field("nextCursor", cursor);
+        }
+        w.key("data").beginArray();
+    }
+};
 
 class DatasetController : public IController {
     std::shared_ptr<DatasetService> _datasetService;
+    std::shared_ptr<ColumnStatsService> _statsService;
+    // готовые тела страниц по ключу "id|первая строка|pageSize|колонки|тип"
+    Cache::ShardedLruCache<std::shared_ptr<const std::string>> _pageCache{FRAMEWORK_CONSTANTS::pageCacheBytes};
 
 public:
-    explicit DatasetController(std::shared_ptr<DatasetService> service)
+    DatasetController(std::shared_ptr<DatasetService> service, std::shared_ptr<ColumnStatsService> statsService,
+                      const std::shared_ptr<Metrics::MetricsRegistry>& metrics)
         : IController({
               // Получить список доступных .csv файлов на диске
               {
@@ -46,44 +251,128 @@ public:
                   Route("/api/v1/datasets/loaded", {http::verb::get}),
                   [this](const RequestCtx& ctx) { return this->getLoadedDatasets(ctx); }
               },
-              // Загрузить датасет из файла в память
+              // Бюджет памяти реестра и учёт памяти по датасетам
+              {
+                  Route("/api/v1/datasets/memory", {http::verb::get}),
+                  [this](const RequestCtx& ctx) { return this->getMemoryUsage(ctx); }
+              },
+              // Поменять бюджет памяти; лишние датасеты сразу вытесняются на диск, поэтому в пуле вычислений
+              {
+                  Route("/api/v1/datasets/memory", {http::verb::put}, RouteExecution::compute),
+                  [this](const RequestCtx& ctx) { return this->setMemoryBudget(ctx); }
+              },
+              // Поставить загрузку датасета из файла в фоновую очередь
               {
                   Route("/api/v1/datasets/load", {http::verb::post}),
                   [this](const RequestCtx& ctx) { return this->loadNewDataset(ctx); }
               },
-              // Получить страницу данных из загруженного датасета
+              // Узнать состояние фоновой загрузки
+              {
+                  Route("/api/v1/jobs/{id}", {http::verb::get}),
+                  [this](const RequestCtx& ctx) { return this->getLoadJobById(ctx); }
+              },
+              // Получить страницу данных из загруженного датасета. Страница из колонок в памяти
+              // собирается в потоке io, а чтение файла и сборка строк по номерам - в пуле вычислений
               {
                   Route("/api/v1/datasets/{id}", {http::verb::get}),
-                  [this](const RequestCtx& ctx) { return this->getDatasetPageById(ctx); }
+                  [this](const RequestCtx& ctx) { return this->getDatasetPageById(ctx); },
+                  [this](const RequestCtx& ctx) {
+                      const auto dataset = _datasetService->getDatasetById(std::string(ctx.pathParams.at("id")));
+                      return dataset && pageNeedsCompute(*dataset) ? RouteExecution::compute : RouteExecution::io;
+                  }
               },
               // Выгрузить датасет из памяти
               {
                   Route("/api/v1/datasets/{id}", {http::verb::delete_}),
                   [this](const RequestCtx& ctx) { return this->unloadDatasetById(ctx); }
               },
-              // Сохранить текущий датасет под новым именем
+              // Статистика по колонкам: первый запрос проходит по всем колонкам - в пуле вычислений
+              {
+                  Route("/api/v1/datasets/{id}/stats", {http::verb::get}, RouteExecution::compute),
+                  [this](const RequestCtx& ctx) { return this->getDatasetStats(ctx); }
+              },
+              // Сохранить текущий датасет под новым именем (пишет файл целиком - в пуле вычислений)
               {
-                  Route("/api/v1/datasets/{id}/save-as", {http::verb::post}),
+                  Route("/api/v1/datasets/{id}/save-as", {http::verb::post}, RouteExecution::compute),
                   [this](const RequestCtx& ctx) { return this->handleSaveDatasetAs(ctx); }
               }
           }),
-          _datasetService(std::move(service)) {
+          _datasetService(std::move(service)),
+          _statsService(std::move(statsService)) {
+        metrics->addCollector([this](Metrics::PrometheusWriter& w) { writeMetrics(w); });
     }
 
 private:
+    void writeMetrics(Metrics::PrometheusWriter& w) {
+        const auto datasets = _datasetService->registryStats();
+        w.family("neuro_datasets", "gauge", "Loaded datasets by storage kind.")
+         .sample("neuro_datasets", {{"kind", "memory"}}, u64{datasets.datasets - datasets.lazyDatasets - datasets.plannedDatasets - datasets.spilledDatasets})
+         .sample("neuro_datasets", {{"kind", "lazy"}}, u64{datasets.lazyDatasets})
+         .sample("neuro_datasets", {{"kind", "planned"}}, u64{datasets.plannedDatasets})
+         .sample("neuro_datasets", {{"kind", "spilled"}}, u64{datasets.spilledDatasets})
+         .family("neuro_dataset_rows", "gauge", "Rows across all loaded datasets.")
+         .sample("neuro_dataset_rows", {}, datasets.rows)
+         .family("neuro_dataset_resident_bytes", "gauge", "Heap held by dataset columns, shared buffers counted once.")
+         .sample("neuro_dataset_resident_bytes", {}, u64{datasets.residentBytes})
+         .family("neuro_dataset_memory_budget_bytes", "gauge", "Heap budget before datasets are spilled to disk.")
+         .sample("neuro_dataset_memory_budget_bytes", {}, u64{datasets.budgetBytes})
+         .family("neuro_dataset_load_jobs", "gauge", "Background loads queued or running.")
+         .sample("neuro_dataset_load_jobs", {}, u64{datasets.activeLoadJobs});
+
+        const auto cache = _pageCache.stats();
+        w.family("neuro_page_cache_hits_total", "counter", "Page bodies served from the response cache.")
+         .sample("neuro_page_cache_hits_total", {}, cache.hits)
+         .family("neuro_page_cache_misses_total", "counter", "Page requests that had to be serialized.")
+         .sample("neuro_page_cache_misses_total", {}, cache.misses)
+         .family("neuro_page_cache_entries", "gauge", "Page bodies held in the response cache.")
+         .sample("neuro_page_cache_entries", {}, u64{cache.entries})
+         .family("neuro_page_cache_bytes", "gauge", "Bytes held in the response cache.")
+         .sample("neuro_page_cache_bytes", {}, u64{cache.bytes})
+         .family("neuro_page_cache_capacity_bytes", "gauge", "Response cache capacity.")
+         .sample("neuro_page_cache_capacity_bytes", {}, u64{cache.capacityBytes});
+
+        const auto stats = _statsService->cacheStats();
+        w.family("neuro_stats_cache_hits_total", "counter", "Column statistics served from the cache.")
+         .sample("neuro_stats_cache_hits_total", {}, stats.hits)
+         .family("neuro_stats_cache_misses_total", "counter", "Column statistics requests that had to scan the dataset.")
+         .sample("neuro_stats_cache_misses_total", {}, stats.misses);
+    }
+
     http::response<http::string_body> getAvailableDatasets(const RequestCtx& ctx) {
         auto files = _datasetService->listAvailableDatasets(FRAMEWORK_CONSTANTS::datasetsDirectory);
-        json responseBody = files;
-        return createJsonResponse(http::status::ok, responseBody);
+        return writeJsonResponse(http::status::ok, [&](JsonWriter& w) { w.array(files); });
     }
 
     http::response<http::string_body> getLoadedDatasets(const RequestCtx& ctx) {
         auto loadedList = _datasetService->loadedDatasetsList();
-        json responseBody = json::array();
-        for (const auto& [id, name]: loadedList) {
-            responseBody.push_back({{"id", id}, {"name", name}});
+        return writeJsonResponse(http::status::ok, [&](JsonWriter& w) {
+            w.beginArray();
+            for (const auto& [id, name]: loadedList) {
+                w.beginObject().field("id", id).field("name", name).endObject();
+            }
+            w.endArray();
+        });
+    }
+
+    http::response<http::string_body> getMemoryUsage(const RequestCtx& ctx) {
+        const auto usage = _datasetService->memoryUsage();
+        return writeJsonResponse(http::status::ok, [&](JsonWriter& w) { writeJson(w, usage); });
+    }
+
+    http::response<http::string_body> setMemoryBudget(const RequestCtx& ctx) {
+        try {
+            json requestBody = json::parse(ctx.originalRequest.body());
+            const auto budgetBytes = requestBody.at("budgetBytes").get<u64>();
+
+            _datasetService->setMemoryBudget(budgetBytes);
+
+            const auto usage = _datasetService->memoryUsage();
+            return writeJsonResponse(http::status::ok, [&](JsonWriter& w) { writeJson(w, usage); });
+        } catch (const json::parse_error& e) {
+            return createErrorResponse(http::status::bad_request, "Invalid JSON format: " + std::string(e.what()));
+        } catch (const json::exception& e) {
+            return createErrorResponse(http::status::bad_request, "JSON type error: " + std::string(e.what()));
         }
-        return createJsonResponse(http::status::ok, responseBody);
     }
 
     http::response<http::string_body> loadNewDataset(const RequestCtx& ctx) {
@@ -91,10 +380,26 @@ private:
             json requestBody = json::parse(ctx.originalRequest.body());
             std::string filePath = requestBody.at("filePath").get<std::string>();
 
-            std::string newId = _datasetService->loadDataset(filePath);
+            // "lazy" оставляет данные в файле и строит только индекс строк, по умолчанию файл читается целиком
+            const std::string modeName = requestBody.value("mode", std::string("memory"));
+            DatasetLoadMode mode;
+            if (modeName == "memory") {
+                mode = DatasetLoadMode::IN_MEMORY;
+            } else if (modeName == "lazy") {
+                mode = DatasetLoadMode::LAZY;
+            } else {
+                return createErrorResponse(http::status::bad_request, "Unknown load mode '" + modeName + "'. Expected 'memory' or 'lazy'.");
+            }
 
-            json responseBody = {{"datasetId", newId}};
-            return createJsonResponse(http::status::created, responseBody);
+            if (!fs::is_regular_file(filePath)) {
+                return createErrorResponse(http::status::not_found, "File '" + filePath + "' not found.");
+            }
+
+            // разбор идёт в фоне, клиент следит за ним через /api/v1/jobs/{id}
+            std::string jobId = _datasetService->startLoadJob(filePath, mode);
+
+            json responseBody = {{"jobId", jobId}};
+            return createJsonResponse(http::status::accepted, responseBody);
         } catch (const json::parse_error& e) {
             return createErrorResponse(http::status::bad_request, "Invalid JSON format: " + std::string(e.what()));
         } catch (const json::type_error& e) {
@@ -104,33 +409,198 @@ private:
         }
     }
 
-    http::response<http::string_body> getDatasetPageById(const RequestCtx& ctx) {
-        const auto& id = ctx.pathParams.at("id");
+    http::response<http::string_body> getLoadJobById(const RequestCtx& ctx) {
+        const std::string id(ctx.pathParams.at("id"));
+        auto job = _datasetService->getLoadJob(id);
+        if (!job) {
+            return createErrorResponse(http::status::not_found, "Job with id '" + id + "' not found.");
+        }
+        return writeJsonResponse(http::status::ok, [&](JsonWriter& w) { writeJson(w, *job); });
+    }
+
+    ApiResponse getDatasetPageById(const RequestCtx& ctx) {
+        const std::string id(ctx.pathParams.at("id"));
         auto queryParams = parseQueryString(ctx.originalRequest.target());
 
-        u32 page = 1;
-        u32 pageSize = 50;
+        DatasetPageRequest request;
 
         if (queryParams.contains("page")) {
-            std::from_chars(queryParams["page"].data(), queryParams["page"].data() + queryParams["page"].size(), page);
+            std::from_chars(queryParams["page"].data(), queryParams["page"].data() + queryParams["page"].size(), request.page);
         }
         if (queryParams.contains("pageSize")) {
             std::from_chars(queryParams["pageSize"].data(),
-                            queryParams["pageSize"].data() + queryParams["pageSize"].size(), pageSize);
+                            queryParams["pageSize"].data() + queryParams["pageSize"].size(), request.pageSize);
+        }
+        // курсор из nextCursor предыдущего ответа важнее номера страницы
+        if (queryParams.contains("cursor")) {
+            request.firstRow = decodePageCursor(queryParams["cursor"]);
+            if (!request.firstRow) {
+                return createErrorResponse(http::status::bad_request, "Invalid cursor '" + queryParams["cursor"] + "'.");
+            }
+        }
+        // проекция: columns=a,b,3 - только эти колонки, в этом порядке
+        if (queryParams.contains("columns")) {
+            for (const auto column : std::views::split(std::string_view(queryParams["columns"]), ',')) {
+                request.columns.push_back(decodeQueryComponent(std::string_view(column.begin(), column.end())));
+            }
         }
 
-        auto pageDataOpt = _datasetService->getDatasetPage(id, page, pageSize);
-        if (!pageDataOpt) {
+        const auto contentType = negotiateContentType(ctx.originalRequest[http::field::accept],
+                                                      {"application/json", pageFrameMediaType});
+        if (!contentType) {
+            return createErrorResponse(http::status::not_acceptable,
+                                       "Supported page formats: application/json, " + std::string(pageFrameMediaType) + ".");
+        }
+
+        std::optional<DatasetPageView> pageView;
+        try {
+            pageView = _datasetService->openDatasetPage(id, request);
+        } catch (const std::exception& e) {
+            return createErrorResponse(http::status::bad_request, e.what());
+        }
+        if (!pageView) {
             return createErrorResponse(http::status::not_found, "Dataset with id '" + id + "' not found.");
         }
 
-        json responseBody = *pageDataOpt;
-        return createJsonResponse(http::status::ok, responseBody);
+        // датасет после регистрации не меняется, а id не переиспользуются, поэтому тело страницы
+        // однозначно задаётся ключом - сильный ETag считается по ключу, без сериализации.
+        // Колонки в ключе - уже разрешённые номера, так что имя и номер колонки дают одну запись
+        std::string projection = "*";
+        if (!request.columns.empty()) {
+            projection.clear();
+            for (const u32 column : pageView->plan->columns()) {
+                std::format_to(std::back_inserter(projection), "{},", column);
+            }
+        }
+        std::string cacheKey = std::format("{}|{}|{}|{}|{}", pageView->dataset->id, pageView->firstRow, pageView->pageSize,
+                                           projection, *contentType);
+        const std::string etag = std::format("\"{:016x}\"", xxHash64(cacheKey.data(), cacheKey.size()));
+        const std::string nextCursor = nextPageCursor(*pageView);
+
+        if (ifNoneMatchHits(ctx.originalRequest[http::field::if_none_match], etag)) {
+            http::response<http::string_body> res{http::status::not_modified, 11};
+            setPageCacheHeaders(res, etag, nextCursor);
+            return res;
+        }
+
+        if (auto cached = _pageCache.get(cacheKey)) {
+            return createCachedPageResponse(std::move(*cached), *contentType, etag, nextCursor);
+        }
+
+        if (*contentType == pageFrameMediaType) {
+            // типизированные значения копируются из колонок прямо в тело ответа
+            auto body = std::make_shared<std::string>();
+            try {
+                appendPageFrame(*body, *pageView);
+            } catch (const std::exception& e) {
+                return createErrorResponse(http::status::bad_request, e.what());
+            }
+            _pageCache.put(std::move(cacheKey), body, body->size());
+            return createCachedPageResponse(std::move(body), *contentType, etag, nextCursor);
+        }
+
+        // страница с диска или из выбранных строк собирается целиком здесь, в пуле вычислений:
+        // потоковое тело читало бы файл в nextChunk, то есть на strand сессии
+        if (pageNeedsCompute(*pageView->dataset)) {
+            // источник дописывает порцию, только пока буфер меньше порции, поэтому порции копятся отдельно
+            auto body = std::make_shared<std::string>();
+            PageJsonSource source(std::move(*pageView));
+            std::string chunk;
+            for (bool more = true; more; chunk.clear()) {
+                more = source(chunk);
+                body->append(chunk);
+            }
+            _pageCache.put(std::move(cacheKey), body, body->size());
+            return createCachedPageResponse(std::move(body), *contentType, etag, nextCursor);
+        }
+
+        // строки сериализуются порциями по мере отправки, страница целиком в памяти не собирается;
+        // отправленные порции копятся для кэша, пока тело помещается в одну запись
+        auto res = createStreamingJsonResponse(http::status::ok,
+            [this, source = PageJsonSource(std::move(*pageView)), key = std::move(cacheKey),
+             copy = std::make_shared<std::string>()](std::string& buffer) mutable {
+                const bool more = source(buffer);
+                if (copy && copy->size() + buffer.size() <= _pageCache.maxValueBytes()) {
+                    copy->append(buffer);
+                } else {
+                    copy.reset();
+                }
+                if (!more && copy) {
+                    const size_t bytes = copy->size();
+                    _pageCache.put(std::move(key), std::move(copy), bytes);
+                }
+                return more;
+            });
+        setPageCacheHeaders(res.header, etag, nextCursor);
+        return res;
+    }
+
+    /**
+     * @brief true, если страница датасета читает файл (ленивый или вытесненный источник) или собирает
+     * строки по номерам плана - такую работу нельзя делать в потоке io.
+     */
+    static bool pageNeedsCompute(const Dataset& dataset) {
+        const Dataset& data = dataset.isPlanned() ? dataset.plan->source() : dataset;
+        return data.isLazy() || data.isSpilled() || (dataset.isPlanned() && dataset.plan->selectsRows());
+    }
+
+    template<typename Body>
+    static void setPageCacheHeaders(http::response<Body>& res, const std::string& etag, const std::string& nextCursor) {
+        res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+        res.set(http::field::etag, etag);
+        res.set(http::field::vary, "Accept");
+        // браузер хранит страницу, но каждый раз сверяет ETag
+        res.set(http::field::cache_control, "private, no-cache");
+        // бинарный кадр не несёт курсора, поэтому он дублируется заголовком для обоих форматов
+        if (!nextCursor.empty()) {
+            res.set("X-Next-Cursor", nextCursor);
+        }
+    }
+
+    static http::response<SharedStringBody> createCachedPageResponse(std::shared_ptr<const std::string> body,
+                                                                     std::string_view contentType, const std::string& etag,
+                                                                     const std::string& nextCursor) {
+        http::response<SharedStringBody> res{http::status::ok, 11};
+        setPageCacheHeaders(res, etag, nextCursor);
+        res.set(http::field::content_type, contentType);
+        res.body() = std::move(body);
+        res.prepare_payload();
+        return res;
+    }
+
+    http::response<http::string_body> getDatasetStats(const RequestCtx& ctx) {
+        const std::string id(ctx.pathParams.at("id"));
+        auto queryParams = parseQueryString(ctx.originalRequest.target());
+
+        u32 bins = FRAMEWORK_CONSTANTS::defaultHistogramBins;
+        if (queryParams.contains("bins")) {
+            const auto& value = queryParams["bins"];
+            const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), bins);
+            if (ec != std::errc() || end != value.data() + value.size() || bins < 1 || bins > FRAMEWORK_CONSTANTS::maxHistogramBins) {
+                return createErrorResponse(http::status::bad_request,
+                                           std::format("bins must be between 1 and {}.", FRAMEWORK_CONSTANTS::maxHistogramBins));
+            }
+        }
+
+        auto dataset = _datasetService->getDatasetById(id);
+        if (!dataset) {
+            return createErrorResponse(http::status::not_found, "Dataset with id '" + id + "' not found.");
+        }
+
+        try {
+            const auto stats = _statsService->statistics(dataset, bins);
+            return writeJsonResponse(http::status::ok, [&](JsonWriter& w) { writeJson(w, *stats); });
+        } catch (const std::exception& e) {
+            // у ленивого датасета колонок в памяти нет - статистика требует загрузки в память
+            return createErrorResponse(http::status::conflict, e.what());
+        }
     }
 
     http::response<http::string_body> unloadDatasetById(const RequestCtx& ctx) {
-        const auto& id = ctx.pathParams.at("id");
+        const std::string id(ctx.pathParams.at("id"));
         _datasetService->unloadDataset(id);
+        _pageCache.erasePrefix(id + "|");
+        _statsService->invalidate(id);
         http::response<http::string_body> res{http::status::no_content, ctx.originalRequest.version()};
         res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
         res.prepare_payload();
@@ -139,19 +609,29 @@ private:
 
     http::response<http::string_body> handleSaveDatasetAs(const RequestCtx& ctx) {
         try {
-            const auto& sourceId = ctx.pathParams.at("id");
+            const std::string sourceId(ctx.pathParams.at("id"));
             json requestBody = json::parse(ctx.originalRequest.body());
             std::string newName = requestBody.at("newName").get<std::string>();
+            // "snapshot" пишет бинарный колоночный файл, который потом открывается без разбора
+            const std::string format = requestBody.value("format", std::string("csv"));
 
-            // Шаг 1: Сохранить датасет в новый CSV файл
-            std::string newFilePath = _datasetService->saveDatasetToFile(sourceId, newName);
-
-            // Шаг 2: Загрузить этот новый файл в память, чтобы он стал доступен для работы
-            std::string newDatasetId = _datasetService->loadDataset(newFilePath);
+            // Шаг 1: Сохранить датасет в новый файл
+            std::string newFilePath;
+            if (format == "csv") {
+                newFilePath = _datasetService->saveDatasetToFile(sourceId, newName);
+            } else if (format == "snapshot") {
+                newFilePath = _datasetService->saveDatasetSnapshot(sourceId, newName);
+            } else {
+                return createErrorResponse(http::status::bad_request, "Unknown format '" + format + "'. Expected 'csv' or 'snapshot'.");
+            }
 
             // Получаем только имя файла для ответа
             std::string newDatasetName = fs::path(newFilePath).filename().string();
 
+            // Шаг 2: Зарегистрировать сохранённые данные как новый датасет. Колонки разделяют
+            // буферы с исходным датасетом, так что перечитывать только что записанный файл не нужно
+            std::string newDatasetId = _datasetService->copyAndRegisterDataset(sourceId, newDatasetName);
+
             json responseBody = {
                 {"newDatasetId", newDatasetId},
                 {"newDatasetName", newDatasetName}
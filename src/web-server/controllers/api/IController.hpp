@@ -4,23 +4,33 @@
 
 #ifndef ICONTROLLER_H
 #define ICONTROLLER_H
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <initializer_list>
+#include <optional>
 #include <set>
 #include <string>
 #include <nlohmann/json.hpp>
 
 #include "../../server_types.h"
+#include "../ApiResponse.hpp"
 #include "../Route.hpp"
+#include "../../../util/json/JsonWriter.hpp"
 
 struct RequestCtx {
     const http::request<http::string_body>& originalRequest;
-    std::map<std::string, std::string> pathParams;
+    PathParams pathParams;
 };
 
-using Handler = std::function<http::response<http::string_body>(const RequestCtx&)>;
+using Handler = std::function<ApiResponse(const RequestCtx&)>;
 
 struct RouteHandler {
     Route route;
     Handler handler;
+    // если задано, выбирает место выполнения для каждого запроса вместо route.execution;
+    // вызывается в потоке io, поэтому должно быть дешёвым
+    std::function<RouteExecution(const RequestCtx&)> chooseExecution{};
 };
 
 class IController {
@@ -33,30 +43,11 @@ public:
     explicit IController(std::vector<RouteHandler> handlers)
         : _routeHandlers(std::move(handlers)) {}
 
-    // геттер для роутера, чтобы он мог проверить уникальность путей
+    // геттер для роутера: он строит по этим маршрутам дерево и вызывает обработчики напрямую
     [[nodiscard]] const std::vector<RouteHandler>& getRouteHandlers() const {
         return _routeHandlers;
     }
 
-    // единственный метод, который вызывает Router
-    // он сам найдет нужный обработчик и вызовет его.
-    http::response<http::string_body> dispatch(const Route& matchedRoute, const RequestCtx& ctx) {
-        // роутер уже проверил совпадение метода, эта проверка для дополнительной надежности.
-        if (!matchedRoute.methods.contains(ctx.originalRequest.method())) {
-            return methodNotAllowed();
-        }
-
-        // находим нужный handler по шаблону пути.
-        // так как Router уже нашел совпадение, мы уверены, что handler здесь есть.
-        for (const auto&[route, handler] : _routeHandlers) {
-            if (route.getPathTemplate() == matchedRoute.getPathTemplate() && route.methods == matchedRoute.methods) {
-                return handler(ctx); // вызываем связанный обработчик
-            }
-        }
-
-        return internalError("Dispatcher failed to find a handler for a matched route.");
-    }
-
     static http::response<http::string_body> notFound(const std::string& reason) {
         http::response<http::string_body> res{http::status::not_found, 11};
         res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
@@ -84,6 +75,17 @@ public:
         return res;
     }
 
+    // очередь пула вычислений заполнена; клиент может повторить запрос позже
+    static http::response<http::string_body> serviceUnavailable(const std::string& reason) {
+        http::response<http::string_body> res{http::status::service_unavailable, 11};
+        res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+        res.set(http::field::content_type, "application/json");
+        res.set(http::field::retry_after, "1");
+        res.body() = R"({"error": ")" + reason + "\"}";
+        res.prepare_payload();
+        return res;
+    }
+
     static http::response<http::string_body> createJsonResponse(const http::status status, const nlohmann::json& body) {
         http::response<http::string_body> res{status, 11};
         res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
@@ -95,11 +97,127 @@ public:
         return res;
     }
 
+    // тело пишется JsonWriter'ом прямо в буфер ответа, без дерева nlohmann::json и dump()
+    template<typename Fn>
+    static http::response<http::string_body> writeJsonResponse(const http::status status, Fn&& write) {
+        http::response<http::string_body> res{status, 11};
+        res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+        res.set(http::field::content_type, "application/json");
+        JsonWriter writer(res.body());
+        write(writer);
+        res.prepare_payload();
+        return res;
+    }
+
+    // тело отдаётся порциями по мере отправки, без Content-Length
+    static StreamingResponse createStreamingJsonResponse(const http::status status, BodyChunkSource nextChunk) {
+        StreamingResponse res{http::response<http::empty_body>{status, 11}, std::move(nextChunk)};
+        res.header.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+        res.header.set(http::field::content_type, "application/json");
+        return res;
+    }
+
     static http::response<http::string_body> createErrorResponse(const http::status status, const std::string& message) {
         const nlohmann::json errorBody = {{"error", message}};
         return createJsonResponse(status, errorBody);
     }
 
+    /**
+     * @brief Выбирает тип ответа по заголовку Accept.
+     *
+     * Для каждого поддерживаемого типа берётся q самого конкретного подходящего диапазона:
+     * точный тип важнее диапазона группы, а тот - диапазона любых типов. Побеждает наибольший
+     * q > 0, при равенстве - первый в supported.
+     * @return Выбранный тип; первый из supported, если Accept пуст; std::nullopt, если ни один не подходит (406).
+     */
+    static std::optional<std::string_view> negotiateContentType(std::string_view accept,
+                                                                std::initializer_list<std::string_view> supported) {
+        const auto trim = [](std::string_view text) {
+            const auto begin = text.find_first_not_of(" \t");
+            if (begin == std::string_view::npos) return std::string_view{};
+            return text.substr(begin, text.find_last_not_of(" \t") - begin + 1);
+        };
+        const auto equalsIgnoreCase = [](std::string_view a, std::string_view b) {
+            return std::ranges::equal(a, b, [](char x, char y) { return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y)); });
+        };
+
+        if (trim(accept).empty()) {
+            return *supported.begin();
+        }
+
+        std::optional<std::string_view> best;
+        double bestQuality = 0;
+        for (const std::string_view type : supported) {
+            const std::string_view group = type.substr(0, type.find('/'));
+            int matchedSpecificity = 0;
+            double quality = 0;
+
+            size_t position = 0;
+            while (position <= accept.size()) {
+                const auto end = std::min(accept.find(',', position), accept.size());
+                const std::string_view entry = accept.substr(position, end - position);
+                position = end + 1;
+
+                const std::string_view range = trim(entry.substr(0, entry.find(';')));
+                int specificity = 0;
+                if (equalsIgnoreCase(range, type)) {
+                    specificity = 3;
+                } else if (range.size() == group.size() + 2 && range.ends_with("/*") && equalsIgnoreCase(range.substr(0, group.size()), group)) {
+                    specificity = 2;
+                } else if (range == "*/*") {
+                    specificity = 1;
+                }
+                if (specificity <= matchedSpecificity) {
+                    continue;
+                }
+
+                double rangeQuality = 1;
+                for (auto param = entry.find(';'); param != std::string_view::npos; param = entry.find(';', param + 1)) {
+                    const std::string_view parameter = trim(entry.substr(param + 1, entry.find(';', param + 1) - param - 1));
+                    if (parameter.size() > 2 && (parameter[0] == 'q' || parameter[0] == 'Q') && parameter[1] == '=') {
+                        std::from_chars(parameter.data() + 2, parameter.data() + parameter.size(), rangeQuality);
+                    }
+                }
+                matchedSpecificity = specificity;
+                quality = rangeQuality;
+            }
+
+            if (quality > bestQuality) {
+                best = type;
+                bestQuality = quality;
+            }
+        }
+        return best;
+    }
+
+    /**
+     * @brief Совпадает ли etag с одним из тегов заголовка If-None-Match (слабое сравнение, "*" - любой).
+     */
+    static bool ifNoneMatchHits(std::string_view ifNoneMatch, std::string_view etag) {
+        size_t position = 0;
+        while (position < ifNoneMatch.size()) {
+            const auto end = std::min(ifNoneMatch.find(',', position), ifNoneMatch.size());
+            std::string_view tag = ifNoneMatch.substr(position, end - position);
+            position = end + 1;
+
+            const auto begin = tag.find_first_not_of(" \t");
+            if (begin == std::string_view::npos) {
+                continue;
+            }
+            tag = tag.substr(begin, tag.find_last_not_of(" \t") - begin + 1);
+            if (tag == "*") {
+                return true;
+            }
+            if (tag.starts_with("W/")) {
+                tag.remove_prefix(2);
+            }
+            if (tag == etag) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     static std::map<std::string, std::string> parseQueryString(const std::string_view url) {
         std::map<std::string, std::string> params;
         const auto queryPos = url.find('?');
@@ -126,5 +244,26 @@ public:
         return params;
     }
 
+    /**
+     * @brief Раскодирует %XX и '+' в значении из строки запроса. parseQueryString значения
+     * не раскодирует, поэтому списки через запятую сначала делят, а потом раскодируют по частям.
+     * Некорректная %-последовательность остаётся как есть.
+     */
+    static std::string decodeQueryComponent(const std::string_view value) {
+        std::string decoded;
+        decoded.reserve(value.size());
+        for (size_t i = 0; i < value.size(); ++i) {
+            u8 byte = 0;
+            if (value[i] == '%' && i + 2 < value.size()
+                && std::from_chars(value.data() + i + 1, value.data() + i + 3, byte, 16).ptr == value.data() + i + 3) {
+                decoded += static_cast<char>(byte);
+                i += 2;
+            } else {
+                decoded += value[i] == '+' ? ' ' : value[i];
+            }
+        }
+        return decoded;
+    }
+
 };
 #endif //ICONTROLLER_H
\ No newline at end of file
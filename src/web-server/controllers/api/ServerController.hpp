@@ -0,0 +1,158 @@
+#ifndef SERVERCONTROLLER_HPP
+#define SERVERCONTROLLER_HPP
+
+#include "IController.hpp"
+#include "../WorkerPools.hpp"
+#include "../../../util/logging.hpp"
+#include "../../../util/metrics/MetricsRegistry.hpp"
+
+using json = nlohmann::json;
+
+inline void writeJson(JsonWriter& w, const WorkerPoolStats& s) {
+    w.beginObject()
+     .field("threads", s.threads)
+     .field("queued", s.queued)
+     .field("active", s.active)
+     .field("completed", s.completed)
+     .field("rejected", s.rejected)
+     .field("queueLimit", s.queueLimit)
+     .endObject();
+}
+
+inline constexpr std::pair<std::string_view, FRAMEWORK_CONSTANTS::LogLevel> logLevelNames[] = {
+    {"none", FRAMEWORK_CONSTANTS::LogLevel::LOG_NONE},
+    {"error", FRAMEWORK_CONSTANTS::LogLevel::LOG_ERROR},
+    {"warning", FRAMEWORK_CONSTANTS::LogLevel::LOG_WARNING},
+    {"message", FRAMEWORK_CONSTANTS::LogLevel::LOG_MESSAGE},
+    {"info", FRAMEWORK_CONSTANTS::LogLevel::LOG_INFO},
+    {"debug", FRAMEWORK_CONSTANTS::LogLevel::LOG_DEBUG},
+};
+
+inline std::string_view logLevelName(FRAMEWORK_CONSTANTS::LogLevel level) {
+    for (const auto& [name, value] : logLevelNames) {
+        if (value == level) return name;
+    }
+    return "unknown";
+}
+
+class ServerController : public IController {
+    std::shared_ptr<WorkerPools> _pools;
+    std::shared_ptr<Metrics::MetricsRegistry> _metrics;
+
+public:
+    ServerController(std::shared_ptr<WorkerPools> pools, std::shared_ptr<Metrics::MetricsRegistry> metrics)
+        : IController({
+              // Загрузка потоков io и пула вычислений: глубина очередей, занятые потоки, отказы
+              {
+                  Route("/api/v1/server/pools", {http::verb::get}),
+                  [this](const RequestCtx& ctx) { return this->getPoolStats(ctx); }
+              },
+              // Все метрики сервера в текстовом формате Prometheus
+              {
+                  Route("/api/v1/metrics", {http::verb::get}),
+                  [this](const RequestCtx& ctx) { return this->getMetrics(ctx); }
+              },
+              // Текущий уровень лога и счётчики фонового писателя
+              {
+                  Route("/api/v1/server/log-level", {http::verb::get}),
+                  [this](const RequestCtx& ctx) { return this->getLogLevel(ctx); }
+              },
+              // Смена уровня лога без перезапуска: {"level": "warning"}
+              {
+                  Route("/api/v1/server/log-level", {http::verb::put}),
+                  [this](const RequestCtx& ctx) { return this->setLogLevel(ctx); }
+              }
+          }),
+          _pools(std::move(pools)),
+          _metrics(std::move(metrics)) {
+        _metrics->addCollector([this](Metrics::PrometheusWriter& w) { writePoolMetrics(w); });
+        _metrics->addCollector([](Metrics::PrometheusWriter& w) { writeLogMetrics(w); });
+    }
+
+private:
+    void writePoolMetrics(Metrics::PrometheusWriter& w) const {
+        const std::pair<std::string_view, WorkerPoolStats> pools[] = {{"io", _pools->ioStats()}, {"compute", _pools->computeStats()}};
+
+        w.family("neuro_worker_pool_threads", "gauge", "Threads in the pool.");
+        for (const auto& [pool, stats] : pools) w.sample("neuro_worker_pool_threads", {{"pool", pool}}, u64{stats.threads});
+        w.family("neuro_worker_pool_queue_depth", "gauge", "Tasks waiting for a free thread.");
+        for (const auto& [pool, stats] : pools) w.sample("neuro_worker_pool_queue_depth", {{"pool", pool}}, u64{stats.queued});
+        w.family("neuro_worker_pool_active", "gauge", "Tasks running right now.");
+        for (const auto& [pool, stats] : pools) w.sample("neuro_worker_pool_active", {{"pool", pool}}, u64{stats.active});
+        w.family("neuro_worker_pool_completed_total", "counter", "Tasks finished.");
+        for (const auto& [pool, stats] : pools) w.sample("neuro_worker_pool_completed_total", {{"pool", pool}}, stats.completed);
+        w.family("neuro_worker_pool_rejected_total", "counter", "Tasks refused because the queue was full.");
+        for (const auto& [pool, stats] : pools) w.sample("neuro_worker_pool_rejected_total", {{"pool", pool}}, stats.rejected);
+    }
+
+    static void writeLogMetrics(Metrics::PrometheusWriter& w) {
+        const auto stats = Log::stats();
+        w.family("neuro_log_records_written_total", "counter", "Log records written to the console.")
+         .sample("neuro_log_records_written_total", {}, stats.written)
+         .family("neuro_log_records_dropped_total", "counter", "Log records dropped because a thread's ring buffer was full.")
+         .sample("neuro_log_records_dropped_total", {}, stats.dropped);
+    }
+
+    static http::response<http::string_body> logLevelResponse() {
+        const auto stats = Log::stats();
+        return writeJsonResponse(http::status::ok, [&](JsonWriter& w) {
+            w.beginObject()
+             .field("level", logLevelName(Log::level()))
+             .field("async", FRAMEWORK_CONSTANTS::asyncLogging.load())
+             .field("written", stats.written)
+             .field("dropped", stats.dropped)
+             .endObject();
+        });
+    }
+
+    http::response<http::string_body> getLogLevel(const RequestCtx& ctx) {
+        return logLevelResponse();
+    }
+
+    http::response<http::string_body> setLogLevel(const RequestCtx& ctx) {
+        try {
+            json requestBody = json::parse(ctx.originalRequest.body());
+            const auto levelName = requestBody.at("level").get<std::string>();
+
+            const auto it = std::ranges::find(logLevelNames, std::string_view(levelName), &std::pair<std::string_view, FRAMEWORK_CONSTANTS::LogLevel>::first);
+            if (it == std::end(logLevelNames)) {
+                return createErrorResponse(http::status::bad_request,
+                                           "Unknown log level '" + levelName + "'. Expected none, error, warning, message, info or debug.");
+            }
+            if (it->second > FRAMEWORK_CONSTANTS::compileTimeLogLevel) {
+                return createErrorResponse(http::status::bad_request,
+                                           "Log level '" + levelName + "' is above the compile-time level '" + std::string(logLevelName(FRAMEWORK_CONSTANTS::compileTimeLogLevel)) + "'.");
+            }
+
+            Log::setLevel(it->second);
+            return logLevelResponse();
+        } catch (const json::parse_error& e) {
+            return createErrorResponse(http::status::bad_request, "Invalid JSON format: " + std::string(e.what()));
+        } catch (const json::exception& e) {
+            return createErrorResponse(http::status::bad_request, "JSON type error: " + std::string(e.what()));
+        }
+    }
+
+    http::response<http::string_body> getPoolStats(const RequestCtx& ctx) {
+        const auto io = _pools->ioStats();
+        const auto compute = _pools->computeStats();
+        return writeJsonResponse(http::status::ok, [&](JsonWriter& w) {
+            w.beginObject().key("io");
+            writeJson(w, io);
+            w.key("compute");
+            writeJson(w, compute);
+            w.endObject();
+        });
+    }
+
+    http::response<http::string_body> getMetrics(const RequestCtx& ctx) {
+        http::response<http::string_body> res{http::status::ok, 11};
+        res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+        res.set(http::field::content_type, "text/plain; version=0.0.4; charset=utf-8");
+        res.body() = _metrics->renderPrometheus();
+        res.prepare_payload();
+        return res;
+    }
+};
+
+#endif
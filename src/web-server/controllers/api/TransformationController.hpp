@@ -11,28 +11,38 @@
 #include "IController.hpp"
 #include "../../../service/DatasetService.hpp"
 #include "../../../service/TransformationService.hpp"
+#include "../../../service/query/QueryService.hpp"
 
 using json = nlohmann::json;
 
 class TransformationController : public IController {
     std::shared_ptr<DatasetService> _datasetService;
     std::shared_ptr<TransformationService> _transformationService;
+    std::shared_ptr<QueryService> _queryService;
 
 public:
-    explicit TransformationController(std::shared_ptr<DatasetService> ds, std::shared_ptr<TransformationService> ts)
+    TransformationController(std::shared_ptr<DatasetService> ds, std::shared_ptr<TransformationService> ts,
+                             std::shared_ptr<QueryService> qs)
         : IController({
               {
-                  Route("/api/v1/datasets/{id}/transform/remove-column", {http::verb::post}),
+                  // новый датасет строится копированием всех строк - в пуле вычислений
+                  Route("/api/v1/datasets/{id}/transform/remove-column", {http::verb::post}, RouteExecution::compute),
                   [this](const RequestCtx& ctx) { return this->handleRemoveColumn(ctx); }
+              },
+              {
+                  // фильтр и сортировка проходят по колонкам всего датасета - в пуле вычислений
+                  Route("/api/v1/datasets/{id}/query", {http::verb::post}, RouteExecution::compute),
+                  [this](const RequestCtx& ctx) { return this->handleQuery(ctx); }
               }
           }),
           _datasetService(std::move(ds)),
-          _transformationService(std::move(ts)) {}
+          _transformationService(std::move(ts)),
+          _queryService(std::move(qs)) {}
 
 private:
     http::response<http::string_body> handleRemoveColumn(const RequestCtx& ctx) {
         try {
-            const auto& sourceId = ctx.pathParams.at("id");
+            const std::string sourceId(ctx.pathParams.at("id"));
 
             auto sourceDataset = _datasetService->getDatasetById(sourceId);
             if (!sourceDataset) {
@@ -64,6 +74,48 @@ private:
             return createErrorResponse(http::status::bad_request, e.what());
         }
     }
+
+    /**
+     * @brief Фильтр и сортировка. Тело: {"where": "price > 10 AND city IN ('Moscow', 'Kazan')", "orderBy": "price DESC", "name": "..."};
+     * нужно хотя бы одно из where и orderBy. Результат регистрируется новым датасетом, его страницы
+     * читаются через /api/v1/datasets/{id} как обычно.
+     */
+    http::response<http::string_body> handleQuery(const RequestCtx& ctx) {
+        try {
+            const std::string sourceId(ctx.pathParams.at("id"));
+
+            auto sourceDataset = _datasetService->getDatasetById(sourceId);
+            if (!sourceDataset) {
+                return createErrorResponse(http::status::not_found, "Source dataset not found.");
+            }
+
+            json requestBody = json::parse(ctx.originalRequest.body());
+            const std::string where = requestBody.value("where", std::string());
+            const std::string orderBy = requestBody.value("orderBy", std::string());
+            if (where.empty() && orderBy.empty()) {
+                return createErrorResponse(http::status::bad_request, "Expected 'where', 'orderBy' or both.");
+            }
+
+            auto result = _queryService->query(sourceDataset, where, orderBy);
+            const size_t rowCount = result->rowCount;
+
+            std::string newDatasetName = requestBody.value("name", sourceDataset->name + " (query)");
+            std::string newId = _datasetService->registerTransformedDataset(std::move(result), newDatasetName);
+
+            json responseBody = {
+                {"newDatasetId", newId},
+                {"newDatasetName", newDatasetName},
+                {"rows", rowCount},
+                {"sourceRows", sourceDataset->rowCount}
+            };
+            return createJsonResponse(http::status::ok, responseBody);
+
+        } catch (const json::parse_error& e) {
+            return createErrorResponse(http::status::bad_request, "Invalid JSON format: " + std::string(e.what()));
+        } catch (const std::exception& e) {
+            return createErrorResponse(http::status::bad_request, e.what());
+        }
+    }
 };
 
 
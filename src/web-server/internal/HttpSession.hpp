@@ -5,78 +5,258 @@
 #ifndef HTTPSESSION_H
 #define HTTPSESSION_H
 
+#include <deque>
 #include <iostream>
+#include <optional>
+#include <print>
 
 #include "../controllers/Router.hpp"
+#include "../../util/constants.hpp"
 
 inline void fail(beast::error_code ec, char const* what) {
     std::println(std::cerr, "{} : {}", what, ec.message());
 }
 
+/**
+ * @brief HTTP/1.1 соединение на корутинах Asio.
+ *
+ * Один цикл на strand соединения: читает запрос, раздаёт обработчикам все запросы, уже
+ * пришедшие целиком (pipelining, не больше maxPipelinedRequests), и отправляет ответы строго
+ * в порядке запросов. Сокет читается, только когда отправлять нечего, поэтому чтение и запись
+ * никогда не идут одновременно и у каждой операции свой срок в tcp_stream. Память соединения
+ * ограничена буфером чтения (заголовок + тело) и очередью из maxPipelinedRequests запросов.
+ * Запрос Upgrade: websocket на путь из Router::addWebSocketEndpoint забирает сокет себе.
+ */
 class HttpSession : public std::enable_shared_from_this<HttpSession> {
+    // запрос ждёт своего ответа; адрес слота стабилен, пока слот в очереди
+    struct PipelineSlot {
+        http::request<http::string_body> request;
+        std::optional<ApiResponse> response;
+        bool keepAlive = true;
+        // запрос Upgrade: websocket; соединение уйдёт обработчику после ответов на предыдущие запросы
+        const WebSocketHandler* upgrade = nullptr;
+    };
+
     beast::tcp_stream _stream;
     beast::flat_buffer _buffer;
-    http::request<http::string_body> _req;
     std::shared_ptr<Router> _apiController;
+    std::optional<http::request_parser<http::string_body>> _parser;
+    std::deque<PipelineSlot> _pipeline;
+    // будит цикл, когда обработчик вернул ответ
+    net::steady_timer _responseReady;
+    size_t _requestCount = 0;
+    bool _closing = false; // последний запрос соединения уже прочитан
+    bool _upgraded = false; // сокет передан обработчику WebSocket
 
 public:
     HttpSession(tcp::socket&& socket, const std::shared_ptr<Router>& controller)
-        : _stream(std::move(socket)), _apiController(controller)
-    {}
+        : _stream(std::move(socket)),
+          _buffer(FRAMEWORK_CONSTANTS::maxRequestHeaderBytes + FRAMEWORK_CONSTANTS::maxRequestBodyBytes),
+          _apiController(controller),
+          _responseReady(_stream.get_executor()) {}
 
     void run() {
-        doRead();
+        // лямбда с владеющим указателем хранится в кадре co_spawn, пока сессия не завершится
+        net::co_spawn(_stream.get_executor(),
+                      [self = shared_from_this()] { return self->loop(); },
+                      net::detached);
     }
 
 private:
-    void doRead() {
-        _req = {};
-        http::async_read(_stream, _buffer, _req,
-            beast::bind_front_handler(
-                &HttpSession::onRead,
-                shared_from_this()));
+    net::awaitable<void> loop() {
+        try {
+            for (;;) {
+                // сокет ждём, только если ответить пока не на что
+                if (_pipeline.empty() && !co_await readRequest()) {
+                    break;
+                }
+                while (!_closing && _pipeline.size() < FRAMEWORK_CONSTANTS::maxPipelinedRequests && parseBufferedRequest()) {
+                }
+
+                if (!co_await writeFrontResponse()) {
+                    break;
+                }
+            }
+        } catch (const boost::system::system_error& e) {
+            if (e.code() != beast::error::timeout) {
+                fail(e.code(), "session");
+            }
+        } catch (const std::exception& e) {
+            // заголовки потокового ответа уже ушли, статус не поменять - обрываем соединение
+            std::println(std::cerr, "stream : {}", e.what());
+        }
+        doClose();
     }
 
-    void onRead(beast::error_code ec, std::size_t bytesTransferred) {
-        boost::ignore_unused(bytesTransferred);
+    /**
+     * @brief Читает из сокета один запрос целиком.
+     * @return false, если клиент закрыл соединение или оно простаивало дольше httpIdleTimeout.
+     */
+    net::awaitable<bool> readRequest() {
+        if (_closing) {
+            co_return false;
+        }
+        if (!_parser) {
+            resetParser();
+        }
 
-        if (ec == http::error::end_of_stream)
-            return doClose();
+        beast::error_code ec;
+        if (_buffer.size() == 0) {
+            // между запросами действует срок простоя, после первого байта - срок чтения запроса
+            _stream.expires_after(FRAMEWORK_CONSTANTS::httpIdleTimeout);
+            const size_t bytes = co_await _stream.async_read_some(
+                _buffer.prepare(std::min<size_t>(64 << 10, _buffer.max_size())),
+                net::redirect_error(net::use_awaitable, ec));
+            if (ec == net::error::eof || ec == beast::error::timeout) {
+                co_return false;
+            }
+            if (ec) {
+                throw boost::system::system_error(ec);
+            }
+            _buffer.commit(bytes);
+        }
 
-        if (ec)
-            return fail(ec, "read");
+        _stream.expires_after(FRAMEWORK_CONSTANTS::httpReadTimeout);
+        co_await http::async_read(_stream, _buffer, *_parser, net::redirect_error(net::use_awaitable, ec));
+        if (ec == http::error::end_of_stream) {
+            co_return false;
+        }
+        if (ec) {
+            throw boost::system::system_error(ec);
+        }
+        dispatch();
+        co_return true;
+    }
 
-        handleRequest();
+    /**
+     * @brief Разбирает запрос, уже целиком лежащий в буфере, без обращения к сокету.
+     * @return false, если в буфере нет полного запроса; начатый разбор продолжит readRequest.
+     */
+    bool parseBufferedRequest() {
+        if (_buffer.size() == 0) {
+            return false;
+        }
+        if (!_parser) {
+            resetParser();
+        }
+
+        beast::error_code ec;
+        while (!_parser->is_done()) {
+            const size_t consumed = _parser->put(_buffer.data(), ec);
+            _buffer.consume(consumed);
+            if (ec == http::error::need_more) {
+                return false;
+            }
+            if (ec) {
+                throw boost::system::system_error(ec);
+            }
+        }
+        dispatch();
+        return true;
     }
 
-    void handleRequest() {
-        http::response<http::string_body> res = _apiController->handleRequest(_req);
-        sendResponse(std::move(res));
+    void resetParser() {
+        _parser.emplace();
+        _parser->eager(true);
+        _parser->header_limit(static_cast<u32>(FRAMEWORK_CONSTANTS::maxRequestHeaderBytes));
+        _parser->body_limit(FRAMEWORK_CONSTANTS::maxRequestBodyBytes);
     }
 
-    void sendResponse(http::response<http::string_body>&& res) {
-        auto sp = std::make_shared<http::response<http::string_body>>(std::move(res));
+    // отдаёт разобранный запрос роутеру; ответ попадёт в слот, возможно позже и из пула вычислений
+    void dispatch() {
+        PipelineSlot& slot = _pipeline.emplace_back();
+        slot.request = _parser->release();
+        _parser.reset();
 
-        http::async_write(_stream, *sp,
-            [self = shared_from_this(), sp](beast::error_code ec, std::size_t bytes) {
-                self->onWrite(ec, bytes, sp->need_eof());
-            });
-    }
+        slot.keepAlive = slot.request.keep_alive() && ++_requestCount < FRAMEWORK_CONSTANTS::maxRequestsPerConnection;
+        _closing = !slot.keepAlive;
 
-    void onWrite(beast::error_code ec, std::size_t bytesTransferred, bool close) {
-        boost::ignore_unused(bytesTransferred);
+        if (websocket::is_upgrade(slot.request)) {
+            if (const WebSocketHandler* handler = _apiController->findWebSocketEndpoint(slot.request.target())) {
+                slot.upgrade = handler;
+                _closing = true; // после Upgrade сокет читает уже не HTTP
+                return;
+            }
+        }
 
-        if (ec)
-            return fail(ec, "write");
+        _apiController->handleRequest(slot.request, _stream.get_executor(), [self = shared_from_this(), &slot](ApiResponse res) {
+            slot.response = std::move(res);
+            self->_responseReady.cancel();
+        });
+    }
 
-        if (close) {
-            return doClose();
+    /**
+     * @brief Дожидается ответа на самый ранний запрос и отправляет его.
+     * @return false, если после этого ответа соединение надо закрыть.
+     */
+    net::awaitable<bool> writeFrontResponse() {
+        PipelineSlot& slot = _pipeline.front();
+        if (slot.upgrade) {
+            // все предыдущие ответы отправлены - отдаём сокет вместе с запросом, рукопожатие сделает обработчик
+            _upgraded = true;
+            (*slot.upgrade)(std::move(_stream), std::move(slot.request));
+            _pipeline.pop_front();
+            co_return false;
+        }
+        while (!slot.response) {
+            _responseReady.expires_at(net::steady_timer::time_point::max());
+            beast::error_code ec;
+            co_await _responseReady.async_wait(net::redirect_error(net::use_awaitable, ec));
         }
 
-        doRead();
+        const bool keepAlive = co_await std::visit(
+            [this, &slot](auto& response) { return writeResponse(std::move(response), slot.keepAlive); },
+            *slot.response);
+        _pipeline.pop_front();
+        co_return keepAlive;
+    }
+
+    template<typename Body>
+    net::awaitable<bool> writeResponse(http::response<Body> res, bool keepAlive) {
+        res.keep_alive(keepAlive);
+        _stream.expires_after(FRAMEWORK_CONSTANTS::httpWriteTimeout);
+        co_await http::async_write(_stream, res, net::use_awaitable);
+        co_return !res.need_eof();
+    }
+
+    // потоковый ответ: заголовок, затем порции из nextChunk, пока источник не скажет, что всё
+    net::awaitable<bool> writeResponse(StreamingResponse res, bool keepAlive) {
+        http::response<http::buffer_body> response{std::move(res.header.base())};
+        response.chunked(true);
+        response.keep_alive(keepAlive);
+        response.body().data = nullptr;
+        response.body().more = true;
+        http::response_serializer<http::buffer_body> serializer{response};
+
+        _stream.expires_after(FRAMEWORK_CONSTANTS::httpWriteTimeout);
+        co_await http::async_write_header(_stream, serializer, net::use_awaitable);
+
+        std::string buffer;
+        buffer.reserve(streamingChunkBytes * 2);
+        while (!serializer.is_done()) {
+            buffer.clear();
+            const bool more = res.nextChunk(buffer);
+
+            auto& body = response.body();
+            body.data = buffer.data();
+            body.size = buffer.size();
+            body.more = more;
+
+            beast::error_code ec;
+            _stream.expires_after(FRAMEWORK_CONSTANTS::httpWriteTimeout);
+            co_await http::async_write(_stream, serializer, net::redirect_error(net::use_awaitable, ec));
+            // need_buffer - сериализатор забрал порцию целиком и ждёт следующую
+            if (ec && ec != http::error::need_buffer) {
+                throw boost::system::system_error(ec);
+            }
+        }
+        co_return !response.need_eof();
     }
 
     void doClose() {
+        if (_upgraded) {
+            return;
+        }
         beast::error_code ec;
         _stream.socket().shutdown(tcp::socket::shutdown_send, ec);
     }
@@ -0,0 +1,124 @@
+#ifndef IORUNTIME_HPP
+#define IORUNTIME_HPP
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "RestServer.hpp"
+#include "../../util/concurrency/CpuAffinity.hpp"
+#include "../../util/logging.hpp"
+
+enum class ServerMode {
+    SHARED_CONTEXT,   // один io_context и один acceptor на все потоки
+    CONTEXT_PER_CORE  // у каждого потока свой io_context и свой acceptor с SO_REUSEPORT
+};
+
+/**
+ * @brief Потоки io и их io_context'ы в выбранном режиме.
+ *
+ * В режиме CONTEXT_PER_CORE соединения между потоками раскладывает ядро ОС: каждое соединение
+ * живёт в потоке, чей acceptor его принял, и обработчики никогда не переходят в другой поток.
+ * Без SO_REUSEPORT (Windows) режим недоступен, используется SHARED_CONTEXT.
+ */
+class IoRuntime {
+    ServerMode _mode;
+    u32 _threads;
+    bool _pinThreads;
+    std::vector<std::unique_ptr<net::io_context>> _contexts;
+    std::vector<std::thread> _workers;
+
+public:
+    /**
+     * @param threads 0 - по числу ядер.
+     * @param pinThreads привязать i-й поток к i-му ядру.
+     */
+    IoRuntime(ServerMode mode, u32 threads, bool pinThreads)
+        : _mode(mode),
+          _threads(threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency())),
+          _pinThreads(pinThreads) {
+#ifndef SO_REUSEPORT
+        if (_mode == ServerMode::CONTEXT_PER_CORE) {
+            Log::Logger().warning("SO_REUSEPORT is not available, falling back to a shared io_context");
+            _mode = ServerMode::SHARED_CONTEXT;
+        }
+#endif
+        const size_t contexts = _mode == ServerMode::CONTEXT_PER_CORE ? _threads : 1;
+        for (size_t i = 0; i < contexts; ++i) {
+            _contexts.push_back(std::make_unique<net::io_context>(_mode == ServerMode::CONTEXT_PER_CORE ? 1 : static_cast<int>(_threads)));
+        }
+    }
+
+    ~IoRuntime() {
+        stop();
+        join();
+    }
+
+    IoRuntime(const IoRuntime&) = delete;
+    IoRuntime& operator=(const IoRuntime&) = delete;
+
+    [[nodiscard]] u32 threadCount() const { return _threads; }
+    [[nodiscard]] ServerMode mode() const { return _mode; }
+
+    /**
+     * @brief Открывает acceptor на каждом io_context. Порт 0 выбирается один раз и делится между всеми.
+     * Первая ошибка прерывает запуск: иначе следующие acceptor'ы получили бы вместо общего порта
+     * адрес закрытого сокета (порт 0) и каждый слушал бы свой случайный порт.
+     * @return Фактический адрес, на котором слушает сервер.
+     * @throws std::runtime_error если хотя бы один acceptor не удалось открыть.
+     */
+    tcp::endpoint listen(const std::shared_ptr<Router>& router, tcp::endpoint endpoint) {
+        const bool reusePort = _mode == ServerMode::CONTEXT_PER_CORE;
+        for (auto& context : _contexts) {
+            auto server = std::make_shared<RestServer>(router, *context, endpoint, reusePort);
+            endpoint = server->localEndpoint();
+            server->run();
+        }
+        return endpoint;
+    }
+
+    /**
+     * @brief Запускает все потоки io в фоне.
+     */
+    void start() {
+        for (u32 i = 0; i < _threads; ++i) {
+            _workers.emplace_back([this, i] { runWorker(i); });
+        }
+    }
+
+    /**
+     * @brief Запускает потоки io, занимая текущий поток под первый из них, и возвращается после stop().
+     */
+    void run() {
+        for (u32 i = 1; i < _threads; ++i) {
+            _workers.emplace_back([this, i] { runWorker(i); });
+        }
+        runWorker(0);
+        join();
+    }
+
+    void stop() {
+        for (auto& context : _contexts) {
+            context->stop();
+        }
+    }
+
+private:
+    void runWorker(u32 index) {
+        if (_pinThreads && !Concurrency::pinCurrentThreadToCpu(index % std::max(1u, std::thread::hardware_concurrency()))) {
+            Log::Logger().warning("Failed to pin io thread {} to a CPU", index);
+        }
+        _contexts[_mode == ServerMode::CONTEXT_PER_CORE ? index : 0]->run();
+    }
+
+    void join() {
+        for (auto& worker : _workers) {
+            if (worker.joinable() && worker.get_id() != std::this_thread::get_id()) {
+                worker.join();
+            }
+        }
+        _workers.clear();
+    }
+};
+
+#endif
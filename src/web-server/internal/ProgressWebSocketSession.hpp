@@ -0,0 +1,239 @@
+#ifndef PROGRESSWEBSOCKETSESSION_HPP
+#define PROGRESSWEBSOCKETSESSION_HPP
+
+#include <format>
+#include <iostream>
+#include <optional>
+#include <print>
+#include <ranges>
+
+#include "../server_types.h"
+#include "../controllers/api/IController.hpp"
+#include "../../service/ProgressHub.hpp"
+#include "../../util/constants.hpp"
+#include "../../util/json/JsonWriter.hpp"
+#include "../../util/metrics/MetricsRegistry.hpp"
+
+inline std::string_view toString(ProgressKind kind) {
+    switch (kind) {
+        case ProgressKind::LOAD: return "load";
+    }
+    return "unknown";
+}
+
+inline std::string_view toString(ProgressState state) {
+    switch (state) {
+        case ProgressState::QUEUED: return "queued";
+        case ProgressState::RUNNING: return "running";
+        case ProgressState::COMPLETED: return "completed";
+        case ProgressState::FAILED: return "failed";
+    }
+    return "unknown";
+}
+
+// только поля своего вида задачи: событие уходит в каждую открытую вкладку
+inline void writeJson(JsonWriter& w, const ProgressEvent& e) {
+    w.beginObject()
+     .field("topic", e.topic)
+     .field("kind", toString(e.kind))
+     .field("state", toString(e.state))
+     .field("seq", e.sequence);
+    if (e.kind == ProgressKind::LOAD) {
+        w.field("rows", e.rows)
+         .field("bytes", e.bytes)
+         .field("totalBytes", e.totalBytes);
+    }
+    if (e.throughput > 0) {
+        w.field("throughput", e.throughput);
+    }
+    if (!e.datasetId.empty()) {
+        w.field("datasetId", e.datasetId);
+    }
+    if (!e.error.empty()) {
+        w.field("error", e.error);
+    }
+    w.endObject();
+}
+
+inline void writeProgressMetrics(Metrics::PrometheusWriter& w, const ProgressHub& hub) {
+    w.family("neuro_progress_subscribers", "gauge", "Open WebSocket progress subscriptions.")
+     .sample("neuro_progress_subscribers", {}, u64{hub.subscriberCount()})
+     .family("neuro_progress_events_published_total", "counter", "Progress events published by long-running jobs.")
+     .sample("neuro_progress_events_published_total", {}, hub.publishedCount())
+     .family("neuro_progress_events_coalesced_total", "counter", "Progress events replaced by a newer one before a subscriber took them.")
+     .sample("neuro_progress_events_coalesced_total", {}, hub.coalescedCount());
+}
+
+/**
+ * @brief WebSocket, по которому клиент следит за долгими задачами (/api/v1/ws/progress).
+ *
+ * Задачи выбираются параметром ?topics=id1,id2 при подключении (без него - все) и сообщениями
+ * {"subscribe": "id"} / {"unsubscribe": "id"}; "*" означает все задачи. Сервер шлёт текстовые
+ * сообщения - JSON-массивы событий ProgressEvent.
+ *
+ * Чтение и запись - две корутины на strand соединения. Пока идёт запись, новые события копятся
+ * в подписке по одному на задачу, поэтому медленный клиент получает последнее состояние,
+ * а не очередь устаревших, и не задерживает публикацию. Так же и ответ на ошибку клиента хранится
+ * только последний, а число и длина тем подписки ограничены: клиент, который пишет, но не читает,
+ * не может заставить сессию копить память.
+ */
+class ProgressWebSocketSession : public std::enable_shared_from_this<ProgressWebSocketSession> {
+    websocket::stream<beast::tcp_stream> _ws;
+    std::shared_ptr<ProgressHub> _hub;
+    std::shared_ptr<ProgressSubscription> _subscription;
+    // будит запись, когда в подписке появились события или ответ на сообщение клиента
+    net::steady_timer _wake;
+    beast::flat_buffer _readBuffer;
+    std::string _writeBuffer;
+    // ответ на последнее некорректное сообщение клиента: пока клиент не читает, ошибки не копятся,
+    // а заменяют друг друга, как события в подписке
+    std::optional<std::string> _error;
+    bool _closed = false;
+
+    // id задачи - UUID, 36 символов
+    static constexpr size_t maxTopicBytes = 64;
+
+public:
+    ProgressWebSocketSession(beast::tcp_stream&& stream, std::shared_ptr<ProgressHub> hub)
+        : _ws(std::move(stream)), _hub(std::move(hub)), _wake(_ws.get_executor()) {}
+
+    void run(http::request<http::string_body> request) {
+        net::co_spawn(_ws.get_executor(),
+                      [self = shared_from_this(), request = std::move(request)]() mutable { return self->accept(std::move(request)); },
+                      net::detached);
+    }
+
+private:
+    net::awaitable<void> accept(http::request<http::string_body> request) {
+        try {
+            // сроки tcp_stream остались от HTTP; у WebSocket свои, с ping при простое
+            beast::get_lowest_layer(_ws).expires_never();
+            _ws.set_option(websocket::stream_base::timeout::suggested(beast::role_type::server));
+            _ws.set_option(websocket::stream_base::decorator([](websocket::response_type& res) {
+                res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+            }));
+            _ws.read_message_max(FRAMEWORK_CONSTANTS::maxWebSocketMessageBytes);
+            co_await _ws.async_accept(request, net::use_awaitable);
+
+            // publish зовёт notify из своего потока, таймер трогаем только на strand
+            _subscription = _hub->subscribe([weak = weak_from_this(), executor = _ws.get_executor()] {
+                net::post(executor, [weak] {
+                    if (const auto self = weak.lock()) {
+                        self->_wake.cancel();
+                    }
+                });
+            });
+            const auto query = IController::parseQueryString(request.target());
+            if (const auto it = query.find("topics"); it != query.end()) {
+                for (const auto topic : std::views::split(std::string_view(it->second), ',')) {
+                    if (!topic.empty() && !follow(std::string(topic.begin(), topic.end()))) {
+                        break;
+                    }
+                }
+            } else {
+                _hub->follow(*_subscription, "*");
+            }
+
+            net::co_spawn(_ws.get_executor(), [self = shared_from_this()] { return self->readLoop(); }, net::detached);
+            co_await writeLoop();
+        } catch (const boost::system::system_error& e) {
+            if (!isDisconnect(e.code())) {
+                std::println(std::cerr, "websocket : {}", e.code().message());
+            }
+        }
+        close();
+    }
+
+    net::awaitable<void> writeLoop() {
+        while (!_closed) {
+            auto events = _subscription->takePending();
+            if (events.empty() && !_error) {
+                _wake.expires_at(net::steady_timer::time_point::max());
+                beast::error_code ec;
+                co_await _wake.async_wait(net::redirect_error(net::use_awaitable, ec));
+                continue;
+            }
+
+            _writeBuffer.clear();
+            JsonWriter w(_writeBuffer);
+            w.beginArray();
+            if (_error) {
+                w.beginObject().field("error", *_error).endObject();
+                _error.reset();
+            }
+            for (const auto& event : events) {
+                writeJson(w, event);
+            }
+            w.endArray();
+
+            _ws.text(true);
+            co_await _ws.async_write(net::buffer(_writeBuffer), net::use_awaitable);
+        }
+    }
+
+    net::awaitable<void> readLoop() {
+        try {
+            for (;;) {
+                _readBuffer.clear();
+                co_await _ws.async_read(_readBuffer, net::use_awaitable);
+                handleMessage(beast::buffers_to_string(_readBuffer.data()));
+            }
+        } catch (const boost::system::system_error& e) {
+            if (!isDisconnect(e.code())) {
+                std::println(std::cerr, "websocket : {}", e.code().message());
+            }
+        }
+        // клиент ушёл: запись остановится на следующем пробуждении
+        _closed = true;
+        _wake.cancel();
+    }
+
+    void handleMessage(const std::string& message) {
+        try {
+            const auto request = nlohmann::json::parse(message);
+            if (const auto it = request.find("subscribe"); it != request.end()) {
+                follow(it->get<std::string>());
+            } else if (const auto it = request.find("unsubscribe"); it != request.end()) {
+                _hub->unfollow(*_subscription, it->get<std::string>());
+            } else {
+                _error = "Expected {\"subscribe\": id} or {\"unsubscribe\": id}";
+            }
+        } catch (const nlohmann::json::exception& e) {
+            _error = "Invalid message: " + std::string(e.what());
+        }
+        if (_error) {
+            _wake.cancel();
+        }
+    }
+
+    // темы присылает клиент, поэтому и их длина, и их число ограничены
+    bool follow(const std::string& topic) {
+        if (topic.size() > maxTopicBytes) {
+            _error = std::format("Topic must be a job id of at most {} bytes", maxTopicBytes);
+            return false;
+        }
+        if (!_hub->follow(*_subscription, topic)) {
+            _error = std::format("Too many topics: at most {} per connection, subscribe to \"*\" instead",
+                                 ProgressHub::maxTopicsPerSubscription);
+            return false;
+        }
+        return true;
+    }
+
+    // клиент закрыл вкладку или пропал - это не ошибка сервера
+    static bool isDisconnect(const beast::error_code& ec) {
+        return ec == websocket::error::closed || ec == beast::error::timeout || ec == net::error::operation_aborted
+               || ec == net::error::eof || ec == net::error::connection_reset || ec == net::error::broken_pipe;
+    }
+
+    void close() {
+        _closed = true;
+        _subscription.reset();
+        // читающая корутина ещё ждёт сокет - закрытие её отпустит
+        beast::error_code ec;
+        beast::get_lowest_layer(_ws).socket().shutdown(tcp::socket::shutdown_both, ec);
+        beast::get_lowest_layer(_ws).close();
+    }
+};
+
+#endif //PROGRESSWEBSOCKETSESSION_HPP
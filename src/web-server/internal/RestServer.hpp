@@ -15,32 +15,42 @@ class RestServer : public std::enable_shared_from_this<RestServer> {
     std::shared_ptr<Router> _controller;
 
 public:
-    RestServer(std::shared_ptr<Router> router, net::io_context& ioc, tcp::endpoint endpoint)
+    /**
+     * @param reusePort открыть acceptor с SO_REUSEPORT, чтобы несколько acceptor'ов слушали один порт
+     *        и ядро раскладывало между ними соединения.
+     * @throws std::runtime_error если acceptor не удалось открыть, привязать к адресу или начать слушать.
+     */
+    RestServer(std::shared_ptr<Router> router, net::io_context& ioc, tcp::endpoint endpoint, bool reusePort = false)
         : _controller(router), _ioc(ioc), _acceptor(ioc) {
         beast::error_code ec;
 
         _acceptor.open(endpoint.protocol(), ec);
         if (ec) {
-            fail(ec, "open");
-            return;
+            setupFailed(ec, "open");
         }
 
         _acceptor.set_option(net::socket_base::reuse_address(true), ec);
         if (ec) {
-            fail(ec, "set_option");
-            return;
+            setupFailed(ec, "set_option");
         }
 
+#ifdef SO_REUSEPORT
+        if (reusePort) {
+            _acceptor.set_option(net::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true), ec);
+            if (ec) {
+                setupFailed(ec, "set_option");
+            }
+        }
+#endif
+
         _acceptor.bind(endpoint, ec);
         if (ec) {
-            fail(ec, "bind");
-            return;
+            setupFailed(ec, "bind");
         }
 
         _acceptor.listen(net::socket_base::max_listen_connections, ec);
         if (ec) {
-            fail(ec, "listen");
-            return;
+            setupFailed(ec, "listen");
         }
     }
 
@@ -48,7 +58,17 @@ public:
         doAccept();
     }
 
+    // с портом 0 здесь виден порт, который выбрала ОС
+    [[nodiscard]] tcp::endpoint localEndpoint() const {
+        beast::error_code ec;
+        return _acceptor.local_endpoint(ec);
+    }
+
 private:
+    [[noreturn]] static void setupFailed(const beast::error_code& ec, const char* what) {
+        throw std::runtime_error(std::string("Listening socket ") + what + " failed: " + ec.message());
+    }
+
     void doAccept() {
         _acceptor.async_accept(
             net::make_strand(_ioc),
@@ -60,8 +80,15 @@ private:
     void onAccept(beast::error_code ec, tcp::socket socket) {
         if (ec) {
             fail(ec, "accept");
+            // закрытый acceptor больше ничего не примет, новый async_accept сразу вернул бы ту же ошибку
+            if (ec == net::error::operation_aborted || !_acceptor.is_open()) {
+                return;
+            }
         }
         else {
+            // потоковый ответ уходит заголовком и порциями отдельными записями: с алгоритмом Нейгла
+            // каждая следующая запись ждала бы отложенного ACK клиента (~40 мс)
+            socket.set_option(tcp::no_delay(true), ec);
             std::make_shared<HttpSession>(std::move(socket), _controller)->run();
         }
 
@@ -8,11 +8,13 @@
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/beast/version.hpp>
+#include <boost/beast/websocket.hpp>
 #include <boost/asio.hpp>
 
 
 namespace beast = boost::beast;
 namespace http  = beast::http;
+namespace websocket = beast::websocket;
 namespace net   = boost::asio;
 using     tcp   = boost::asio::ip::tcp;
 
@@ -0,0 +1,134 @@
+// Замер сериализации горячих ответов: JsonWriter против дерева nlohmann::json + dump().
+//
+// Запуск: json_benchmark [строк на странице]
+
+#include <chrono>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <print>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../src/web-server/controllers/api/DatasetController.hpp"
+
+namespace {
+    // прежний путь: структура -> дерево json -> строка
+    namespace legacy {
+        void to_json(json& j, const PaginatedData& p) {
+            j = json{
+                {"id", p.id},
+                {"name", p.name},
+                {"page", p.page},
+                {"pageSize", p.pageSize},
+                {"totalPages", p.totalPages},
+                {"totalRows", p.totalRows},
+                {"headers", p.headers},
+                {"data", p.data}
+            };
+        }
+
+        void to_json(json& j, const LoadJobStatus& s) {
+            j = json{
+                {"jobId", s.id},
+                {"filePath", s.filePath},
+                {"mode", toString(s.mode)},
+                {"state", toString(s.state)},
+                {"totalBytes", s.totalBytes},
+                {"bytesProcessed", s.bytesProcessed},
+                {"rowsProcessed", s.rowsProcessed}
+            };
+        }
+    }
+
+    PaginatedData makePage(size_t rows) {
+        std::mt19937_64 rng(42);
+        std::uniform_real_distribution<double> real(-1000.0, 1000.0);
+
+        PaginatedData page{"3f2c9a1e-0b7d-4c55-9d1e-2a6b8f0c4e71", "bench.csv", 1, static_cast<u32>(rows), 1, rows, {}, {}};
+        page.headers = {"id", "sepal_length", "sepal_width", "petal_length", "petal_width", "species", "comment", "score"};
+        page.data.reserve(rows);
+        for (size_t r = 0; r < rows; ++r) {
+            page.data.push_back({
+                std::to_string(r),
+                std::to_string(real(rng)),
+                std::to_string(real(rng)),
+                std::to_string(real(rng)),
+                std::to_string(real(rng)),
+                r % 3 == 0 ? "setosa" : r % 3 == 1 ? "versicolor" : "virginica",
+                r % 10 == 0 ? "says \"hi\"\nthen leaves" : "plain text cell",
+                std::to_string(rng() % 100)
+            });
+        }
+        return page;
+    }
+
+    struct Measurement {
+        double microseconds;
+        size_t bytes;
+    };
+
+    template<typename Fn>
+    Measurement measure(size_t iterations, Fn&& serialize) {
+        size_t bytes = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            bytes = serialize().size();
+        }
+        const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        return {elapsed.count() / static_cast<double>(iterations), bytes};
+    }
+
+    void report(std::string_view name, const Measurement& dom, const Measurement& writer) {
+        const auto megabytesPerSecond = [](const Measurement& m) { return static_cast<double>(m.bytes) / m.microseconds; };
+        std::println(std::cout, "{:<24} {:>12.1f} {:>12.1f} {:>10.0f} {:>10.0f} {:>8.1f}x",
+                     name, dom.microseconds, writer.microseconds, megabytesPerSecond(dom), megabytesPerSecond(writer),
+                     dom.microseconds / writer.microseconds);
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t rows = 10000;
+    if (argc > 1) {
+        std::from_chars(argv[1], argv[1] + std::strlen(argv[1]), rows);
+    }
+
+    const PaginatedData page = makePage(rows);
+    std::vector<std::pair<std::string, std::string>> loaded;
+    for (size_t i = 0; i < 200; ++i) {
+        loaded.emplace_back(std::to_string(i * 7919) + "-0b7d-4c55-9d1e-2a6b8f0c4e71", "dataset_" + std::to_string(i) + ".csv");
+    }
+    const LoadJobStatus job{"17", "datasets/big.csv", DatasetLoadMode::IN_MEMORY, LoadJobState::RUNNING,
+                            64u << 20, 12u << 20, 400000, "", ""};
+
+    std::println(std::cout, "{:<24} {:>12} {:>12} {:>10} {:>10} {:>9}", "response", "dom us", "writer us", "dom MB/s", "writer MB/s", "speedup");
+
+    report("page " + std::to_string(rows) + " rows",
+           measure(20, [&] { json j; legacy::to_json(j, page); return j.dump(); }),
+           measure(20, [&] { std::string out; JsonWriter w(out); writeJson(w, page); return out; }));
+
+    report("loaded (200 datasets)",
+           measure(2000, [&] {
+               json j = json::array();
+               for (const auto& [id, name] : loaded) {
+                   j.push_back({{"id", id}, {"name", name}});
+               }
+               return j.dump();
+           }),
+           measure(2000, [&] {
+               std::string out;
+               JsonWriter w(out);
+               w.beginArray();
+               for (const auto& [id, name] : loaded) {
+                   w.beginObject().field("id", id).field("name", name).endObject();
+               }
+               w.endArray();
+               return out;
+           }));
+
+    report("load job status",
+           measure(200000, [&] { json j; legacy::to_json(j, job); return j.dump(); }),
+           measure(200000, [&] { std::string out; JsonWriter w(out); writeJson(w, job); return out; }));
+    return 0;
+}
@@ -0,0 +1,83 @@
+// Масштабирование загрузки CSV по потокам: один и тот же файл загружается DatasetService::loadDataset
+// с 1, 2, ..., N потоками разбора (setLoadThreads), для каждого числа печатается лучшее время из повторов,
+// скорость и ускорение относительно одного потока.
+//
+// Запуск: load_benchmark <файл.csv> [наибольшее число потоков, по умолчанию по числу ядер] [повторов, по умолчанию 3]
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <print>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../src/service/DatasetService.hpp"
+#include "../../src/util/logging.hpp"
+
+namespace {
+    struct Measurement {
+        u32 threads;
+        double milliseconds;
+        size_t heapBytes;
+        size_t rows;
+    };
+
+    Measurement measure(DatasetService& service, const std::string& path, u32 threads, u32 repeats) {
+        service.setLoadThreads(threads);
+        Measurement best{threads, 0, 0, 0};
+        for (u32 i = 0; i < repeats; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            const std::string id = service.loadDataset(path);
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+            const auto dataset = service.getDatasetById(id);
+            if (i == 0 || elapsed.count() < best.milliseconds) {
+                best.milliseconds = elapsed.count();
+            }
+            best.heapBytes = dataset->memoryBytes();
+            best.rows = dataset->rowCount;
+            service.unloadDataset(id);
+        }
+        return best;
+    }
+
+    u32 parseArgument(const char* text, u32 fallback) {
+        u32 value = fallback;
+        std::from_chars(text, text + std::strlen(text), value);
+        return std::max(value, 1u);
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::println(std::cerr, "usage: load_benchmark <file.csv> [max threads] [repeats]");
+        return 1;
+    }
+    const std::string path = argv[1];
+    const u32 maxThreads = argc > 2 ? parseArgument(argv[2], 1) : Concurrency::defaultThreadCount();
+    const u32 repeats = argc > 3 ? parseArgument(argv[3], 3) : 3;
+
+    // строка лога на каждую загрузку смешалась бы с таблицей
+    Log::setLevel(FRAMEWORK_CONSTANTS::LogLevel::LOG_WARNING);
+
+    const double fileMegabytes = static_cast<double>(std::filesystem::file_size(path)) / (1 << 20);
+    std::println(std::cout, "{}: {:.1f} MB, best of {} loads, {} hardware threads", path, fileMegabytes, repeats,
+                 std::thread::hardware_concurrency());
+    std::println(std::cout, "{:>8} {:>12} {:>10} {:>9} {:>14} {:>10}", "threads", "ms", "MB/s", "speedup", "heap bytes", "rows");
+
+    DatasetService service;
+    std::vector<Measurement> results;
+    for (u32 threads = 1; threads <= maxThreads; ++threads) {
+        results.push_back(measure(service, path, threads, repeats));
+        const Measurement& m = results.back();
+        std::println(std::cout, "{:>8} {:>12.1f} {:>10.0f} {:>8.2f}x {:>14} {:>10}", m.threads, m.milliseconds,
+                     fileMegabytes / (m.milliseconds / 1000), results.front().milliseconds / m.milliseconds, m.heapBytes, m.rows);
+    }
+
+    Log::flush();
+    return 0;
+}
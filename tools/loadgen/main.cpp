@@ -0,0 +1,403 @@
+// Нагрузочный генератор для REST API: N keep-alive соединений гоняют смесь запросов
+// (список загруженных датасетов, страницы, трансформации) и печатают RPS и перцентили задержек в JSON.
+//
+// Сервер поднимается в этом же процессе (--dataset) или берётся уже запущенный (--target).
+//
+// Запуск:
+//   loadgen --dataset datasets/iris.csv [--server-threads 4] [--mode shared|per-core] [--lazy]
+//   loadgen --target 127.0.0.1:8080 [--dataset-id <id>]
+// Общие параметры:
+//   --connections 64 --duration 10 --mix loaded=1,page=8,transform=1 --page-size 100 [--frame] [--output report.json]
+// Сервисы пишут лог в stdout, поэтому без --output отчёт - последняя строка stdout.
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "../../src/web-server/Starter.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    enum class Operation { LOADED, PAGE, TRANSFORM };
+    constexpr std::array operations{Operation::LOADED, Operation::PAGE, Operation::TRANSFORM};
+
+    std::string_view toString(Operation operation) {
+        switch (operation) {
+            case Operation::LOADED: return "loaded";
+            case Operation::PAGE: return "page";
+            case Operation::TRANSFORM: return "transform";
+        }
+        return "unknown";
+    }
+
+    struct Options {
+        std::string target;          // host:port уже запущенного сервера; пусто - сервер в процессе
+        std::string datasetPath;     // CSV для сервера в процессе
+        std::string datasetId;       // датасет на внешнем сервере; пусто - первый загруженный
+        std::string outputPath;      // куда записать отчёт; пусто - stdout
+        bool lazy = false;
+        u32 serverThreads = 0;
+        ServerMode mode = ServerMode::SHARED_CONTEXT;
+        u32 connections = 64;
+        u32 durationSeconds = 10;
+        u32 pageSize = 100;
+        bool frame = false;
+        std::array<u32, operations.size()> weights{1, 8, 1};
+    };
+
+    // что нужно знать о датасете, чтобы строить запросы
+    struct DatasetTarget {
+        std::string id;
+        u32 totalPages = 1;
+        std::string columnName;
+    };
+
+    // корзины гистограммы: до 16 мкс, до 32 мкс, ..., до 2^24 мкс (~16 с), остальное - в последней
+    constexpr size_t histogramBuckets = 21;
+    constexpr u32 firstBucketUs = 16;
+
+    struct LatencyStats {
+        std::vector<u32> latenciesUs;
+        u64 errors = 0;
+
+        void merge(const LatencyStats& other) {
+            latenciesUs.insert(latenciesUs.end(), other.latenciesUs.begin(), other.latenciesUs.end());
+            errors += other.errors;
+        }
+    };
+
+    using ConnectionStats = std::array<LatencyStats, operations.size()>;
+
+    u32 parseNumber(std::string_view text, std::string_view option) {
+        u32 value = 0;
+        const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (ec != std::errc{} || ptr != text.data() + text.size()) {
+            throw std::runtime_error("Invalid value for " + std::string(option) + ": " + std::string(text));
+        }
+        return value;
+    }
+
+    Options parseOptions(int argc, char** argv) {
+        Options options;
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view option = argv[i];
+            if (option == "--lazy") { options.lazy = true; continue; }
+            if (option == "--frame") { options.frame = true; continue; }
+            if (i + 1 >= argc) {
+                throw std::runtime_error("Missing value for " + std::string(option));
+            }
+            const std::string_view value = argv[++i];
+
+            if (option == "--target") options.target = value;
+            else if (option == "--dataset") options.datasetPath = value;
+            else if (option == "--dataset-id") options.datasetId = value;
+            else if (option == "--output") options.outputPath = value;
+            else if (option == "--server-threads") options.serverThreads = parseNumber(value, option);
+            else if (option == "--connections") options.connections = std::max(1u, parseNumber(value, option));
+            else if (option == "--duration") options.durationSeconds = std::max(1u, parseNumber(value, option));
+            else if (option == "--page-size") options.pageSize = std::max(1u, parseNumber(value, option));
+            else if (option == "--mode") {
+                if (value == "shared") options.mode = ServerMode::SHARED_CONTEXT;
+                else if (value == "per-core") options.mode = ServerMode::CONTEXT_PER_CORE;
+                else throw std::runtime_error("Unknown mode: " + std::string(value));
+            } else if (option == "--mix") {
+                // loaded=1,page=8,transform=1; не упомянутые операции получают вес 0
+                options.weights.fill(0);
+                for (size_t position = 0; position <= value.size();) {
+                    const auto end = std::min(value.find(',', position), value.size());
+                    const std::string_view entry = value.substr(position, end - position);
+                    position = end + 1;
+
+                    const auto equals = entry.find('=');
+                    const auto found = std::ranges::find(operations, entry.substr(0, equals), toString);
+                    if (equals == std::string_view::npos || found == operations.end()) {
+                        throw std::runtime_error("Invalid --mix entry: " + std::string(entry));
+                    }
+                    options.weights[found - operations.begin()] = parseNumber(entry.substr(equals + 1), option);
+                }
+            } else {
+                throw std::runtime_error("Unknown option: " + std::string(option));
+            }
+        }
+
+        if (options.target.empty() == options.datasetPath.empty()) {
+            throw std::runtime_error("Exactly one of --target and --dataset is required");
+        }
+        if (std::ranges::all_of(options.weights, [](u32 weight) { return weight == 0; })) {
+            throw std::runtime_error("--mix must give at least one operation a positive weight");
+        }
+        return options;
+    }
+
+    tcp::endpoint resolveTarget(const std::string& target) {
+        const auto colon = target.rfind(':');
+        if (colon == std::string::npos) {
+            throw std::runtime_error("--target must look like host:port");
+        }
+        net::io_context ioc;
+        tcp::resolver resolver(ioc);
+        const auto results = resolver.resolve(target.substr(0, colon), target.substr(colon + 1));
+        return *results.begin();
+    }
+
+    // синхронный запрос для подготовки: найти датасет, число страниц и колонку для трансформации
+    nlohmann::json fetchJson(const tcp::endpoint& endpoint, std::string_view path) {
+        net::io_context ioc;
+        beast::tcp_stream stream(ioc);
+        stream.connect(endpoint);
+
+        http::request<http::empty_body> req{http::verb::get, path, 11};
+        req.set(http::field::host, "localhost");
+        req.set(http::field::accept, "application/json");
+        http::write(stream, req);
+
+        beast::flat_buffer buffer;
+        http::response<http::string_body> res;
+        http::read(stream, buffer, res);
+        if (res.result() != http::status::ok) {
+            throw std::runtime_error("GET " + std::string(path) + " failed: " + std::to_string(res.result_int()) + " " + res.body());
+        }
+        return nlohmann::json::parse(res.body());
+    }
+
+    DatasetTarget describeDataset(const tcp::endpoint& endpoint, std::string id, u32 pageSize) {
+        if (id.empty()) {
+            const auto loaded = fetchJson(endpoint, "/api/v1/datasets/loaded");
+            if (loaded.empty()) {
+                throw std::runtime_error("Server has no loaded datasets; pass --dataset-id or load one first");
+            }
+            id = loaded.front().at("id").get<std::string>();
+        }
+
+        const auto page = fetchJson(endpoint, "/api/v1/datasets/" + id + "?page=1&pageSize=" + std::to_string(pageSize));
+        DatasetTarget dataset{id, std::max(1u, page.at("totalPages").get<u32>()), ""};
+        if (!page.at("headers").empty()) {
+            dataset.columnName = page.at("headers").front().get<std::string>();
+        }
+        return dataset;
+    }
+
+    struct Exchange {
+        http::request<http::string_body> request;
+        http::response<http::string_body> response;
+    };
+
+    net::awaitable<void> send(beast::tcp_stream& stream, beast::flat_buffer& buffer, Exchange& exchange) {
+        exchange.request.prepare_payload();
+        co_await http::async_write(stream, exchange.request, net::use_awaitable);
+        co_await http::async_read(stream, buffer, exchange.response, net::use_awaitable);
+    }
+
+    /**
+     * @brief Одно keep-alive соединение, гоняющее смесь запросов до deadline.
+     *
+     * Закрытое сервером соединение (Connection: close, лимит запросов) открывается заново.
+     * Трансформация создаёт новый датасет, поэтому сразу за ней он выгружается - вне замера.
+     */
+    net::awaitable<void> runConnection(tcp::endpoint endpoint, const Options& options, const DatasetTarget& dataset,
+                                       Clock::time_point deadline, u32 seed, ConnectionStats& stats) {
+        std::mt19937 random(seed);
+        std::discrete_distribution<size_t> pickOperation(options.weights.begin(), options.weights.end());
+        std::uniform_int_distribution<u32> pickPage(1, dataset.totalPages);
+        const std::string pagePrefix = "/api/v1/datasets/" + dataset.id + "?pageSize=" + std::to_string(options.pageSize) + "&page=";
+        const std::string accept = options.frame ? "application/vnd.neuro.page-frame" : "application/json";
+
+        while (Clock::now() < deadline) {
+            beast::tcp_stream stream(co_await net::this_coro::executor);
+            beast::flat_buffer buffer;
+            try {
+                co_await stream.async_connect(endpoint, net::use_awaitable);
+            } catch (const boost::system::system_error&) {
+                ++stats[static_cast<size_t>(Operation::LOADED)].errors;
+                co_return;
+            }
+
+            bool keepAlive = true;
+            while (keepAlive && Clock::now() < deadline) {
+                const size_t index = pickOperation(random);
+                Exchange exchange;
+                exchange.request.version(11);
+                exchange.request.set(http::field::host, "localhost");
+
+                switch (operations[index]) {
+                    case Operation::LOADED:
+                        exchange.request.method(http::verb::get);
+                        exchange.request.target("/api/v1/datasets/loaded");
+                        break;
+                    case Operation::PAGE:
+                        exchange.request.method(http::verb::get);
+                        exchange.request.target(pagePrefix + std::to_string(pickPage(random)));
+                        exchange.request.set(http::field::accept, accept);
+                        break;
+                    case Operation::TRANSFORM:
+                        exchange.request.method(http::verb::post);
+                        exchange.request.target("/api/v1/datasets/" + dataset.id + "/transform/remove-column");
+                        exchange.request.set(http::field::content_type, "application/json");
+                        exchange.request.body() = nlohmann::json{{"columnName", dataset.columnName}}.dump();
+                        break;
+                }
+
+                const auto start = Clock::now();
+                try {
+                    co_await send(stream, buffer, exchange);
+                } catch (const boost::system::system_error&) {
+                    ++stats[index].errors;
+                    break;
+                }
+                const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+
+                if (exchange.response.result() != http::status::ok) {
+                    ++stats[index].errors;
+                } else {
+                    stats[index].latenciesUs.push_back(static_cast<u32>(elapsed.count()));
+                }
+                keepAlive = exchange.response.keep_alive();
+
+                if (operations[index] == Operation::TRANSFORM && exchange.response.result() == http::status::ok && keepAlive) {
+                    Exchange unload;
+                    unload.request = {http::verb::delete_, "/api/v1/datasets/" + nlohmann::json::parse(exchange.response.body()).at("newDatasetId").get<std::string>(), 11};
+                    unload.request.set(http::field::host, "localhost");
+                    try {
+                        co_await send(stream, buffer, unload);
+                    } catch (const boost::system::system_error&) {
+                        break;
+                    }
+                    keepAlive = unload.response.keep_alive();
+                }
+            }
+        }
+    }
+
+    u32 percentile(const std::vector<u32>& sorted, double p) {
+        return sorted.empty() ? 0 : sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * static_cast<double>(sorted.size())))];
+    }
+
+    void writeLatency(JsonWriter& w, std::vector<u32>& latencies, u64 errors, double seconds) {
+        std::ranges::sort(latencies);
+        w.beginObject()
+         .field("requests", latencies.size())
+         .field("errors", errors)
+         .field("rps", static_cast<double>(latencies.size()) / seconds)
+         .key("latencyUs").beginObject()
+             .field("p50", percentile(latencies, 0.50))
+             .field("p90", percentile(latencies, 0.90))
+             .field("p99", percentile(latencies, 0.99))
+             .field("p999", percentile(latencies, 0.999))
+             .field("max", latencies.empty() ? 0 : latencies.back())
+         .endObject();
+
+        std::array<u64, histogramBuckets> histogram{};
+        for (const u32 latency : latencies) {
+            size_t bucket = 0;
+            while (bucket + 1 < histogramBuckets && latency > (firstBucketUs << bucket)) {
+                ++bucket;
+            }
+            ++histogram[bucket];
+        }
+        w.key("histogramUs").beginArray();
+        for (size_t bucket = 0; bucket < histogramBuckets; ++bucket) {
+            if (histogram[bucket] != 0) {
+                w.beginObject().field("le", u64{firstBucketUs} << bucket).field("count", histogram[bucket]).endObject();
+            }
+        }
+        w.endArray().endObject();
+    }
+}
+
+int main(int argc, char** argv) {
+    try {
+        const Options options = parseOptions(argc, argv);
+
+        // сервер в процессе живёт до конца main: клиентам нужен работающий адрес
+        std::unique_ptr<IoRuntime> server;
+        tcp::endpoint endpoint;
+        std::string datasetId = options.datasetId;
+        if (options.target.empty()) {
+            server = std::make_unique<IoRuntime>(options.mode, options.serverThreads, false);
+            auto pools = std::make_shared<WorkerPools>(server->threadCount(), FRAMEWORK_CONSTANTS::computeThreads, FRAMEWORK_CONSTANTS::computeQueueLimit);
+            auto datasetService = std::make_shared<DatasetService>();
+            datasetId = datasetService->loadDataset(options.datasetPath, options.lazy ? DatasetLoadMode::LAZY : DatasetLoadMode::IN_MEMORY);
+            endpoint = server->listen(Starter::createRouter(pools, datasetService), tcp::endpoint{net::ip::make_address("127.0.0.1"), 0});
+            server->start();
+        } else {
+            endpoint = resolveTarget(options.target);
+        }
+
+        const DatasetTarget dataset = describeDataset(endpoint, datasetId, options.pageSize);
+        std::println(std::cerr, "loadgen: {} connections for {}s against {}:{}, dataset {} ({} pages)",
+                     options.connections, options.durationSeconds, endpoint.address().to_string(), endpoint.port(),
+                     dataset.id, dataset.totalPages);
+
+        const u32 clientThreads = std::max(1u, std::thread::hardware_concurrency());
+        net::io_context clients{static_cast<int>(clientThreads)};
+        std::vector<ConnectionStats> stats(options.connections);
+        const auto deadline = Clock::now() + std::chrono::seconds(options.durationSeconds);
+        for (u32 i = 0; i < options.connections; ++i) {
+            net::co_spawn(clients, runConnection(endpoint, options, dataset, deadline, i + 1, stats[i]), net::detached);
+        }
+
+        const auto start = Clock::now();
+        {
+            std::vector<std::jthread> threads;
+            for (u32 i = 1; i < clientThreads; ++i) {
+                threads.emplace_back([&clients] { clients.run(); });
+            }
+            clients.run();
+        }
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        ConnectionStats total;
+        LatencyStats all;
+        for (const auto& connection : stats) {
+            for (size_t i = 0; i < operations.size(); ++i) {
+                total[i].merge(connection[i]);
+                all.merge(connection[i]);
+            }
+        }
+
+        std::string report;
+        JsonWriter w(report);
+        w.beginObject()
+         .field("target", endpoint.address().to_string() + ":" + std::to_string(endpoint.port()))
+         .field("inProcess", options.target.empty())
+         .field("connections", options.connections)
+         .field("durationSeconds", seconds)
+         .field("pageSize", options.pageSize)
+         .field("format", options.frame ? "frame" : "json")
+         .key("total");
+        writeLatency(w, all.latenciesUs, all.errors, seconds);
+        w.key("operations").beginObject();
+        for (size_t i = 0; i < operations.size(); ++i) {
+            if (options.weights[i] != 0) {
+                w.key(toString(operations[i]));
+                writeLatency(w, total[i].latenciesUs, total[i].errors, seconds);
+            }
+        }
+        w.endObject().endObject();
+        if (options.outputPath.empty()) {
+            std::println(std::cout, "{}", report);
+        } else {
+            std::ofstream(options.outputPath) << report << '\n';
+        }
+
+        if (server) {
+            server->stop();
+        }
+        return all.errors == 0 ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::println(std::cerr, "loadgen: {}", e.what());
+        return 2;
+    }
+}
@@ -0,0 +1,128 @@
+// Замер стоимости маршрутизации одного запроса: дерево маршрутов против прежнего перебора regex.
+//
+// Запуск: router_benchmark [итераций на путь]
+
+#include <chrono>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <print>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "../../src/web-server/controllers/Router.hpp"
+
+namespace {
+    // та же таблица, что регистрируют DatasetController и TransformationController
+    std::vector<RouteHandler> apiRoutes() {
+        const Handler noop = [](const RequestCtx&) { return http::response<http::string_body>{}; };
+        return {
+            {Route("/api/v1/datasets/available", {http::verb::get}), noop},
+            {Route("/api/v1/datasets/loaded", {http::verb::get}), noop},
+            {Route("/api/v1/datasets/memory", {http::verb::get}), noop},
+            {Route("/api/v1/datasets/memory", {http::verb::put}), noop},
+            {Route("/api/v1/datasets/load", {http::verb::post}), noop},
+            {Route("/api/v1/jobs/{id}", {http::verb::get}), noop},
+            {Route("/api/v1/datasets/{id}", {http::verb::get}), noop},
+            {Route("/api/v1/datasets/{id}", {http::verb::delete_}), noop},
+            {Route("/api/v1/datasets/{id}/save-as", {http::verb::post}), noop},
+            {Route("/api/v1/datasets/{id}/transform/remove-column", {http::verb::post}), noop},
+        };
+    }
+
+    // прежний алгоритм: regex_match по каждому маршруту с копией target на каждой итерации
+    struct LegacyRoute {
+        std::regex regex;
+        std::vector<std::string> paramNames;
+        const RouteHandler* routeHandler;
+    };
+
+    std::vector<LegacyRoute> compileLegacy(const std::vector<RouteHandler>& routes) {
+        std::vector<LegacyRoute> legacy;
+        const std::regex paramRegex("\\{([^}]+)\\}");
+        for (const auto& routeHandler : routes) {
+            const std::string& pathTemplate = routeHandler.route.getPathTemplate();
+            legacy.push_back({
+                std::regex(std::regex_replace("^" + pathTemplate + "$", paramRegex, "([^/]+)")),
+                routeHandler.route.getParamNames(),
+                &routeHandler
+            });
+        }
+        return legacy;
+    }
+
+    const RouteHandler* legacyFind(const std::vector<LegacyRoute>& routes, std::string_view path, http::verb method,
+                                   std::map<std::string, std::string>& params) {
+        for (const auto& route : routes) {
+            std::smatch match;
+            std::string target(path);
+            if (std::regex_match(target, match, route.regex) && route.routeHandler->route.methods.contains(method)) {
+                for (size_t i = 0; i < route.paramNames.size(); ++i) {
+                    params[route.paramNames[i]] = match[i + 1].str();
+                }
+                return route.routeHandler;
+            }
+        }
+        return nullptr;
+    }
+
+    template<typename Fn>
+    double nanosecondsPerCall(size_t iterations, Fn&& fn) {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            fn();
+        }
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / static_cast<double>(iterations);
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t iterations = 200000;
+    if (argc > 1) {
+        std::from_chars(argv[1], argv[1] + std::strlen(argv[1]), iterations);
+    }
+
+    const auto routes = apiRoutes();
+    RouteTrie trie;
+    for (const auto& routeHandler : routes) {
+        trie.insert(routeHandler);
+    }
+    const auto legacy = compileLegacy(routes);
+
+    const std::vector<std::pair<http::verb, std::string_view>> requests{
+        {http::verb::get, "/api/v1/datasets/loaded"},
+        {http::verb::get, "/api/v1/datasets/3f2c9a1e-0b7d-4c55-9d1e-2a6b8f0c4e71"},
+        {http::verb::post, "/api/v1/datasets/3f2c9a1e-0b7d-4c55-9d1e-2a6b8f0c4e71/transform/remove-column"},
+        {http::verb::get, "/api/v1/jobs/7"},
+        {http::verb::post, "/api/v1/datasets/loaded"},   // 405
+        {http::verb::get, "/api/v1/unknown/path"},       // 404
+    };
+
+    std::println(std::cout, "{:<80} {:>12} {:>12}", "request", "trie ns", "regex ns");
+    double trieTotal = 0;
+    double legacyTotal = 0;
+    size_t sink = 0;
+    for (const auto& [method, path] : requests) {
+        const double trieNs = nanosecondsPerCall(iterations, [&] {
+            PathParams params;
+            bool pathMatched = false;
+            sink += trie.find(path, method, params, pathMatched) != nullptr ? params.size() + 1 : pathMatched;
+        });
+        const double legacyNs = nanosecondsPerCall(iterations / 20 + 1, [&] {
+            std::map<std::string, std::string> params;
+            sink += legacyFind(legacy, path, method, params) != nullptr ? params.size() + 1 : 0;
+        });
+        trieTotal += trieNs;
+        legacyTotal += legacyNs;
+        std::println(std::cout, "{:<80} {:>12.1f} {:>12.1f}",
+                     std::string(http::to_string(method)) + " " + std::string(path), trieNs, legacyNs);
+    }
+
+    const double count = static_cast<double>(requests.size());
+    std::println(std::cout, "{:<80} {:>12.1f} {:>12.1f}", "mean", trieTotal / count, legacyTotal / count);
+    std::println(std::cout, "speedup: {:.1f}x (checksum {})", legacyTotal / trieTotal, sink);
+    return 0;
+}
@@ -0,0 +1,145 @@
+// Сравнение моделей потоков сервера: общий io_context на все потоки против io_context на ядро
+// с собственным acceptor'ом SO_REUSEPORT. Сервер и клиенты работают в одном процессе на loopback.
+//
+// Запуск: server_benchmark [потоков сервера] [соединений] [секунд на режим] [pin]
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <print>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "../../src/web-server/controllers/api/ServerController.hpp"
+#include "../../src/web-server/internal/IoRuntime.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct ConnectionResult {
+        std::vector<u32> latenciesUs;
+        u64 errors = 0;
+    };
+
+    struct ModeResult {
+        double requestsPerSecond = 0;
+        u32 p50 = 0;
+        u32 p99 = 0;
+        u32 p999 = 0;
+        u64 errors = 0;
+    };
+
+    // keep-alive соединение: запрос, ответ, следующий запрос - до deadline; закрытое сервером
+    // по maxRequestsPerConnection соединение открывается заново
+    net::awaitable<void> runConnection(tcp::endpoint endpoint, Clock::time_point deadline, ConnectionResult& result) {
+        http::request<http::empty_body> req{http::verb::get, "/api/v1/server/pools", 11};
+        req.set(http::field::host, "127.0.0.1");
+
+        while (Clock::now() < deadline) {
+            beast::tcp_stream stream(co_await net::this_coro::executor);
+            beast::flat_buffer buffer;
+            beast::error_code ec;
+            co_await stream.async_connect(endpoint, net::redirect_error(net::use_awaitable, ec));
+
+            bool keepAlive = !ec;
+            while (keepAlive && Clock::now() < deadline) {
+                const auto start = Clock::now();
+                co_await http::async_write(stream, req, net::redirect_error(net::use_awaitable, ec));
+                http::response<http::string_body> res;
+                if (!ec) {
+                    co_await http::async_read(stream, buffer, res, net::redirect_error(net::use_awaitable, ec));
+                }
+                if (ec) {
+                    break;
+                }
+                if (res.result() != http::status::ok) {
+                    ++result.errors;
+                    co_return;
+                }
+                result.latenciesUs.push_back(static_cast<u32>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count()));
+                keepAlive = res.keep_alive();
+            }
+            if (ec) {
+                ++result.errors;
+                co_return;
+            }
+        }
+    }
+
+    ModeResult measure(ServerMode mode, u32 serverThreads, u32 connections, std::chrono::seconds duration, bool pin) {
+        auto pools = std::make_shared<WorkerPools>(serverThreads, 1, 1);
+        auto metrics = std::make_shared<Metrics::MetricsRegistry>();
+        auto router = std::make_shared<Router>(pools, *metrics);
+        router->addController<ServerController>(pools, metrics);
+
+        IoRuntime server(mode, serverThreads, pin);
+        const auto endpoint = server.listen(router, tcp::endpoint{net::ip::make_address("127.0.0.1"), 0});
+        server.start();
+
+        // клиентам столько же потоков, сколько серверу: общий процессор делится поровну
+        net::io_context clients{static_cast<int>(serverThreads)};
+        std::vector<ConnectionResult> results(connections);
+        const auto deadline = Clock::now() + duration;
+        for (auto& result : results) {
+            net::co_spawn(clients, runConnection(endpoint, deadline, result), net::detached);
+        }
+
+        const auto start = Clock::now();
+        std::vector<std::jthread> clientThreads;
+        for (u32 i = 1; i < serverThreads; ++i) {
+            clientThreads.emplace_back([&clients] { clients.run(); });
+        }
+        clients.run();
+        clientThreads.clear();
+        const std::chrono::duration<double> elapsed = Clock::now() - start;
+        server.stop();
+
+        std::vector<u32> latencies;
+        ModeResult summary;
+        for (const auto& result : results) {
+            latencies.insert(latencies.end(), result.latenciesUs.begin(), result.latenciesUs.end());
+            summary.errors += result.errors;
+        }
+        if (latencies.empty()) {
+            return summary;
+        }
+        std::ranges::sort(latencies);
+        const auto percentile = [&](double p) { return latencies[std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()))]; };
+        summary.requestsPerSecond = static_cast<double>(latencies.size()) / elapsed.count();
+        summary.p50 = percentile(0.50);
+        summary.p99 = percentile(0.99);
+        summary.p999 = percentile(0.999);
+        return summary;
+    }
+
+    u32 argument(int argc, char** argv, int index, u32 fallback) {
+        u32 value = fallback;
+        if (argc > index) {
+            std::from_chars(argv[index], argv[index] + std::strlen(argv[index]), value);
+        }
+        return value;
+    }
+}
+
+int main(int argc, char** argv) {
+    const u32 threads = argument(argc, argv, 1, std::max(1u, std::thread::hardware_concurrency()));
+    const u32 connections = argument(argc, argv, 2, 256);
+    const std::chrono::seconds duration{argument(argc, argv, 3, 5)};
+    const bool pin = argc > 4 && std::string_view(argv[4]) == "pin";
+
+    std::println(std::cout, "{} server threads, {} connections, {}s per mode{}", threads, connections, duration.count(), pin ? ", pinned" : "");
+    std::println(std::cout, "{:<20} {:>12} {:>10} {:>10} {:>10} {:>8}", "mode", "req/s", "p50 us", "p99 us", "p99.9 us", "errors");
+
+    for (const auto mode : {ServerMode::SHARED_CONTEXT, ServerMode::CONTEXT_PER_CORE}) {
+        const auto result = measure(mode, threads, connections, duration, pin);
+        std::println(std::cout, "{:<20} {:>12.0f} {:>10} {:>10} {:>10} {:>8}",
+                     mode == ServerMode::SHARED_CONTEXT ? "shared io_context" : "io_context per core",
+                     result.requestsPerSecond, result.p50, result.p99, result.p999, result.errors);
+    }
+    return 0;
+}